@@ -581,6 +581,67 @@ u64 fs::file::seek(u64 offset, u32 mode) const
 #endif
 }
 
+u64 fs::file::read_at(u64 offset, void* buffer, u64 count) const
+{
+	const int size = count <= INT_MAX ? static_cast<int>(count) : throw EXCEPTION("Invalid count (0x%llx)", count);
+
+#ifdef _WIN32
+	LARGE_INTEGER pos, old;
+	pos.QuadPart = 0;
+	if (!SetFilePointerEx((HANDLE)m_fd, pos, &old, FILE_CURRENT))
+	{
+		return -1;
+	}
+
+	OVERLAPPED ovl{};
+	ovl.Offset = static_cast<DWORD>(offset);
+	ovl.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+	DWORD nread;
+	const BOOL result = ReadFile((HANDLE)m_fd, buffer, size, &nread, &ovl);
+	const DWORD error = result ? ERROR_SUCCESS : GetLastError();
+
+	SetFilePointerEx((HANDLE)m_fd, old, NULL, FILE_BEGIN);
+
+	// reading at or past the end of file with an offset fails on synchronous handles (::read() returns 0 in this case)
+	if (error == ERROR_HANDLE_EOF)
+	{
+		return 0;
+	}
+
+	return result ? nread : -1;
+#else
+	return ::pread(m_fd, buffer, size, offset);
+#endif
+}
+
+u64 fs::file::write_at(u64 offset, const void* buffer, u64 count) const
+{
+	const int size = count <= INT_MAX ? static_cast<int>(count) : throw EXCEPTION("Invalid count (0x%llx)", count);
+
+#ifdef _WIN32
+	LARGE_INTEGER pos, old;
+	pos.QuadPart = 0;
+	if (!SetFilePointerEx((HANDLE)m_fd, pos, &old, FILE_CURRENT))
+	{
+		return -1;
+	}
+
+	OVERLAPPED ovl{};
+	ovl.Offset = static_cast<DWORD>(offset);
+	ovl.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+	DWORD nwritten;
+	const BOOL result = WriteFile((HANDLE)m_fd, buffer, size, &nwritten, &ovl);
+
+	SetFilePointerEx((HANDLE)m_fd, old, NULL, FILE_BEGIN);
+
+	return result ? nwritten : -1;
+#else
+	return ::pwrite(m_fd, buffer, size, offset);
+#endif
+}
+
 u64 fs::file::size() const
 {
 #ifdef _WIN32
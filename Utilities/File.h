@@ -75,6 +75,10 @@ namespace fs
 		u64 write(const void* buffer, u64 count) const;
 		u64 seek(u64 offset, u32 mode = from_begin) const;
 		u64 size() const;
+
+		// positional read/write, the file pointer is not used (on Windows it's restored afterwards, which isn't atomic)
+		u64 read_at(u64 offset, void* buffer, u64 count) const;
+		u64 write_at(u64 offset, const void* buffer, u64 count) const;
 	};
 
 	struct dir final
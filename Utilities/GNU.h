@@ -1,6 +1,7 @@
 #pragma once
 
 #include <emmintrin.h>
+#include <tmmintrin.h>
 
 // temporarily (until noexcept is available); use `noexcept(true)` instead of `noexcept` if necessary
 #if defined(_MSC_VER) && _MSC_VER <= 1800
@@ -345,6 +346,30 @@ inline uint64_t cntlz64(uint64_t arg)
 #endif
 }
 
+inline uint32_t cnttz32(uint32_t arg)
+{
+#if defined(_MSC_VER)
+	unsigned long res;
+	if (!_BitScanForward(&res, arg))
+	{
+		return 32;
+	}
+	else
+	{
+		return res;
+	}
+#else
+	if (arg)
+	{
+		return __builtin_ctz(arg);
+	}
+	else
+	{
+		return 32;
+	}
+#endif
+}
+
 // compare 16 packed unsigned bytes (greater than)
 inline __m128i sse_cmpgt_epu8(__m128i A, __m128i B)
 {
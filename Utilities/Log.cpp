@@ -124,10 +124,10 @@ struct FileListener : LogListener
 	}
 };
 
-LogManager::LogManager() 
-#ifdef BUFFERED_LOGGING
-	: mExiting(false), mLogConsumer()
-#endif
+LogManager::LogManager()
+	: mWaiting(false)
+	, mExiting(false)
+	, mLogConsumer()
 {
 	auto it = mChannels.begin();
 	std::shared_ptr<LogListener> listener(new FileListener());
@@ -139,52 +139,355 @@ LogManager::LogManager()
 	}
 	std::shared_ptr<LogListener> TTYListener(new FileListener("TTY",false));
 	getChannel(TTY).addListener(TTYListener);
-#ifdef BUFFERED_LOGGING
 	mLogConsumer = std::thread(&LogManager::consumeLog, this);
-#endif
 }
 
 LogManager::~LogManager()
 {
-#ifdef BUFFERED_LOGGING
 	mExiting = true;
+	notify();
 	mBufferReady.notify_all();
 	mLogConsumer.join();
 }
 
+std::atomic<u64> g_log_stamp{ 0 };
+
+static_assert(sizeof(LogRecord) % 16 == 0, "Invalid LogRecord size");
+
+LogRing::LogRing()
+	: m_data(new std::aligned_storage_t<16, 16>[RING_BUFFER_SIZE / 16])
+{
+}
+
+void* LogRing::push(LogType type, Severity sev, const char* fmt, std::string(*format)(const char*, void*), u32 args_size)
+{
+	const u32 size = (sizeof(LogRecord) + args_size + 15) & ~15;
+
+	if (size > RING_BUFFER_SIZE / 2)
+	{
+		m_dropped++;
+		return nullptr;
+	}
+
+	u64 pos;
+	u32 offset;
+	u64 total;
+
+	while (true)
+	{
+		pos = m_push.load(std::memory_order_relaxed);
+		offset = pos % RING_BUFFER_SIZE;
+
+		// the record must be contiguous, skip the end of the buffer if necessary
+		total = size <= RING_BUFFER_SIZE - offset ? size : RING_BUFFER_SIZE - offset + size;
+
+		if (RING_BUFFER_SIZE - (pos - m_pop.load(std::memory_order_acquire)) >= total)
+		{
+			break;
+		}
+
+		// TTY output is never dropped (it's compared with the output of a real PS3)
+		if (type != TTY)
+		{
+			m_dropped++;
+			return nullptr;
+		}
+
+		if (g_log_manager)
+		{
+			g_log_manager->notify();
+		}
+
+		std::this_thread::yield();
+	}
+
+	const auto data = reinterpret_cast<u8*>(m_data.get());
+
+	if (size > RING_BUFFER_SIZE - offset)
+	{
+		reinterpret_cast<LogRecord*>(data + offset)->size = 0;
+		offset = 0;
+	}
+
+	// thread name is only requested when the thread changes
+	const auto thread = get_current_thread_ctrl();
+
+	if (thread != m_thread)
+	{
+		m_thread = thread;
+		m_name = nullptr;
+
+		if (thread)
+		{
+			m_names.emplace_back(new std::string(thread->get_name()));
+			m_name = m_names.back().get();
+		}
+	}
+
+	const auto record = reinterpret_cast<LogRecord*>(data + offset);
+	record->size = size;
+	record->type = type;
+	record->sev = sev;
+	record->thread = m_name;
+	record->stamp = g_log_stamp++;
+	record->fmt = fmt;
+	record->format = format;
+
+	m_next = pos + total;
+	return record + 1;
+}
+
+void LogRing::commit()
+{
+	m_push.store(m_next, std::memory_order_release);
+
+	if (g_log_manager)
+	{
+		g_log_manager->notify();
+	}
+}
+
+void LogRing::close()
+{
+	m_closed.store(true, std::memory_order_release);
+}
+
+struct LogRingOwner
+{
+	std::shared_ptr<LogRing> ring;
+
+	~LogRingOwner()
+	{
+		if (ring)
+		{
+			ring->close();
+		}
+	}
+};
+
+thread_local LogRingOwner g_tls_log_ring;
+
+LogRing* Log::get_log_ring()
+{
+	if (!g_log_manager)
+	{
+		return nullptr;
+	}
+
+	if (!g_tls_log_ring.ring)
+	{
+		g_tls_log_ring.ring = g_log_manager->addRing();
+	}
+
+	return g_tls_log_ring.ring.get();
+}
+
+std::shared_ptr<LogRing> LogManager::addRing()
+{
+	auto ring = std::make_shared<LogRing>();
+
+	std::lock_guard<std::mutex> lock(mRingsLock);
+	mRings.emplace_back(ring);
+	return ring;
+}
+
+void LogManager::notify()
+{
+	// wake up the log thread only if it's waiting
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (mWaiting.load(std::memory_order_relaxed) && mWaiting.exchange(false))
+	{
+		std::lock_guard<std::mutex> lock(mStatusMut);
+		mBufferReady.notify_one();
+	}
+}
+
 void LogManager::consumeLog()
 {
-	std::unique_lock<std::mutex> lock(mStatusMut);
-	while (!mExiting)
+	std::vector<LogRecord*> records;
+	std::vector<std::pair<LogRing*, u64>> positions;
+
+	while (true)
+	{
+		const bool exiting = mExiting;
+
+		records.clear();
+		positions.clear();
+
+		{
+			std::lock_guard<std::mutex> lock(mRingsLock);
+
+			for (auto& ring : mRings)
+			{
+				const u64 end = ring->m_push.load(std::memory_order_acquire);
+				const auto data = reinterpret_cast<u8*>(ring->m_data.get());
+
+				for (u64 pos = ring->m_pop.load(std::memory_order_relaxed); pos < end;)
+				{
+					const u32 offset = pos % RING_BUFFER_SIZE;
+					const auto record = reinterpret_cast<LogRecord*>(data + offset);
+
+					if (!record->size)
+					{
+						pos += RING_BUFFER_SIZE - offset;
+						continue;
+					}
+
+					records.emplace_back(record);
+					pos += record->size;
+				}
+
+				positions.emplace_back(ring.get(), end);
+			}
+		}
+
+		// restore the global order of messages
+		std::sort(records.begin(), records.end(), [](const LogRecord* a, const LogRecord* b)
+		{
+			return a->stamp < b->stamp;
+		});
+
+		for (auto record : records)
+		{
+			deliver(record->type, record->sev, record->thread, record->format(record->fmt, record + 1));
+		}
+
+		u64 dropped = 0;
+
+		for (auto& pos : positions)
+		{
+			pos.first->m_pop.store(pos.second, std::memory_order_release);
+			dropped += pos.first->m_dropped.exchange(0);
+		}
+
+		if (dropped)
+		{
+			deliver(GENERAL, Severity::Warning, nullptr, fmt::format("Log: %llu messages dropped", dropped));
+		}
+
+		{
+			// remove buffers of finished threads (the owner won't push anymore)
+			std::lock_guard<std::mutex> lock(mRingsLock);
+
+			mRings.erase(std::remove_if(mRings.begin(), mRings.end(), [](const std::shared_ptr<LogRing>& ring)
+			{
+				return ring->m_closed.load(std::memory_order_acquire) && ring->m_pop == ring->m_push.load(std::memory_order_acquire);
+			}), mRings.end());
+		}
+
+		if (records.size())
+		{
+			continue;
+		}
+
+		if (exiting)
+		{
+			break;
+		}
+
+		std::unique_lock<std::mutex> lock(mStatusMut);
+
+		mWaiting = true;
+
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		bool pending = false;
+
+		{
+			std::lock_guard<std::mutex> lock(mRingsLock);
+
+			for (auto& ring : mRings)
+			{
+				if (ring->m_pop.load(std::memory_order_relaxed) != ring->m_push.load(std::memory_order_relaxed))
+				{
+					pending = true;
+				}
+			}
+		}
+
+		if (!pending && !mExiting)
+		{
+			mBufferReady.wait_for(lock, std::chrono::milliseconds(100));
+		}
+
+		mWaiting = false;
+	}
+}
+
+bool LogManager::flush(u32 timeout_ms)
+{
+	if (std::this_thread::get_id() == mLogConsumer.get_id())
 	{
-		mBufferReady.wait(lock);
-		mBuffer.lockGet();
-		size_t size = mBuffer.size();
-		std::vector<char> local_messages(size);
-		mBuffer.popN(&local_messages.front(), size);
-		mBuffer.unlockGet();
-
-		u32 cursor = 0;
-		u32 removed = 0;
-		while (cursor < size)
+		return false;
+	}
+
+	std::vector<std::pair<std::shared_ptr<LogRing>, u64>> targets;
+
+	// the lock may be held by the current thread if it crashed, only its own buffer is flushed in this case
+	std::unique_lock<std::mutex> lock(mRingsLock, std::try_to_lock);
+
+	if (lock)
+	{
+		for (auto& ring : mRings)
 		{
-			Log::LogMessage msg = Log::LogMessage::deserialize(local_messages.data() + cursor, &removed);
-			cursor += removed;
-			getChannel(msg.mType).log(msg);
+			targets.emplace_back(ring, ring->m_push.load(std::memory_order_acquire));
 		}
+
+		lock.unlock();
+	}
+	else if (g_tls_log_ring.ring)
+	{
+		targets.emplace_back(g_tls_log_ring.ring, g_tls_log_ring.ring->m_push.load(std::memory_order_acquire));
+	}
+
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+	while (true)
+	{
+		bool done = true;
+
+		for (auto& target : targets)
+		{
+			if (target.first->m_pop.load(std::memory_order_acquire) < target.second)
+			{
+				done = false;
+			}
+		}
+
+		if (done)
+		{
+			return true;
+		}
+
+		if (mExiting || std::chrono::steady_clock::now() >= deadline)
+		{
+			return false;
+		}
+
+		notify();
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
 	}
-#endif
 }
 
-void LogManager::log(LogMessage msg)
+void Log::flush_log(u32 timeout_ms)
+{
+	if (g_log_manager)
+	{
+		g_log_manager->flush(timeout_ms);
+	}
+}
+
+void LogManager::deliver(LogType type, Severity sev, const std::string* thread, std::string text)
 {
 	//don't do any formatting changes or filtering to the TTY output since we
 	//use the raw output to do diffs with the output of a real PS3 and some
 	//programs write text in single bytes to the console
-	if (msg.mType != TTY)
+	if (type != TTY)
 	{
 		std::string prefix;
-		switch (msg.mServerity)
+		switch (sev)
 		{
 		case Severity::Success:
 			prefix = "S ";
@@ -199,22 +502,27 @@ void LogManager::log(LogMessage msg)
 			prefix = "E ";
 			break;
 		}
-		if (auto thr = get_current_thread_ctrl())
+		if (thread)
 		{
-			prefix += "{" + thr->get_name() + "} ";
+			prefix += "{" + *thread + "} ";
 		}
-		msg.mText.insert(0, prefix);
-		msg.mText.append(1,'\n');
+		text.insert(0, prefix);
+		text.append(1, '\n');
 	}
-#ifdef BUFFERED_LOGGING
-	size_t size = msg.size();
-	std::vector<char> temp_buffer(size);
-	msg.serialize(temp_buffer.data());
-	mBuffer.pushRange(temp_buffer.begin(), temp_buffer.end());
-	mBufferReady.notify_one();
-#else
-	mChannels[static_cast<u32>(msg.mType)].log(msg);
-#endif
+
+	mChannels[static_cast<u32>(type)].log({ type, sev, std::move(text) });
+}
+
+void LogManager::log(LogMessage msg)
+{
+	std::string name;
+
+	if (auto thr = get_current_thread_ctrl())
+	{
+		name = thr->get_name();
+	}
+
+	deliver(msg.mType, msg.mServerity, name.empty() ? nullptr : &name, std::move(msg.mText));
 }
 
 void LogManager::addListener(std::shared_ptr<LogListener> listener)
@@ -253,14 +561,26 @@ void log_message(Log::LogType type, Log::Severity sev, const char* text)
 	log_message(type, sev, std::string(text));
 }
 
+static std::string format_text(const char*, void* data)
+{
+	auto& text = *static_cast<std::string*>(data);
+	std::string result = std::move(text);
+	text.~basic_string();
+	return result;
+}
+
 void log_message(Log::LogType type, Log::Severity sev, std::string text)
 {
 	if (g_log_manager)
 	{
-		// another msvc bug makes this not work, uncomment this when it's fixed
-		//g_log_manager->log({logType, severity, text});
-		Log::LogMessage msg{ type, sev, std::move(text) };
-		g_log_manager->log(msg);
+		if (const auto ring = Log::get_log_ring())
+		{
+			if (const auto data = ring->push(type, sev, nullptr, &format_text, sizeof(std::string)))
+			{
+				new (data) std::string(std::move(text));
+				ring->commit();
+			}
+		}
 	}
 	else
 	{
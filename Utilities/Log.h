@@ -1,7 +1,7 @@
 #pragma once
 #include "Utilities/MTRingbuffer.h"
 
-//#define BUFFERED_LOGGING 1
+class thread_ctrl_t;
 
 //first parameter is of type Log::LogType and text is of type std::string
 
@@ -14,6 +14,7 @@ namespace Log
 {
 	const unsigned int MAX_LOG_BUFFER_LENGTH = 1024*1024;
 	const unsigned int gBuffSize = 1000;
+	const unsigned int RING_BUFFER_SIZE = 256*1024; // per thread
 
 	enum LogType : u32
 	{
@@ -91,8 +92,103 @@ namespace Log
 		std::set<std::shared_ptr<LogListener>> mListeners;
 	};
 
+	// deferred message header, followed by its arguments
+	struct LogRecord
+	{
+		u32 size; // full record size (0 means that the rest of the buffer is skipped)
+		LogType type;
+		Severity sev;
+		const std::string* thread; // thread name (may be null)
+		u64 stamp; // global message order
+		const char* fmt;
+		std::string(*format)(const char* fmt, void* args); // formats the message and destroys the arguments
+	};
+
+	// single-producer single-consumer message buffer owned by a thread, messages are formatted by the log thread
+	class LogRing
+	{
+		friend struct LogManager;
+
+		std::unique_ptr<std::aligned_storage_t<16, 16>[]> m_data;
+
+		std::atomic<u64> m_push{ 0 }; // written by the owner thread
+		std::atomic<u64> m_pop{ 0 }; // written by the log thread
+		std::atomic<u64> m_dropped{ 0 };
+		std::atomic<bool> m_closed{ false };
+
+		u64 m_next = 0; // position after the reserved record
+		const thread_ctrl_t* m_thread = nullptr;
+		const std::string* m_name = nullptr;
+		std::vector<std::unique_ptr<std::string>> m_names; // names are kept until all records are consumed
+
+	public:
+		LogRing();
+		LogRing(const LogRing&) = delete;
+
+		// reserve the record, returns the storage for the arguments or nullptr if the message is dropped
+		void* push(LogType type, Severity sev, const char* fmt, std::string(*format)(const char*, void*), u32 args_size);
+
+		// publish the reserved record
+		void commit();
+
+		// mark as not used anymore (called by the owner thread on exit)
+		void close();
+	};
+
+	// get the current thread's buffer (nullptr if the log manager isn't created)
+	LogRing* get_log_ring();
+
+	// wait until the messages logged so far are delivered (used on fatal errors before exiting)
+	void flush_log(u32 timeout_ms = 1000);
+
+	// arguments are stored as unveiled values, strings are copied because they are formatted later
+	template<typename T, typename R = typename fmt::unveil<T>::result_type> struct log_arg
+	{
+		using type = R;
+
+		static type get(const T& arg)
+		{
+			return fmt::do_unveil(arg);
+		}
+	};
+
+	template<typename T> struct log_arg<T, const char*>
+	{
+		using type = std::string;
+
+		static type get(const T& arg)
+		{
+			const char* str = fmt::do_unveil(arg);
+			return str ? str : "(null)";
+		}
+	};
+
+	template<typename Tuple, std::size_t... I> std::string format_args(const char* fmt, Tuple& args, std::index_sequence<I...>)
+	{
+		return fmt::format(fmt, std::get<I>(args)...);
+	}
+
+	template<typename... T> std::string format_record(const char* fmt, void* data)
+	{
+		auto& args = *static_cast<std::tuple<T...>*>(data);
+		std::string result = format_args(fmt, args, std::index_sequence_for<T...>{});
+		args.~tuple();
+		return result;
+	}
+
+	// the arguments are the name, the separator and a tuple of format arguments
+	template<typename... T> std::string format_prefixed_record(const char* fmt, void* data)
+	{
+		auto& args = *static_cast<std::tuple<const std::string*, const char*, std::tuple<T...>>*>(data);
+		std::string result = *std::get<0>(args) + std::get<1>(args) + format_args(fmt, std::get<2>(args), std::index_sequence_for<T...>{});
+		args.~tuple();
+		return result;
+	}
+
 	struct LogManager
 	{
+		friend class LogRing;
+
 		LogManager();
 		~LogManager();
 		static LogManager& getInstance();
@@ -100,17 +196,19 @@ namespace Log
 		void log(LogMessage msg);
 		void addListener(std::shared_ptr<LogListener> listener);
 		void removeListener(std::shared_ptr<LogListener> listener);
-#ifdef BUFFERED_LOGGING
 		void consumeLog();
-#endif
+		std::shared_ptr<LogRing> addRing();
+		bool flush(u32 timeout_ms);
 	private:
-#ifdef BUFFERED_LOGGING
-		MTRingbuffer<char, MAX_LOG_BUFFER_LENGTH> mBuffer;
+		void deliver(LogType type, Severity sev, const std::string* thread, std::string text);
+		void notify();
+		std::mutex mRingsLock;
+		std::vector<std::shared_ptr<LogRing>> mRings;
 		std::condition_variable mBufferReady;
 		std::mutex mStatusMut;
+		std::atomic<bool> mWaiting;
 		std::atomic<bool> mExiting;
 		std::thread mLogConsumer;
-#endif
 		std::array<LogChannel, std::tuple_size<decltype(gTypeNameTable)>::value> mChannels;
 		//std::array<LogChannel,gTypeNameTable.size()> mChannels; //TODO: use this once Microsoft sorts their shit out
 	};
@@ -131,5 +229,43 @@ void log_message(Log::LogType type, Log::Severity sev, std::string text);
 
 template<typename... Args> never_inline void log_message(Log::LogType type, Log::Severity sev, const char* fmt, Args... args)
 {
+	using args_t = std::tuple<typename Log::log_arg<Args>::type...>;
+
+	static_assert(alignof(args_t) <= 16, "Unsupported log argument alignment");
+
+	if (const auto ring = Log::get_log_ring())
+	{
+		// store the arguments, formatting is done by the log thread
+		if (const auto data = ring->push(type, sev, fmt, &Log::format_record<typename Log::log_arg<Args>::type...>, sizeof(args_t)))
+		{
+			new (data) args_t(Log::log_arg<Args>::get(args)...);
+			ring->commit();
+		}
+
+		return;
+	}
+
 	log_message(type, sev, fmt::Format(fmt, fmt::do_unveil(args)...));
 }
+
+// same as log_message, name + separator is prepended to the formatted text by the log thread
+// (only the pointers are stored: name must stay valid, separator must be a string literal)
+template<typename... Args> never_inline void log_message_prefixed(Log::LogType type, Log::Severity sev, const std::string& name, const char* separator, const char* fmt, Args... args)
+{
+	using args_t = std::tuple<const std::string*, const char*, std::tuple<typename Log::log_arg<Args>::type...>>;
+
+	static_assert(alignof(args_t) <= 16, "Unsupported log argument alignment");
+
+	if (const auto ring = Log::get_log_ring())
+	{
+		if (const auto data = ring->push(type, sev, fmt, &Log::format_prefixed_record<typename Log::log_arg<Args>::type...>, sizeof(args_t)))
+		{
+			new (data) args_t(&name, separator, std::make_tuple(Log::log_arg<Args>::get(args)...));
+			ring->commit();
+		}
+
+		return;
+	}
+
+	log_message(type, sev, name + separator + fmt::Format(fmt, fmt::do_unveil(args)...));
+}
@@ -0,0 +1,62 @@
+#include "stdafx.h"
+#include "Utilities/Park.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+
+// WaitOnAddress() is resolved at runtime (not available on Windows 7)
+using wait_on_address_t = BOOL(WINAPI*)(volatile VOID* addr, PVOID compare, SIZE_T size, DWORD ms);
+using wake_by_address_t = VOID(WINAPI*)(PVOID addr);
+
+static const HMODULE g_kernelbase = GetModuleHandleW(L"kernelbase.dll");
+
+static const auto g_wait_on_address = g_kernelbase ? (wait_on_address_t)GetProcAddress(g_kernelbase, "WaitOnAddress") : nullptr;
+static const auto g_wake_by_address_all = g_kernelbase ? (wake_by_address_t)GetProcAddress(g_kernelbase, "WakeByAddressAll") : nullptr;
+
+bool g_thread_park = g_wait_on_address && g_wake_by_address_all;
+
+void thread_park(const volatile u32* addr, u32 value, u64 timeout)
+{
+	g_wait_on_address(const_cast<volatile u32*>(addr), &value, sizeof(u32), static_cast<DWORD>((timeout + 999) / 1000));
+}
+
+void thread_unpark_all(const volatile u32* addr)
+{
+	g_wake_by_address_all(const_cast<u32*>(addr));
+}
+
+#elif defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+
+bool g_thread_park = true;
+
+void thread_park(const volatile u32* addr, u32 value, u64 timeout)
+{
+	const timespec ts{ static_cast<time_t>(timeout / 1000000), static_cast<long>(timeout % 1000000 * 1000) };
+
+	syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, value, &ts, nullptr, 0);
+}
+
+void thread_unpark_all(const volatile u32* addr)
+{
+	syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+#else
+
+bool g_thread_park = false;
+
+void thread_park(const volatile u32* addr, u32 value, u64 timeout)
+{
+	throw EXCEPTION("Not supported");
+}
+
+void thread_unpark_all(const volatile u32* addr)
+{
+	throw EXCEPTION("Not supported");
+}
+
+#endif
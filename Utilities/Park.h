@@ -0,0 +1,14 @@
+#pragma once
+
+// Thread parking on a 32-bit word (futex on Linux, WaitOnAddress on Windows 8+)
+// A parked thread sleeps while the word contains the expected value; the waker must change the word before calling thread_unpark_all().
+// Other systems (and Windows 7) don't support it: g_thread_park is false and callers must use a condition variable instead.
+
+// true if thread_park() is available (may be cleared before any thread is parked to force the fallback)
+extern bool g_thread_park;
+
+// sleep while *addr == value, for at most the specified time (microseconds), may return spuriously
+void thread_park(const volatile u32* addr, u32 value, u64 timeout);
+
+// wake all threads parked on the word
+void thread_unpark_all(const volatile u32* addr);
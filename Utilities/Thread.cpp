@@ -8,6 +8,8 @@
 #include "Emu/SysCalls/SysCalls.h"
 #include "Thread.h"
 
+#include <deque>
+
 #ifdef _WIN32
 #include <windows.h>
 #else
@@ -1145,6 +1147,9 @@ const auto exception_filter = SetUnhandledExceptionFilter([](PEXCEPTION_POINTERS
 {
 	_se_translator(pExp->ExceptionRecord->ExceptionCode, pExp);
 
+	// the process is terminated (deliver the pending log messages first)
+	Log::flush_log();
+
 	return EXCEPTION_CONTINUE_SEARCH;
 });
 
@@ -1171,7 +1176,9 @@ void signal_handler(int sig, siginfo_t* info, void* uct)
 		throw EXCEPTION("Access violation %s location 0x%llx", is_writing ? "writing" : "reading", addr64);
 	}
 
-	// else some fatal error
+	// else some fatal error (deliver the pending log messages first)
+	Log::flush_log();
+
 	exit(EXIT_FAILURE);
 }
 
@@ -1401,6 +1408,134 @@ bool thread_t::is_current() const
 	return g_tls_this_thread == m_thread.get();
 }
 
+struct parallel_job_t
+{
+	const std::function<void(u32)>& func;
+	const u32 count;
+
+	std::atomic<u32> next{ 0 }; // next index to process
+	std::atomic<u32> done{ 0 }; // number of completed calls
+	std::exception_ptr error; // first exception (protected by pool mutex)
+
+	parallel_job_t(const std::function<void(u32)>& func, u32 count)
+		: func(func)
+		, count(count)
+	{
+	}
+};
+
+class parallel_pool_t
+{
+	std::mutex m_mutex;
+	std::condition_variable m_cv; // notified on new job and on job completion
+	std::deque<std::shared_ptr<parallel_job_t>> m_jobs;
+
+	void run(parallel_job_t& job)
+	{
+		for (u32 i; (i = job.next++) < job.count;)
+		{
+			try
+			{
+				job.func(i);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+
+				if (!job.error)
+				{
+					job.error = std::current_exception();
+				}
+			}
+
+			if (++job.done == job.count)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+
+				m_cv.notify_all();
+			}
+		}
+	}
+
+public:
+	const u32 worker_count = std::max<u32>(std::thread::hardware_concurrency(), 1) - 1;
+
+	parallel_pool_t()
+	{
+		for (u32 i = 0; i < worker_count; i++)
+		{
+			thread_t([=]{ return fmt::format("Parallel Worker Thread[%d]", i); }, [this]()
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+
+				while (true)
+				{
+					if (m_jobs.empty())
+					{
+						m_cv.wait(lock);
+						continue;
+					}
+
+					const auto job = m_jobs.front();
+
+					if (job->next >= job->count)
+					{
+						m_jobs.pop_front();
+						continue;
+					}
+
+					lock.unlock();
+					run(*job);
+					lock.lock();
+				}
+			}).detach();
+		}
+	}
+
+	void execute(u32 count, const std::function<void(u32)>& func)
+	{
+		const auto job = std::make_shared<parallel_job_t>(func, count);
+
+		if (count > 1 && worker_count)
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+
+			m_jobs.emplace_back(job);
+			m_cv.notify_all();
+		}
+
+		// the calling thread takes part in the job
+		run(*job);
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		while (job->done < count)
+		{
+			m_cv.wait(lock);
+		}
+
+		const auto found = std::find(m_jobs.begin(), m_jobs.end(), job);
+
+		if (found != m_jobs.end())
+		{
+			m_jobs.erase(found);
+		}
+
+		if (job->error)
+		{
+			std::rethrow_exception(job->error);
+		}
+	}
+};
+
+void parallel_for(u32 count, const std::function<void(u32)>& func)
+{
+	// created on first use and never destroyed (workers are detached)
+	static parallel_pool_t& pool = *new parallel_pool_t;
+
+	pool.execute(count, func);
+}
+
 const std::function<bool()> SQUEUE_ALWAYS_EXIT = [](){ return true; };
 const std::function<bool()> SQUEUE_NEVER_EXIT = [](){ return false; };
 
@@ -100,6 +100,10 @@ public:
 	using thread_t::is_current;
 };
 
+// Call func(i) for every i in [0, count) using the calling thread and a pool of persistent worker threads
+// Returns when all calls are completed, the first exception thrown by func is rethrown in the calling thread
+void parallel_for(u32 count, const std::function<void(u32)>& func);
+
 extern const std::function<bool()> SQUEUE_ALWAYS_EXIT;
 extern const std::function<bool()> SQUEUE_NEVER_EXIT;
 
@@ -0,0 +1,232 @@
+// Crypto backend test (aes, sha1, aesni)
+// Usage: crypto_test [random iterations]
+// Checks AES against the FIPS-197 Appendix C and SP 800-38A CBC vectors, SHA-1 against the FIPS 180 examples and
+// HMAC-SHA-1 against RFC 2202, then cross-checks randomized AES-ECB/CBC (128/192/256-bit keys), SHA-1 and HMAC-SHA-1
+// results of the AES-NI/SHA extensions paths with the regular implementation forced by aesni_disable().
+// Returns non-zero on any mismatch.
+
+#include "stdafx.h"
+#include "Crypto/aes.h"
+#include "Crypto/sha1.h"
+#include "Crypto/aesni.h"
+
+#include <cstdlib>
+
+static int g_failures = 0;
+
+static std::vector<u8> from_hex(const char* hex)
+{
+	std::vector<u8> out;
+
+	for (; hex[0] && hex[1]; hex += 2)
+	{
+		out.push_back((u8)std::strtoul(std::string(hex, 2).c_str(), nullptr, 16));
+	}
+
+	return out;
+}
+
+static void check(const char* name, const u8* result, const std::vector<u8>& expected)
+{
+	if (memcmp(result, expected.data(), expected.size()) != 0)
+	{
+		std::printf("FAILED: %s\n", name);
+		g_failures++;
+	}
+}
+
+static void test_vectors(const char* backend)
+{
+	std::printf("Known answer tests (%s)\n", backend);
+
+	// FIPS-197 Appendix C
+	const auto plain = from_hex("00112233445566778899aabbccddeeff");
+
+	const struct
+	{
+		const char* name;
+		const char* key;
+		const char* cipher;
+	}
+	aes_vectors[] =
+	{
+		{ "AES-128 FIPS-197 C.1", "000102030405060708090a0b0c0d0e0f", "69c4e0d86a7b0430d8cdb78070b4c55a" },
+		{ "AES-192 FIPS-197 C.2", "000102030405060708090a0b0c0d0e0f1011121314151617", "dda97ca4864cdfe06eaf70a0ec0d7191" },
+		{ "AES-256 FIPS-197 C.3", "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f", "8ea2b7ca516745bfeafc49904b496089" },
+	};
+
+	for (const auto& v : aes_vectors)
+	{
+		const auto key = from_hex(v.key);
+		const auto cipher = from_hex(v.cipher);
+
+		aes_context ctx;
+		u8 out[16];
+
+		aes_setkey_enc(&ctx, key.data(), (u32)key.size() * 8);
+		aes_crypt_ecb(&ctx, AES_ENCRYPT, plain.data(), out);
+		check(v.name, out, cipher);
+
+		aes_setkey_dec(&ctx, key.data(), (u32)key.size() * 8);
+		aes_crypt_ecb(&ctx, AES_DECRYPT, cipher.data(), out);
+		check(v.name, out, plain);
+	}
+
+	// SP 800-38A F.2.1/F.2.2 (first two blocks)
+	{
+		const auto key = from_hex("2b7e151628aed2a6abf7158809cf4f3c");
+		const auto iv = from_hex("000102030405060708090a0b0c0d0e0f");
+		const auto cbc_plain = from_hex("6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51");
+		const auto cbc_cipher = from_hex("7649abac8119b246cee98e9b12e9197d5086cb9b507219ee95db113a917678b2");
+
+		aes_context ctx;
+		u8 out[32], iv_copy[16];
+
+		aes_setkey_enc(&ctx, key.data(), 128);
+		memcpy(iv_copy, iv.data(), 16);
+		aes_crypt_cbc(&ctx, AES_ENCRYPT, 32, iv_copy, cbc_plain.data(), out);
+		check("AES-128-CBC SP 800-38A encrypt", out, cbc_cipher);
+
+		aes_setkey_dec(&ctx, key.data(), 128);
+		memcpy(iv_copy, iv.data(), 16);
+		aes_crypt_cbc(&ctx, AES_DECRYPT, 32, iv_copy, cbc_cipher.data(), out);
+		check("AES-128-CBC SP 800-38A decrypt", out, cbc_plain);
+	}
+
+	// FIPS 180 examples
+	const struct
+	{
+		const char* name;
+		std::string input;
+		const char* digest;
+	}
+	sha_vectors[] =
+	{
+		{ "SHA-1 empty", "", "da39a3ee5e6b4b0d3255bfef95601890afd80709" },
+		{ "SHA-1 abc", "abc", "a9993e364706816aba3e25717850c26c9cd0d89d" },
+		{ "SHA-1 two blocks", "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", "84983e441c3bd26ebaae4aa1f95129e5e54670f1" },
+		{ "SHA-1 million a", std::string(1000000, 'a'), "34aa973cd4c4daa4f61eeb2bdbad27316534016f" },
+	};
+
+	for (const auto& v : sha_vectors)
+	{
+		u8 out[20];
+		sha1((const u8*)v.input.data(), v.input.size(), out);
+		check(v.name, out, from_hex(v.digest));
+	}
+
+	// RFC 2202
+	{
+		u8 out[20];
+
+		const std::vector<u8> key1(20, 0x0b);
+		const std::string data1 = "Hi There";
+		sha1_hmac(key1.data(), key1.size(), (const u8*)data1.data(), data1.size(), out);
+		check("HMAC-SHA-1 RFC 2202 #1", out, from_hex("b617318655057264e28bc0b6fb378c8ef146be00"));
+
+		const std::string key2 = "Jefe";
+		const std::string data2 = "what do ya want for nothing?";
+		sha1_hmac((const u8*)key2.data(), key2.size(), (const u8*)data2.data(), data2.size(), out);
+		check("HMAC-SHA-1 RFC 2202 #2", out, from_hex("effcdf6ae5eb2fa2d27416d5f184df9c259a7c79"));
+	}
+}
+
+// Result of every primitive for one random input, computed with the current backend
+static std::vector<u8> run_primitives(const std::vector<u8>& key, const std::vector<u8>& iv, const std::vector<u8>& data)
+{
+	std::vector<u8> result;
+	std::vector<u8> out(data.size());
+
+	const auto append = [&](const u8* p, size_t size)
+	{
+		result.insert(result.end(), p, p + size);
+	};
+
+	for (const u32 bits : { 128, 192, 256 })
+	{
+		aes_context enc, dec;
+		aes_setkey_enc(&enc, key.data(), bits);
+		aes_setkey_dec(&dec, key.data(), bits);
+
+		// ECB, all blocks
+		for (size_t i = 0; i + 16 <= data.size(); i += 16)
+		{
+			aes_crypt_ecb(&enc, AES_ENCRYPT, &data[i], &out[i]);
+		}
+
+		append(out.data(), data.size() & ~15);
+
+		for (size_t i = 0; i + 16 <= data.size(); i += 16)
+		{
+			aes_crypt_ecb(&dec, AES_DECRYPT, &data[i], &out[i]);
+		}
+
+		append(out.data(), data.size() & ~15);
+
+		// CBC (including the updated IV)
+		u8 iv_copy[16];
+
+		memcpy(iv_copy, iv.data(), 16);
+		aes_crypt_cbc(&enc, AES_ENCRYPT, data.size() & ~15, iv_copy, data.data(), out.data());
+		append(out.data(), data.size() & ~15);
+		append(iv_copy, 16);
+
+		memcpy(iv_copy, iv.data(), 16);
+		aes_crypt_cbc(&dec, AES_DECRYPT, data.size() & ~15, iv_copy, data.data(), out.data());
+		append(out.data(), data.size() & ~15);
+		append(iv_copy, 16);
+	}
+
+	u8 digest[20];
+
+	sha1(data.data(), data.size(), digest);
+	append(digest, 20);
+
+	sha1_hmac(key.data(), key.size(), data.data(), data.size(), digest);
+	append(digest, 20);
+
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	const int iterations = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+	const bool has_aes = aesni_supports(POLARSSL_AESNI_AES) != 0;
+	const bool has_sha = aesni_supports(POLARSSL_AESNI_SHA) != 0;
+
+	std::printf("AES-NI: %s, SHA extensions: %s\n", has_aes ? "yes" : "no", has_sha ? "yes" : "no");
+
+	test_vectors("default backend");
+
+	aesni_disable(1);
+	test_vectors("regular implementation");
+	aesni_disable(0);
+
+	std::mt19937 rng(12345);
+
+	for (int i = 0; i < iterations; i++)
+	{
+		std::vector<u8> key(32 + rng() % 64), iv(16), data(rng() % 1024);
+
+		for (auto& b : key) b = (u8)rng();
+		for (auto& b : iv) b = (u8)rng();
+		for (auto& b : data) b = (u8)rng();
+
+		const auto fast = run_primitives(key, iv, data);
+
+		aesni_disable(1);
+		const auto regular = run_primitives(key, iv, data);
+		aesni_disable(0);
+
+		if (fast != regular)
+		{
+			std::printf("FAILED: random cross-check #%d (%u bytes)\n", i, (u32)data.size());
+			g_failures++;
+		}
+	}
+
+	std::printf("%d random cross-checks, %d failure(s)\n", iterations, g_failures);
+
+	return g_failures ? 1 : 0;
+}
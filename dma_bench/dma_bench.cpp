@@ -0,0 +1,156 @@
+// SPU DMA copy benchmark (vm::copy(), Emu/Memory/vm.cpp)
+// Usage: dma_bench [total MiB per test] [cold buffer MiB]
+// Copies transfers of 16 B .. 16 KiB (aligned, as MFC GET/PUT) using memcpy, vm::copy() and vm::copy() with non-temporal
+// stores (Ini.SPUStreamPut). The destination is either hot (the same LS-sized area, which stays in the cache, and is read
+// after every copy like a consumer would) or cold (walks through a buffer much larger than the cache).
+// Prints GB/s for every size and mode.
+
+#include "stdafx.h"
+
+#include <cstdlib>
+#include <chrono>
+
+// copy of vm::copy() (vm.cpp depends on the emulator)
+template<u32 Size> force_inline void _copy_fixed(__m128i* dst, const __m128i* src)
+{
+	__m128i data[Size / 16];
+
+	for (u32 i = 0; i < Size / 16; i++)
+	{
+		data[i] = _mm_load_si128(src + i);
+	}
+
+	for (u32 i = 0; i < Size / 16; i++)
+	{
+		_mm_store_si128(dst + i, data[i]);
+	}
+}
+
+const u32 g_copy_stream_min = 4096;
+
+never_inline void copy(void* dst, const void* src, u32 size, bool stream)
+{
+	if ((size | reinterpret_cast<std::uintptr_t>(dst) | reinterpret_cast<std::uintptr_t>(src)) % 16)
+	{
+		std::memcpy(dst, src, size);
+		return;
+	}
+
+	const auto _dst = static_cast<__m128i*>(dst);
+	const auto _src = static_cast<const __m128i*>(src);
+
+	switch (size)
+	{
+	case 16: return _copy_fixed<16>(_dst, _src);
+	case 32: return _copy_fixed<32>(_dst, _src);
+	case 64: return _copy_fixed<64>(_dst, _src);
+	case 128: return _copy_fixed<128>(_dst, _src);
+	}
+
+	if (stream && size >= g_copy_stream_min && size % 64 == 0)
+	{
+		for (u32 i = 0; i < size / 16; i += 4)
+		{
+			const __m128i data0 = _mm_load_si128(_src + i + 0);
+			const __m128i data1 = _mm_load_si128(_src + i + 1);
+			const __m128i data2 = _mm_load_si128(_src + i + 2);
+			const __m128i data3 = _mm_load_si128(_src + i + 3);
+			_mm_stream_si128(_dst + i + 0, data0);
+			_mm_stream_si128(_dst + i + 1, data1);
+			_mm_stream_si128(_dst + i + 2, data2);
+			_mm_stream_si128(_dst + i + 3, data3);
+		}
+
+		_mm_sfence();
+		return;
+	}
+
+	std::memcpy(dst, src, size);
+}
+
+never_inline void copy_memcpy(void* dst, const void* src, u32 size)
+{
+	std::memcpy(dst, src, size);
+}
+
+enum : u32
+{
+	mode_memcpy,
+	mode_copy,
+	mode_stream,
+};
+
+static volatile u64 g_sum = 0; // prevents the consumer reads from being optimized out
+
+static double run(u32 mode, u32 size, bool hot, u64 total, u8* src, u8* dst, u64 dst_size)
+{
+	const u64 count = total / size;
+	const u64 area = hot ? 256 * 1024 : dst_size; // LS size for the hot destination
+
+	u64 pos = 0;
+	u64 sum = 0;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (u64 i = 0; i < count; i++)
+	{
+		u8* const ptr = dst + pos;
+
+		switch (mode)
+		{
+		case mode_memcpy: copy_memcpy(ptr, src, size); break;
+		case mode_copy: copy(ptr, src, size, false); break;
+		case mode_stream: copy(ptr, src, size, true); break;
+		}
+
+		if (hot)
+		{
+			for (u32 j = 0; j < size; j += 64)
+			{
+				sum += ptr[j];
+			}
+		}
+
+		if ((pos += size) + size > area)
+		{
+			pos = 0;
+		}
+	}
+
+	const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	g_sum += sum;
+
+	return (double)count * size / time / 1e9;
+}
+
+int main(int argc, char** argv)
+{
+	const u64 total = (argc > 1 ? std::atoi(argv[1]) : 256) * 1024ull * 1024;
+	const u64 cold = (argc > 2 ? std::atoi(argv[2]) : 256) * 1024ull * 1024;
+
+	u8* const src = static_cast<u8*>(_mm_malloc(16 * 1024, 128));
+	u8* const dst = static_cast<u8*>(_mm_malloc(cold, 128));
+
+	std::memset(src, 0x5a, 16 * 1024);
+	std::memset(dst, 0, cold);
+
+	for (bool hot : { true, false })
+	{
+		std::printf("%s destination (GB/s):\n", hot ? "hot" : "cold");
+
+		for (u32 size = 16; size <= 16 * 1024; size *= 2)
+		{
+			const double v0 = run(mode_memcpy, size, hot, total, src, dst, cold);
+			const double v1 = run(mode_copy, size, hot, total, src, dst, cold);
+			const double v2 = run(mode_stream, size, hot, total, src, dst, cold);
+
+			std::printf("%6u bytes: memcpy %6.2f, vm::copy %6.2f, vm::copy (stream) %6.2f\n", size, v0, v1, v2);
+		}
+	}
+
+	_mm_free(dst);
+	_mm_free(src);
+
+	return 0;
+}
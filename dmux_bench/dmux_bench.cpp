@@ -0,0 +1,474 @@
+// Synthetic PAMF demux benchmark (cellDmux)
+// Usage: dmux_bench [stream size in MB] [iterations]
+// Builds an MPEG-PS stream laid out like PAMF movies (2048-byte sectors carrying one AVC and one ATRAC3+ stream)
+// and demuxes it twice: with in-place AU assembly in the ES ring buffer (current cellDmux) and with the previous
+// std::vector based assembly. The current path runs the cellDmux packet parser (dmux_parser_t from cellDmuxPes.h) on
+// host memory with an ES ring buffer whose AUs are released immediately. Prints MB/s of input stream for both paths.
+
+#include "stdafx.h"
+#include "Emu/SysCalls/Modules/cellDmuxPes.h"
+
+#include <cstdlib>
+#include <chrono>
+
+const u32 sector_size = 2048;
+const u32 video_au_sectors = 16; // video sectors per AU (each AU starts with a PES header carrying PTS/DTS)
+const u32 atx_frame_size = 0x2f * 8 + 8; // ATRAC3+ frame size (without 8-byte ATS header)
+const u32 es_size = 4 * 1024 * 1024; // ES ring buffer size
+const u64 ts_invalid = ~0ull;
+
+static void put_ts(u8* p, u8 marker, u64 ts)
+{
+	p[0] = marker | ((ts >> 29) & 0x0e) | 1;
+	p[1] = (u8)(ts >> 22);
+	p[2] = (u8)(ts >> 14) | 1;
+	p[3] = (u8)(ts >> 7);
+	p[4] = (u8)(ts << 1) | 1;
+}
+
+static void put_be16(u8* p, u32 v)
+{
+	p[0] = (u8)(v >> 8);
+	p[1] = (u8)v;
+}
+
+static u32 get_be32(const u8* p)
+{
+	return (u32)p[0] << 24 | (u32)p[1] << 16 | (u32)p[2] << 8 | p[3];
+}
+
+std::vector<u8> make_stream(u32 size)
+{
+	std::vector<u8> out(size / sector_size * sector_size);
+
+	u32 seed = 1;
+	const auto rnd = [&]() -> u8
+	{
+		seed = seed * 1103515245 + 12345;
+		return (u8)(seed >> 16) | 0x80; // payload never contains a start code prefix
+	};
+
+	u32 video_count = 0;
+	u64 atx_pos = 0; // position in the ATRAC3+ elementary stream
+
+	for (u32 addr = 0; addr < out.size(); addr += sector_size)
+	{
+		u8* p = out.data() + addr;
+		u8* const end = p + sector_size;
+
+		// pack header
+		p[0] = 0, p[1] = 0, p[2] = 1, p[3] = 0xba;
+		std::memset(p + 4, 0x44, 10);
+		p += 14;
+
+		const bool audio = addr / sector_size % 8 == 7;
+
+		p[0] = 0, p[1] = 0, p[2] = 1, p[3] = audio ? 0xbd : 0xe0;
+		put_be16(p + 4, (u32)(end - p - 6));
+		p[6] = 0x81;
+
+		if (audio)
+		{
+			p[7] = 0x80, p[8] = 5;
+			put_ts(p + 9, 0x20, atx_pos * 3);
+			p += 14;
+
+			*p++ = 0; // fid_minor
+			*p++ = 0, *p++ = 0, *p++ = 0; // unknown
+
+			for (; p < end; p++, atx_pos++)
+			{
+				const u32 pos = atx_pos % (atx_frame_size + 8);
+				static const u8 ats[8] = { 0x0f, 0xd0, (atx_frame_size - 8) / 8 >> 8, (atx_frame_size - 8) / 8 & 0xff, 0, 0, 0, 0 };
+				*p = pos < 8 ? ats[pos] : rnd();
+			}
+		}
+		else if (video_count++ % video_au_sectors == 0)
+		{
+			p[7] = 0xc0, p[8] = 10;
+			put_ts(p + 9, 0x30, video_count * 3003 + 3003);
+			put_ts(p + 14, 0x10, video_count * 3003);
+			p += 19;
+		}
+		else
+		{
+			p[7] = 0, p[8] = 0;
+			p += 9;
+		}
+
+		while (p < end)
+		{
+			*p++ = rnd();
+		}
+	}
+
+	return out;
+}
+
+// DemuxerStream on host memory
+struct stream_t
+{
+	const u8* ptr;
+	u32 size;
+	u64 userdata;
+
+	template<typename T> bool get(T& out)
+	{
+		if (!peek(out)) return false;
+
+		skip(sizeof(T));
+		return true;
+	}
+
+	template<typename T> bool peek(T& out) const
+	{
+		if (sizeof(T) > size) return false;
+
+		std::memcpy(&out, ptr, sizeof(T));
+		return true;
+	}
+
+	void skip(u32 count)
+	{
+		ptr += count;
+		size = size > count ? size - count : 0;
+	}
+
+	bool check(u32 count) const
+	{
+		return count <= size;
+	}
+
+	const u8* data() const
+	{
+		return ptr;
+	}
+};
+
+struct result_t
+{
+	u64 au_count = 0;
+	u64 au_bytes = 0;
+	u64 ts_hash = 0;
+
+	void add(u32 size, u64 pts)
+	{
+		au_count++;
+		au_bytes += size;
+		ts_hash = ts_hash * 31 + pts;
+	}
+
+	bool operator ==(const result_t& r) const
+	{
+		return au_count == r.au_count && au_bytes == r.au_bytes && ts_hash == r.ts_hash;
+	}
+};
+
+// previous PES header parser (one stream.get() per byte), returns header data size (pts and dts are updated if present)
+u32 parse_pes_bytewise(stream_t& s, u64& pts, u64& dts, bool& has_ts)
+{
+	const u32 size = s.ptr[2];
+	const u8* const data = s.ptr + 3;
+	s.skip(3 + size);
+
+	has_ts = false;
+
+	for (u32 pos = 0; pos < size;)
+	{
+		volatile u8 tmp = data[pos++];
+		const u8 v = tmp;
+
+		if (v == 0xff) continue;
+
+		if ((v & 0xf0) == 0x20 && size - pos >= 4)
+		{
+			pts = dmux_get_ts(v, data + pos), pos += 4, has_ts = true;
+		}
+		else if ((v & 0xf0) == 0x30 && size - pos >= 9)
+		{
+			pts = dmux_get_ts(v, data + pos), pos += 5, has_ts = true;
+			dts = dmux_get_ts(data[pos - 1], data + pos), pos += 4;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	return size;
+}
+
+// ES ring buffer with in-place AU assembly (ElementaryStream::push/push_au, the guest is assumed to release AUs immediately)
+struct es_inplace_t
+{
+	std::vector<u8> mem = std::vector<u8>(es_size);
+	u32 put = 0;
+	u32 raw_size = 0;
+	u64 last_pts = ts_invalid;
+	u64 last_dts = ts_invalid;
+
+	u8* raw_data()
+	{
+		return mem.data() + put + 128;
+	}
+
+	bool push(stream_t& stream, u32 size)
+	{
+		const u32 new_size = raw_size + size;
+
+		if (put + new_size + 128 > es_size)
+		{
+			std::memmove(mem.data() + 128, mem.data() + put + 128, raw_size);
+			put = 0;
+		}
+
+		std::memcpy(mem.data() + put + 128 + raw_size, stream.data(), size);
+		raw_size = new_size;
+
+		stream.skip(size);
+		return true;
+	}
+
+	void push_au(result_t& res)
+	{
+		// AU info header
+		u64* const info = (u64*)(mem.data() + put);
+		info[0] = put + 128;
+		info[1] = raw_size;
+		info[2] = last_pts;
+		info[3] = last_dts;
+
+		res.add(raw_size, last_pts);
+
+		put = (put + 128 + raw_size + 127) & ~127;
+		raw_size = 0;
+	}
+};
+
+// demuxer thread state (one AVC and one ATRAC3+ stream enabled)
+struct handler_t
+{
+	es_inplace_t avc, atx;
+	result_t res;
+
+	es_inplace_t* get_avc(u32 ch)
+	{
+		return ch == 0 ? &avc : nullptr;
+	}
+
+	es_inplace_t* get_atx(u32 ch)
+	{
+		return ch == 0 ? &atx : nullptr;
+	}
+
+	void au_found(es_inplace_t& es, u64 userdata)
+	{
+		es.push_au(res);
+	}
+
+	template<typename... Args> void notice(const char* fmt, Args... args)
+	{
+	}
+
+	template<typename... Args> void warning(const char* fmt, Args... args)
+	{
+	}
+
+	template<typename... Args> void error(const char* fmt, Args... args)
+	{
+	}
+};
+
+// previous ES implementation: AU data is collected in std::vector and copied to the ring when the AU is pushed
+struct es_vector_t
+{
+	std::vector<u8> mem = std::vector<u8>(es_size);
+	u32 put = 0;
+	std::vector<u8> raw_data;
+	u64 last_pts = ts_invalid;
+	u64 last_dts = ts_invalid;
+
+	void push(const u8* data, u32 size)
+	{
+		const auto old_size = raw_data.size();
+		raw_data.resize(old_size + size);
+		std::memcpy(raw_data.data() + old_size, data, size);
+	}
+
+	void push_au(u32 size, result_t& res)
+	{
+		if (put + size + 128 > es_size)
+		{
+			put = 0;
+		}
+
+		std::memcpy(mem.data() + put + 128, raw_data.data(), size);
+		raw_data.erase(raw_data.begin(), raw_data.begin() + size);
+
+		u64* const info = (u64*)(mem.data() + put);
+		info[0] = put + 128;
+		info[1] = size;
+		info[2] = last_pts;
+		info[3] = last_dts;
+
+		res.add(size, last_pts);
+
+		put = (put + 128 + size + 127) & ~127;
+	}
+};
+
+result_t demux_inplace(const std::vector<u8>& data)
+{
+	handler_t handler;
+	dmux_parser_t<stream_t, es_inplace_t, handler_t> parser(handler);
+	stream_t s{ data.data(), (u32)data.size(), 0 };
+
+	// demuxer thread loop (the ES buffer never becomes full here)
+	while (true)
+	{
+		if (parser.atx_data.size)
+		{
+			parser.push_atx();
+			continue;
+		}
+
+		be_t<u32> code;
+
+		if (!s.peek(code))
+		{
+			break;
+		}
+
+		parser.parse_packet(s);
+	}
+
+	return handler.res;
+}
+
+result_t demux_vector(const std::vector<u8>& data)
+{
+	result_t res;
+	es_vector_t avc, atx;
+	stream_t s{ data.data(), (u32)data.size(), 0 };
+
+	while (s.size >= 4)
+	{
+		const u32 code = get_be32(s.ptr);
+
+		if (code == 0x1ba)
+		{
+			s.skip(14);
+		}
+		else if (code == 0x1bd)
+		{
+			u32 len = s.ptr[4] << 8 | s.ptr[5];
+			s.skip(6);
+
+			u64 pts = ts_invalid, dts = ts_invalid;
+			bool has_ts;
+			len -= parse_pes_bytewise(s, pts, dts, has_ts) + 3 + 4;
+			s.skip(4);
+
+			if (has_ts)
+			{
+				atx.last_pts = pts;
+				atx.last_dts = dts;
+			}
+
+			atx.push(s.ptr, len);
+			s.skip(len);
+
+			while (true)
+			{
+				const auto size = atx.raw_data.size();
+				const auto ats = atx.raw_data.data();
+
+				if (size < 8) break;
+
+				const u32 frame_size = ((((u32)ats[2] & 0x3) << 8) | (u32)ats[3]) * 8 + 8;
+
+				if (size < frame_size + 8) break;
+
+				atx.push_au(frame_size + 8, res);
+			}
+		}
+		else if ((code & ~0xf) == 0x1e0)
+		{
+			const stream_t backup = s;
+			u32 len = s.ptr[4] << 8 | s.ptr[5];
+			s.skip(6);
+
+			u64 pts = ts_invalid, dts = ts_invalid;
+			bool has_ts;
+			const u32 pes_size = parse_pes_bytewise(s, pts, dts, has_ts);
+			len -= pes_size + 3;
+
+			const u32 old_size = (u32)avc.raw_data.size();
+
+			if ((has_ts && old_size) || old_size >= 0x69800)
+			{
+				avc.push_au(old_size, res);
+			}
+
+			if (has_ts)
+			{
+				avc.last_pts = pts;
+				avc.last_dts = dts;
+			}
+
+			avc.push(backup.ptr, len + pes_size + 9);
+			s = backup;
+			s.skip(len + pes_size + 9);
+		}
+		else
+		{
+			// previous implementation: resync one byte at a time
+			s.skip(1);
+		}
+	}
+
+	return res;
+}
+
+template<typename F> double measure(const std::vector<u8>& data, u32 iterations, F func, result_t& res)
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	for (u32 i = 0; i < iterations; i++)
+	{
+		res = func(data);
+	}
+
+	const std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+	return data.size() * (double)iterations / time.count() / (1024 * 1024);
+}
+
+int main(int argc, char** argv)
+{
+	const u32 size_mb = argc > 1 ? std::atoi(argv[1]) : 64;
+	const u32 iterations = argc > 2 ? std::atoi(argv[2]) : 8;
+
+	const auto data = make_stream(size_mb * 1024 * 1024);
+
+	result_t r1, r2;
+
+	// warm up
+	demux_inplace(data);
+	demux_vector(data);
+
+	const double inplace = measure(data, iterations, demux_inplace, r1);
+	const double vector = measure(data, iterations, demux_vector, r2);
+
+	std::printf("stream: %u MB, %llu AUs (%llu bytes)\n", size_mb, (unsigned long long)r1.au_count, (unsigned long long)r1.au_bytes);
+	std::printf("in-place ES assembly: %8.1f MB/s\n", inplace);
+	std::printf("std::vector ES:       %8.1f MB/s\n", vector);
+
+	if (!(r1 == r2))
+	{
+		std::printf("ERROR: results differ (%llu AUs, %llu bytes)\n", (unsigned long long)r2.au_count, (unsigned long long)r2.au_bytes);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,156 @@
+// Log throughput benchmark (per-thread rings, Utilities/Log.cpp)
+// Usage: log_bench [threads] [messages per thread]
+// Every thread logs the specified count of messages with a few arguments, either deferred (arguments are stored in the
+// ring and formatted by the log thread, LOG_NOTICE) or preformatted by the caller (fmt::format, then log_message).
+// Prints msgs/sec seen by the logging threads, msgs/sec written by the log thread (until Log::flush_log() returns) and
+// the share of messages dropped because a ring was full.
+// Log files are created in the current directory.
+
+#include "stdafx.h"
+#include "Utilities/Log.h"
+#include "Utilities/rPlatform.h"
+#include "Utilities/rMsgBox.h"
+#include "Utilities/Thread.h"
+
+#include <cstdlib>
+#include <chrono>
+
+// dependencies of Log.cpp (the benchmark doesn't use the GUI or named threads)
+std::string rPlatform::getConfigDir()
+{
+	return "";
+}
+
+long rMessageBox(const std::string& message, const std::string& title, long style)
+{
+	std::printf("%s: %s\n", title.c_str(), message.c_str());
+	return 0;
+}
+
+const thread_ctrl_t* get_current_thread_ctrl()
+{
+	return nullptr;
+}
+
+std::string thread_ctrl_t::get_name() const
+{
+	return "";
+}
+
+// copies of StrFmt.cpp functions (StrFmt.cpp depends on wx)
+std::string fmt::replace_all(const std::string &src, const std::string& from, const std::string& to)
+{
+	std::string target = src;
+	for (auto pos = target.find(from); pos != std::string::npos; pos = target.find(from, pos + 1))
+	{
+		target = (pos ? target.substr(0, pos) + to : to) + std::string(target.c_str() + pos + from.length());
+		pos += to.length();
+	}
+
+	return target;
+}
+
+std::string fmt::escape(std::string source)
+{
+	const std::pair<std::string, std::string> escape_list[] =
+	{
+		{ "\\", "\\\\" },
+		{ "\a", "\\a" },
+		{ "\b", "\\b" },
+		{ "\f", "\\f" },
+		{ "\n", "\\n\n" },
+		{ "\r", "\\r" },
+		{ "\t", "\\t" },
+		{ "\v", "\\v" },
+	};
+
+	source = fmt::replace_all(source, escape_list);
+
+	for (char c = 0; c < 32; c++)
+	{
+		if (c != '\n') source = fmt::replace_all(source, std::string(1, c), fmt::Format("\\x%02X", c));
+	}
+
+	return source;
+}
+
+extern std::unique_ptr<Log::LogManager> g_log_manager;
+
+// counts delivered messages (the rest is dropped when a ring is full)
+struct counter_listener_t : Log::LogListener
+{
+	std::atomic<u64> count{ 0 };
+
+	virtual void log(const Log::LogMessage& msg) override
+	{
+		if (msg.mServerity == Log::Severity::Notice)
+		{
+			count++;
+		}
+	}
+};
+
+static std::shared_ptr<counter_listener_t> g_counter;
+
+static void run(const char* name, u32 threads, u32 count, bool deferred)
+{
+	g_counter->count = 0;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> workers;
+
+	for (u32 t = 0; t < threads; t++)
+	{
+		workers.emplace_back([=]()
+		{
+			for (u32 i = 0; i < count; i++)
+			{
+				if (deferred)
+				{
+					LOG_NOTICE(GENERAL, "log_bench: thread %d, message %d, value 0x%llx", t, i, i * 0x9e3779b97f4a7c15ull);
+				}
+				else
+				{
+					log_message(GENERAL, Log::Severity::Notice, fmt::format("log_bench: thread %d, message %d, value 0x%llx", t, i, i * 0x9e3779b97f4a7c15ull));
+				}
+			}
+		});
+	}
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+
+	const double logged = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	Log::flush_log(60000);
+
+	const double written = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	const double total = (double)threads * count;
+	const double delivered = (double)g_counter->count.load();
+
+	std::printf("%-13s %u threads: %.2f M msgs/s logged, %.2f M msgs/s written, %.1f%% dropped\n", name, threads, total / logged / 1e6, delivered / written / 1e6, (total - delivered) * 100 / total);
+}
+
+int main(int argc, char** argv)
+{
+	const u32 threads = argc > 1 ? std::atoi(argv[1]) : 4;
+	const u32 count = argc > 2 ? std::atoi(argv[2]) : 200000;
+
+	g_counter = std::make_shared<counter_listener_t>();
+
+	Log::LogManager::getInstance().getChannel(GENERAL).addListener(g_counter);
+
+	for (u32 n = 1; n <= threads; n *= 2)
+	{
+		run("deferred", n, count, true);
+		run("preformatted", n, count, false);
+	}
+
+	g_log_manager.reset();
+
+	return 0;
+}
@@ -0,0 +1,153 @@
+// lv2 lightweight mutex lock contention benchmark (sys_lwmutex.cpp)
+// Usage: lwmutex_bench [max threads] [operations per thread]
+// Every thread repeats the uncontended path of _sys_lwmutex_trylock() and _sys_lwmutex_unlock() on real lv2_lwmutex_t
+// objects registered in an ID_manager: ID lookup, locking, check_id() and the `signaled` update. The lock is either one
+// shared mutex (the core mutex, LV2_LOCK, as before per-object locks) or the object lock (`sync`, current syscalls).
+// Threads use either their own lwmutex (unrelated objects) or the same one (failed trylocks are retried).
+// Prints millions of lock/unlock pairs per second for 1..N threads.
+
+#include "stdafx.h"
+#include "Emu/System.h"
+#include "Emu/IdManager.h"
+#include "Emu/SysCalls/lv2/sys_lwmutex.h"
+
+#include <cstdlib>
+#include <chrono>
+
+// referenced by vm.h inline functions (guest memory isn't used)
+void* const vm::g_base_addr = nullptr;
+
+static ID_manager g_idm;
+
+static std::mutex g_core_mutex; // models the core mutex
+
+// returns false if the lwmutex is not available (CELL_EBUSY)
+template<bool CoreLock> static bool trylock(u32 id)
+{
+	lv2_lock_t core_lock(g_core_mutex, std::defer_lock);
+
+	if (CoreLock) core_lock.lock();
+
+	const auto mutex = g_idm.get<lv2_lwmutex_t>(id);
+
+	if (!mutex)
+	{
+		throw EXCEPTION("Not found");
+	}
+
+	lv2_lock_t lv2_lock(mutex->sync, std::defer_lock);
+
+	if (!CoreLock)
+	{
+		lv2_lock.lock();
+
+		if (!g_idm.check_id<lv2_lwmutex_t>(id))
+		{
+			throw EXCEPTION("Not found");
+		}
+	}
+
+	if (mutex->signaled)
+	{
+		mutex->signaled--;
+
+		return true;
+	}
+
+	return false;
+}
+
+template<bool CoreLock> static void unlock(u32 id)
+{
+	lv2_lock_t core_lock(g_core_mutex, std::defer_lock);
+
+	if (CoreLock) core_lock.lock();
+
+	const auto mutex = g_idm.get<lv2_lwmutex_t>(id);
+
+	if (!mutex)
+	{
+		throw EXCEPTION("Not found");
+	}
+
+	lv2_lock_t lv2_lock(mutex->sync, std::defer_lock);
+
+	if (!CoreLock)
+	{
+		lv2_lock.lock();
+
+		if (!g_idm.check_id<lv2_lwmutex_t>(id))
+		{
+			throw EXCEPTION("Not found");
+		}
+	}
+
+	// no waiters in this benchmark (see lv2_lwmutex_t::unlock())
+	mutex->signaled++;
+}
+
+template<bool CoreLock> static double run(u32 threads, u32 count, bool shared)
+{
+	std::vector<u32> ids;
+
+	for (u32 t = 0; t < (shared ? 1 : threads); t++)
+	{
+		const u32 id = g_idm.make<lv2_lwmutex_t>(SYS_SYNC_PRIORITY, 0);
+
+		g_idm.get<lv2_lwmutex_t>(id)->signaled = 1; // unlocked
+
+		ids.push_back(id);
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> workers;
+
+	for (u32 t = 0; t < threads; t++)
+	{
+		workers.emplace_back([&, t]()
+		{
+			const u32 id = ids[shared ? 0 : t];
+
+			for (u32 i = 0; i < count; i++)
+			{
+				while (!trylock<CoreLock>(id))
+				{
+					std::this_thread::yield();
+				}
+
+				unlock<CoreLock>(id);
+			}
+		});
+	}
+
+	for (auto& worker : workers)
+	{
+		worker.join();
+	}
+
+	const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	for (auto id : ids)
+	{
+		g_idm.remove<lv2_lwmutex_t>(id);
+	}
+
+	return (double)threads * count / time / 1e6;
+}
+
+int main(int argc, char** argv)
+{
+	const u32 threads = argc > 1 ? std::atoi(argv[1]) : 8;
+	const u32 count = argc > 2 ? std::atoi(argv[2]) : 500000;
+
+	std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+
+	for (u32 n = 1; n <= threads; n *= 2)
+	{
+		std::printf("%2u threads: own lwmutex: core lock %6.2f, object lock %6.2f M ops/s; shared lwmutex: core lock %6.2f, object lock %6.2f M ops/s\n", n,
+			run<true>(n, count, false), run<false>(n, count, false), run<true>(n, count, true), run<false>(n, count, true));
+	}
+
+	return 0;
+}
@@ -0,0 +1,132 @@
+// SPU mailbox ping-pong benchmark (spu_channel_t, spu_channel_4_t, Emu/Cell/SPUThread.cpp)
+// Usage: mbox_bench [round trips]
+// The "PPU" thread writes the SPU inbound mailbox (spu_channel_4_t), the "SPU" thread reads it and replies through a
+// spu_channel_t. Both readers wait like SPUThread::get_ch_value(): poll for the specified count of iterations, then
+// sleep either on the thread's condition variable (old path, also the fallback) or parked on the channel word.
+// Prints round trips per second and the average round trip time.
+
+#include "stdafx.h"
+#include "Emu/Memory/Memory.h"
+#include "Emu/Cell/SPUThread.h"
+
+#include <cstdlib>
+#include <chrono>
+
+// referenced by vm.h inline functions (guest memory isn't used)
+void* const vm::g_base_addr = nullptr;
+
+struct waiter_t
+{
+	std::mutex mutex;
+	std::condition_variable cv;
+};
+
+// reads the channel like SPUThread::get_ch_value()
+template<typename T> static u32 read_channel(T& channel, waiter_t& thread, u32 spin)
+{
+	std::unique_lock<std::mutex> lock(thread.mutex, std::defer_lock);
+
+	for (u32 i = 0; i < spin && !channel.get_count(); i++)
+	{
+		_mm_pause();
+	}
+
+	while (true)
+	{
+		const auto result = channel.try_pop();
+
+		if (std::get<0>(result))
+		{
+			return std::get<1>(result);
+		}
+
+		if (!lock)
+		{
+			if (g_thread_park)
+			{
+				channel.park(10000);
+				continue;
+			}
+
+			lock.lock();
+			continue;
+		}
+
+		thread.cv.wait(lock);
+	}
+}
+
+template<typename T> static void write_channel(T& channel, waiter_t& thread, u32 value)
+{
+	if (channel.push(value))
+	{
+		std::lock_guard<std::mutex> lock(thread.mutex);
+
+		thread.cv.notify_one();
+	}
+}
+
+static double run(u32 count, u32 spin)
+{
+	spu_channel_4_t in_mbox;
+	spu_channel_t out_mbox;
+
+	in_mbox.clear();
+	out_mbox.set_value(0, 0);
+
+	waiter_t ppu, spu;
+
+	std::thread spu_thread([&]()
+	{
+		for (u32 i = 0; i < count; i++)
+		{
+			write_channel(out_mbox, ppu, read_channel(in_mbox, spu, spin) + 1);
+		}
+	});
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (u32 i = 0; i < count; i++)
+	{
+		write_channel(in_mbox, spu, i);
+
+		if (read_channel(out_mbox, ppu, spin) != i + 1)
+		{
+			throw EXCEPTION("Unexpected reply");
+		}
+	}
+
+	const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	spu_thread.join();
+
+	return time;
+}
+
+int main(int argc, char** argv)
+{
+	const u32 count = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+	const bool park = g_thread_park;
+
+	std::printf("hardware threads: %u, parking %s\n", std::thread::hardware_concurrency(), park ? "supported" : "not supported");
+
+	for (u32 spin : { 0, 1000 })
+	{
+		for (bool use_park : { false, true })
+		{
+			if (use_park && !park)
+			{
+				continue;
+			}
+
+			g_thread_park = use_park;
+
+			const double time = run(count, spin);
+
+			std::printf("%-4s spin %4u: %8.0f round trips/s, %6.2f us per round trip\n", use_park ? "park" : "cv", spin, count / time, time * 1e6 / count);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,322 @@
+// Synthetic PKG install benchmark (unpkg)
+// Usage: pkg_bench [package size in MB] [iterations]
+// Builds a retail and a debug package with random file contents and extracts both twice: with the streaming install
+// (DecryptRange on positional reads, decrypted data written straight to the destination, current unpkg) and with the
+// previous two-pass install (the whole body decrypted with the sequential keystream into a temporary .dec file, which
+// is then read back to extract the files). Decryption runs on one thread here; ReadDecrypted additionally splits large
+// reads across threads. Prints MB/s of package data for both paths and checks the extracted data.
+
+#include "stdafx.h"
+#include "Crypto/aes.h"
+#include "Crypto/sha1.h"
+#include "Crypto/key_vault.h"
+#include "Crypto/unpkg.h"
+
+#include <cstdlib>
+#include <chrono>
+
+const u32 file_count = 16;
+
+struct package
+{
+	PKGHeader header;
+	std::vector<PKGEntry> entries;
+	std::vector<u8> body; // plaintext of the encrypted area
+	std::vector<u8> expected; // contents of all files in entry order
+	std::FILE* file;
+};
+
+static u64 read_at(std::FILE* f, u64 offset, void* data, u64 size)
+{
+	std::fseek(f, static_cast<long>(offset), SEEK_SET);
+	return std::fread(data, 1, size, f);
+}
+
+// Previous Decrypt(): keystream generated sequentially for every 16-byte block of the body
+static void legacy_crypt(const PKGHeader& header, u8 key[0x40], aes_context& c, u8 iv[HASH_LEN], u8* buf, u32 length)
+{
+	const u32 bits = (length + HASH_LEN - 1) / HASH_LEN;
+
+	if (header.pkg_type == PKG_RELEASE_TYPE_DEBUG)
+	{
+		for (u32 j = 0; j < bits; j++)
+		{
+			u8 hash[0x14];
+			sha1(key, 0x40, hash);
+			*(u64*)&buf[j * HASH_LEN + 0] ^= *(u64*)&hash[0];
+			*(u64*)&buf[j * HASH_LEN + 8] ^= *(u64*)&hash[8];
+			*(be_t<u64>*)&key[0x38] += 1;
+		}
+	}
+	else
+	{
+		u8 ctr[BUF_SIZE];
+
+		for (u32 j = 0; j < bits; j++)
+		{
+			aes_crypt_ecb(&c, AES_ENCRYPT, iv, ctr + j * HASH_LEN);
+
+			if (!++*(be_t<u64>*)&iv[8])
+			{
+				*(be_t<u64>*)&iv[0] += 1;
+			}
+		}
+
+		for (u32 j = 0; j < length; j++)
+		{
+			buf[j] ^= ctr[j];
+		}
+	}
+}
+
+static void legacy_init(const PKGHeader& header, u8 key[0x40], aes_context& c, u8 iv[HASH_LEN])
+{
+	memset(key, 0, 0x40);
+	memcpy(key + 0x00, &header.qa_digest[0], 8);
+	memcpy(key + 0x08, &header.qa_digest[0], 8);
+	memcpy(key + 0x10, &header.qa_digest[8], 8);
+	memcpy(key + 0x18, &header.qa_digest[8], 8);
+	memcpy(iv, header.klicensee, HASH_LEN);
+	aes_setkey_enc(&c, PKG_AES_KEY, 128);
+}
+
+package make_package(u16 type, u64 size)
+{
+	package pkg{};
+
+	u32 seed = type + 1;
+	const auto rnd = [&]() -> u8
+	{
+		seed = seed * 1103515245 + 12345;
+		return (u8)(seed >> 16);
+	};
+
+	PKGHeader& h = pkg.header;
+	h.pkg_magic = 0x7F504B47;
+	h.pkg_type = type;
+	h.pkg_platform = PKG_PLATFORM_TYPE_PS3;
+	h.header_size = PKG_HEADER_SIZE;
+	h.file_count = file_count;
+	h.data_offset = 0x100;
+	strcpy(h.title_id, "UP0000-BENC00000_00-0000000000000000");
+
+	for (auto& b : h.qa_digest) b = rnd();
+	for (auto& b : h.klicensee) b = rnd();
+
+	// the low half of the counter wraps inside the package
+	*(be_t<u64>*)&h.klicensee[8] = ~0ull - 0x100;
+
+	// entry table, names, then the file data (16-byte aligned)
+	pkg.entries.resize(file_count);
+
+	u64 pos = sizeof(PKGEntry) * file_count;
+	std::vector<std::string> names;
+
+	for (u32 i = 0; i < file_count; i++)
+	{
+		names.emplace_back("USRDIR/file" + std::to_string(i) + ".dat");
+		pkg.entries[i].name_offset = (u32)pos;
+		pkg.entries[i].name_size = (u32)names[i].size();
+		pos += (names[i].size() + 15) & ~15;
+	}
+
+	const u64 file_size = size / file_count;
+
+	for (u32 i = 0; i < file_count; i++)
+	{
+		pkg.entries[i].file_offset = pos;
+		pkg.entries[i].file_size = file_size - i * 7; // unaligned sizes
+		pkg.entries[i].type = PKG_FILE_ENTRY_REGULAR;
+		pos += (pkg.entries[i].file_size + 15) & ~15;
+	}
+
+	pkg.body.resize(pos);
+	memcpy(pkg.body.data(), pkg.entries.data(), sizeof(PKGEntry) * file_count);
+
+	for (u32 i = 0; i < file_count; i++)
+	{
+		memcpy(&pkg.body[pkg.entries[i].name_offset], names[i].data(), names[i].size());
+
+		for (u64 j = 0; j < pkg.entries[i].file_size; j++)
+		{
+			pkg.body[pkg.entries[i].file_offset + j] = rnd();
+		}
+
+		pkg.expected.insert(pkg.expected.end(), pkg.body.begin() + pkg.entries[i].file_offset, pkg.body.begin() + pkg.entries[i].file_offset + pkg.entries[i].file_size);
+	}
+
+	h.data_size = pos;
+	h.pkg_size = h.data_offset + h.data_size + 0x60;
+
+	// encrypt the body with the sequential keystream
+	std::vector<u8> enc(pkg.body);
+
+	u8 key[0x40], iv[HASH_LEN];
+	aes_context c;
+	legacy_init(h, key, c, iv);
+
+	for (u64 p = 0; p < enc.size(); p += BUF_SIZE)
+	{
+		legacy_crypt(h, key, c, iv, enc.data() + p, (u32)std::min<u64>(BUF_SIZE, enc.size() - p));
+	}
+
+	pkg.file = std::tmpfile();
+
+	std::vector<u8> image(h.pkg_size);
+	memcpy(image.data(), &h, sizeof(h));
+	memcpy(image.data() + h.data_offset, enc.data(), enc.size());
+	std::fwrite(image.data(), 1, image.size(), pkg.file);
+	std::fflush(pkg.file);
+
+	return pkg;
+}
+
+// Current install: entries, names and file data are decrypted in place after positional reads
+static bool install_streaming(const package& pkg, std::FILE* out, std::vector<u8>& buf)
+{
+	const PKGHeader& h = pkg.header;
+
+	std::vector<PKGEntry> entries(h.file_count);
+	const u64 size = sizeof(PKGEntry) * h.file_count;
+
+	if (read_at(pkg.file, h.data_offset, entries.data(), size) != size)
+	{
+		return false;
+	}
+
+	DecryptRange(h, 0, (u8*)entries.data(), size);
+
+	for (const auto& entry : entries)
+	{
+		std::string name(entry.name_size, '\0');
+		read_at(pkg.file, h.data_offset + entry.name_offset, &name.front(), entry.name_size);
+		DecryptRange(h, entry.name_offset, (u8*)&name.front(), entry.name_size);
+
+		for (u64 pos = 0; pos < entry.file_size;)
+		{
+			const u64 size = std::min<u64>(buf.size(), entry.file_size - pos);
+
+			if (read_at(pkg.file, h.data_offset + entry.file_offset + pos, buf.data(), size) != size)
+			{
+				return false;
+			}
+
+			DecryptRange(h, entry.file_offset + pos, buf.data(), size);
+			std::fwrite(buf.data(), 1, size, out);
+			pos += size;
+		}
+	}
+
+	return true;
+}
+
+// Previous install: the body is decrypted into a temporary file which is then read back
+static bool install_two_pass(const package& pkg, std::FILE* out, std::FILE* dec)
+{
+	const PKGHeader& h = pkg.header;
+
+	u8 key[0x40], iv[HASH_LEN];
+	aes_context c;
+	legacy_init(h, key, c, iv);
+
+	u8 buf[BUF_SIZE];
+
+	std::rewind(dec);
+	std::fseek(pkg.file, static_cast<long>(h.data_offset), SEEK_SET);
+
+	for (u64 pos = 0; pos < h.data_size; pos += BUF_SIZE)
+	{
+		memset(buf, 0, sizeof(buf));
+		const u32 length = (u32)std::fread(buf, 1, BUF_SIZE, pkg.file);
+		legacy_crypt(h, key, c, iv, buf, length);
+		std::fwrite(buf, 1, length, dec);
+	}
+
+	std::fflush(dec);
+
+	std::vector<PKGEntry> entries(h.file_count);
+	read_at(dec, 0, entries.data(), sizeof(PKGEntry) * h.file_count);
+
+	for (const auto& entry : entries)
+	{
+		read_at(dec, entry.name_offset, buf, entry.name_size);
+		std::fseek(dec, static_cast<long>(entry.file_offset), SEEK_SET);
+
+		for (u64 pos = 0; pos < entry.file_size;)
+		{
+			const u64 size = std::min<u64>(BUF_SIZE, entry.file_size - pos);
+
+			if (std::fread(buf, 1, size, dec) != size)
+			{
+				return false;
+			}
+
+			std::fwrite(buf, 1, size, out);
+			pos += size;
+		}
+	}
+
+	return true;
+}
+
+static bool check_output(const package& pkg, std::FILE* out)
+{
+	std::vector<u8> data(pkg.expected.size() + 1);
+	std::fflush(out);
+
+	return read_at(out, 0, data.data(), data.size()) == pkg.expected.size() && memcmp(data.data(), pkg.expected.data(), pkg.expected.size()) == 0;
+}
+
+int main(int argc, char** argv)
+{
+	const u64 size = (argc > 1 ? std::atoi(argv[1]) : 64) * 1024ull * 1024;
+	const int iterations = argc > 2 ? std::atoi(argv[2]) : 3;
+
+	std::vector<u8> buf(BUF_SIZE * 1024);
+
+	bool ok = true;
+
+	for (const u16 type : { PKG_RELEASE_TYPE_RELEASE, PKG_RELEASE_TYPE_DEBUG })
+	{
+		const package pkg = make_package(type, size);
+		const char* const type_name = type == PKG_RELEASE_TYPE_RELEASE ? "retail" : "debug";
+
+		std::FILE* out = std::tmpfile();
+		std::FILE* dec = std::tmpfile();
+
+		double best_streaming = 0;
+		double best_two_pass = 0;
+
+		for (int i = 0; i < iterations; i++)
+		{
+			using clock = std::chrono::high_resolution_clock;
+			const double mb = pkg.header.data_size / (1024.0 * 1024.0);
+
+			std::rewind(out);
+			auto start = clock::now();
+			ok = install_streaming(pkg, out, buf) && ok;
+			best_streaming = std::max(best_streaming, mb / std::chrono::duration<double>(clock::now() - start).count());
+			ok = check_output(pkg, out) && ok;
+
+			std::rewind(out);
+			start = clock::now();
+			ok = install_two_pass(pkg, out, dec) && ok;
+			best_two_pass = std::max(best_two_pass, mb / std::chrono::duration<double>(clock::now() - start).count());
+			ok = check_output(pkg, out) && ok;
+		}
+
+		std::printf("%-6s package, %llu MB: streaming %.1f MB/s, two-pass %.1f MB/s\n", type_name, (unsigned long long)(pkg.header.data_size >> 20), best_streaming, best_two_pass);
+
+		std::fclose(dec);
+		std::fclose(out);
+		std::fclose(pkg.file);
+	}
+
+	if (!ok)
+	{
+		std::printf("Extracted data mismatch!\n");
+		return 1;
+	}
+
+	return 0;
+}
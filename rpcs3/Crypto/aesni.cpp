@@ -0,0 +1,266 @@
+/*
+ *  AES-NI and SHA extensions support functions
+ *
+ *  Hardware accelerated paths for aes.cpp and sha1.cpp, used only when
+ *  CPUID reports the required features. The regular implementation is
+ *  the fallback.
+ *
+ *  [AES-WP] http://software.intel.com/en-us/articles/intel-advanced-encryption-standard-aes-instructions-set
+ *  [SHA-WP] https://software.intel.com/en-us/articles/intel-sha-extensions
+ */
+
+#include "stdafx.h"
+#include "aesni.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AESNI_TARGET(x)
+#else
+#include <cpuid.h>
+#include <immintrin.h>
+#define AESNI_TARGET(x) __attribute__((target(x)))
+#endif
+
+#include <wmmintrin.h>
+
+static int aesni_disabled = 0;
+
+/*
+ * Force the regular implementation
+ */
+void aesni_disable( int disable )
+{
+    aesni_disabled = disable;
+}
+
+/*
+ * CPUID feature flags (leaf 1 ECX, leaf 7 EBX)
+ */
+typedef struct
+{
+    unsigned int aes_flags;
+    unsigned int sha_flags;
+}
+aesni_cpuid_t;
+
+static aesni_cpuid_t aesni_cpuid( void )
+{
+    aesni_cpuid_t result = { 0, 0 };
+
+#ifdef _MSC_VER
+    int regs[4];
+
+    __cpuid( regs, 0 );
+    const int max_leaf = regs[0];
+
+    __cpuid( regs, 1 );
+    result.aes_flags = regs[2];
+
+    if( max_leaf >= 7 )
+    {
+        __cpuidex( regs, 7, 0 );
+        result.sha_flags = regs[1];
+    }
+#else
+    unsigned int eax, ebx, ecx, edx;
+
+    const unsigned int max_leaf = __get_cpuid_max( 0, 0 );
+
+    if( __get_cpuid( 1, &eax, &ebx, &ecx, &edx ) )
+        result.aes_flags = ecx;
+
+    if( max_leaf >= 7 )
+    {
+        __cpuid_count( 7, 0, eax, ebx, ecx, edx );
+        result.sha_flags = ebx;
+    }
+#endif
+
+    return( result );
+}
+
+/*
+ * AES-NI / SHA extensions support detection
+ *
+ * Called concurrently by the threads of parallel_for(), the function-local
+ * static is initialized only once (thread-safe initialization).
+ */
+int aesni_supports( unsigned int what )
+{
+    static const aesni_cpuid_t cpuid = aesni_cpuid();
+
+    if( aesni_disabled )
+        return( 0 );
+
+    switch( what )
+    {
+        case POLARSSL_AESNI_AES: return( ( cpuid.aes_flags & what ) != 0 );
+        case POLARSSL_AESNI_SHA: return( ( cpuid.sha_flags & what ) != 0 );
+    }
+
+    return( 0 );
+}
+
+/*
+ * AES-NI AES-ECB block en(de)cryption
+ *
+ * The regular key schedule stores the round keys as little endian words,
+ * which is the layout expected by AESENC. The decryption key schedule is
+ * the "equivalent inverse cipher" one, as expected by AESDEC.
+ */
+AESNI_TARGET("aes,sse2")
+int aesni_crypt_ecb( aes_context *ctx,
+                     int mode,
+                     const unsigned char input[16],
+                     unsigned char output[16] )
+{
+    const __m128i *rk = (const __m128i *) ctx->rk;
+    __m128i state = _mm_xor_si128( _mm_loadu_si128( (const __m128i *) input ), _mm_loadu_si128( rk ) );
+    int i;
+
+    if( mode == AES_DECRYPT )
+    {
+        for( i = 1; i < ctx->nr; i++ )
+            state = _mm_aesdec_si128( state, _mm_loadu_si128( rk + i ) );
+
+        state = _mm_aesdeclast_si128( state, _mm_loadu_si128( rk + ctx->nr ) );
+    }
+    else
+    {
+        for( i = 1; i < ctx->nr; i++ )
+            state = _mm_aesenc_si128( state, _mm_loadu_si128( rk + i ) );
+
+        state = _mm_aesenclast_si128( state, _mm_loadu_si128( rk + ctx->nr ) );
+    }
+
+    _mm_storeu_si128( (__m128i *) output, state );
+
+    return( 0 );
+}
+
+/*
+ * AES-NI AES-CBC decryption (blocks are independent, so four are interleaved)
+ */
+AESNI_TARGET("aes,sse2")
+void aesni_crypt_cbc_dec( aes_context *ctx,
+                          size_t length,
+                          unsigned char iv[16],
+                          const unsigned char *input,
+                          unsigned char *output )
+{
+    const __m128i *rk = (const __m128i *) ctx->rk;
+    const int nr = ctx->nr;
+    __m128i prev = _mm_loadu_si128( (const __m128i *) iv );
+    int i;
+
+    for( ; length >= 64; length -= 64, input += 64, output += 64 )
+    {
+        const __m128i in0 = _mm_loadu_si128( (const __m128i *) input + 0 );
+        const __m128i in1 = _mm_loadu_si128( (const __m128i *) input + 1 );
+        const __m128i in2 = _mm_loadu_si128( (const __m128i *) input + 2 );
+        const __m128i in3 = _mm_loadu_si128( (const __m128i *) input + 3 );
+
+        __m128i key = _mm_loadu_si128( rk );
+        __m128i b0 = _mm_xor_si128( in0, key );
+        __m128i b1 = _mm_xor_si128( in1, key );
+        __m128i b2 = _mm_xor_si128( in2, key );
+        __m128i b3 = _mm_xor_si128( in3, key );
+
+        for( i = 1; i < nr; i++ )
+        {
+            key = _mm_loadu_si128( rk + i );
+            b0 = _mm_aesdec_si128( b0, key );
+            b1 = _mm_aesdec_si128( b1, key );
+            b2 = _mm_aesdec_si128( b2, key );
+            b3 = _mm_aesdec_si128( b3, key );
+        }
+
+        key = _mm_loadu_si128( rk + nr );
+        b0 = _mm_aesdeclast_si128( b0, key );
+        b1 = _mm_aesdeclast_si128( b1, key );
+        b2 = _mm_aesdeclast_si128( b2, key );
+        b3 = _mm_aesdeclast_si128( b3, key );
+
+        _mm_storeu_si128( (__m128i *) output + 0, _mm_xor_si128( b0, prev ) );
+        _mm_storeu_si128( (__m128i *) output + 1, _mm_xor_si128( b1, in0 ) );
+        _mm_storeu_si128( (__m128i *) output + 2, _mm_xor_si128( b2, in1 ) );
+        _mm_storeu_si128( (__m128i *) output + 3, _mm_xor_si128( b3, in2 ) );
+
+        prev = in3;
+    }
+
+    for( ; length >= 16; length -= 16, input += 16, output += 16 )
+    {
+        const __m128i in = _mm_loadu_si128( (const __m128i *) input );
+
+        __m128i b = _mm_xor_si128( in, _mm_loadu_si128( rk ) );
+
+        for( i = 1; i < nr; i++ )
+            b = _mm_aesdec_si128( b, _mm_loadu_si128( rk + i ) );
+
+        b = _mm_aesdeclast_si128( b, _mm_loadu_si128( rk + nr ) );
+
+        _mm_storeu_si128( (__m128i *) output, _mm_xor_si128( b, prev ) );
+
+        prev = in;
+    }
+
+    _mm_storeu_si128( (__m128i *) iv, prev );
+}
+
+/*
+ * SHA-1 block processing with SHA extensions
+ *
+ * Each step performs four rounds; the message schedule is computed
+ * three steps ahead with SHA1MSG1/SHA1MSG2 (see [SHA-WP]).
+ */
+#define SHA1_STEP( i, E, E_NEXT )                                               \
+{                                                                               \
+    E = _mm_sha1nexte_epu32( E, MSG[(i) & 3] );                                 \
+    E_NEXT = ABCD;                                                              \
+    if( (i) >= 3 && (i) <= 18 )                                                 \
+        MSG[((i) + 1) & 3] = _mm_sha1msg2_epu32( MSG[((i) + 1) & 3], MSG[(i) & 3] ); \
+    ABCD = _mm_sha1rnds4_epu32( ABCD, E, (i) / 5 );                             \
+    if( (i) <= 16 )                                                             \
+        MSG[((i) + 3) & 3] = _mm_sha1msg1_epu32( MSG[((i) + 3) & 3], MSG[(i) & 3] ); \
+    if( (i) >= 2 && (i) <= 17 )                                                 \
+        MSG[((i) + 2) & 3] = _mm_xor_si128( MSG[((i) + 2) & 3], MSG[(i) & 3] ); \
+}
+
+AESNI_TARGET("sha,sse4.1")
+void aesni_sha1_process( uint32_t state[5], const unsigned char data[64] )
+{
+    const __m128i MASK = _mm_set_epi64x( 0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL );
+
+    __m128i ABCD = _mm_shuffle_epi32( _mm_loadu_si128( (const __m128i *) state ), 0x1B );
+    __m128i E0 = _mm_set_epi32( state[4], 0, 0, 0 );
+    __m128i E1;
+    __m128i MSG[4];
+
+    const __m128i ABCD_SAVE = ABCD;
+    const __m128i E0_SAVE = E0;
+
+    MSG[0] = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i *) data + 0 ), MASK );
+    MSG[1] = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i *) data + 1 ), MASK );
+    MSG[2] = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i *) data + 2 ), MASK );
+    MSG[3] = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i *) data + 3 ), MASK );
+
+    /* Rounds 0-3 */
+    E0 = _mm_add_epi32( E0, MSG[0] );
+    E1 = ABCD;
+    ABCD = _mm_sha1rnds4_epu32( ABCD, E0, 0 );
+
+    /* Rounds 4-79 */
+    SHA1_STEP(  1, E1, E0 ); SHA1_STEP(  2, E0, E1 ); SHA1_STEP(  3, E1, E0 ); SHA1_STEP(  4, E0, E1 );
+    SHA1_STEP(  5, E1, E0 ); SHA1_STEP(  6, E0, E1 ); SHA1_STEP(  7, E1, E0 ); SHA1_STEP(  8, E0, E1 );
+    SHA1_STEP(  9, E1, E0 ); SHA1_STEP( 10, E0, E1 ); SHA1_STEP( 11, E1, E0 ); SHA1_STEP( 12, E0, E1 );
+    SHA1_STEP( 13, E1, E0 ); SHA1_STEP( 14, E0, E1 ); SHA1_STEP( 15, E1, E0 ); SHA1_STEP( 16, E0, E1 );
+    SHA1_STEP( 17, E1, E0 ); SHA1_STEP( 18, E0, E1 ); SHA1_STEP( 19, E1, E0 );
+
+    /* Add the saved state */
+    E0 = _mm_sha1nexte_epu32( E0, E0_SAVE );
+    ABCD = _mm_add_epi32( ABCD, ABCD_SAVE );
+
+    _mm_storeu_si128( (__m128i *) state, _mm_shuffle_epi32( ABCD, 0x1B ) );
+    state[4] = _mm_extract_epi32( E0, 3 );
+}
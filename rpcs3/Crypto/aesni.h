@@ -0,0 +1,75 @@
+#pragma once
+
+/**
+ * \file aesni.h
+ *
+ * \brief AES-NI and SHA extensions support, selected at runtime
+ */
+
+#include "aes.h"
+
+#define POLARSSL_AESNI_AES      0x02000000u /**< CPUID.1:ECX bit 25 */
+#define POLARSSL_AESNI_SHA      0x20000000u /**< CPUID.7:EBX bit 29 */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * \brief          AES-NI / SHA extensions features detection
+ *
+ * \param what     POLARSSL_AESNI_AES or POLARSSL_AESNI_SHA
+ *
+ * \return         1 if CPU has support for the feature, 0 otherwise
+ */
+int aesni_supports( unsigned int what );
+
+/**
+ * \brief          Force the regular implementation even if the CPU supports
+ *                 the extensions (used to cross-check both paths)
+ *
+ * \param disable  1 to disable AES-NI and SHA extensions, 0 to re-enable them
+ */
+void aesni_disable( int disable );
+
+/**
+ * \brief          AES-NI AES-ECB block en(de)cryption
+ *
+ * \param ctx      AES context (the round keys of the regular key schedule are used as is)
+ * \param mode     AES_ENCRYPT or AES_DECRYPT
+ * \param input    16-byte input block
+ * \param output   16-byte output block
+ *
+ * \return         0 on success (cannot fail)
+ */
+int aesni_crypt_ecb( aes_context *ctx,
+                     int mode,
+                     const unsigned char input[16],
+                     unsigned char output[16] );
+
+/**
+ * \brief          AES-NI AES-CBC decryption, four blocks are processed in parallel
+ *
+ * \param ctx      AES context
+ * \param length   length of the input data (multiple of 16)
+ * \param iv       initialization vector (updated after use)
+ * \param input    buffer holding the input data
+ * \param output   buffer holding the output data
+ */
+void aesni_crypt_cbc_dec( aes_context *ctx,
+                          size_t length,
+                          unsigned char iv[16],
+                          const unsigned char *input,
+                          unsigned char *output );
+
+/**
+ * \brief          SHA-1 block processing using SHA extensions
+ *
+ * \param state    SHA-1 intermediate digest state (updated)
+ * \param data     64-byte data block
+ */
+void aesni_sha1_process( uint32_t state[5], const unsigned char data[64] );
+
+#ifdef __cplusplus
+}
+#endif
@@ -137,6 +137,55 @@ unsigned char* get_block_key(int block, NPD_HEADER *npd)
 	return dest_key;
 }
 
+// Decrypt a single data block: generate the block key, select crypto and hash modes and check the hash.
+// length is padded to 16 bytes, hash_result is the hash stored in the block metadata.
+bool decrypt_block(EDAT_HEADER *edat, NPD_HEADER *npd, unsigned char* crypt_key, int block, unsigned char *enc_data, unsigned char *dec_data, int length, unsigned char *hash_result)
+{
+	unsigned char hash[0x10] = {};
+	unsigned char key_result[0x10] = {};
+	unsigned char empty_iv[0x10] = {};
+
+	// Generate a key for the current block.
+	std::unique_ptr<unsigned char[]> b_key(get_block_key(block, npd));
+
+	// Encrypt the block key with the crypto key.
+	aesecb128_encrypt(crypt_key, b_key.get(), key_result);
+	if ((edat->flags & EDAT_FLAG_0x10) != 0)
+		aesecb128_encrypt(crypt_key, key_result, hash);  // If FLAG 0x10 is set, encrypt again to get the final hash.
+	else
+		memcpy(hash, key_result, 0x10);
+
+	// Setup the crypto and hashing mode based on the extra flags.
+	int crypto_mode = ((edat->flags & EDAT_FLAG_0x02) == 0) ? 0x2 : 0x1;
+	int hash_mode;
+
+	if ((edat->flags  & EDAT_FLAG_0x10) == 0)
+		hash_mode = 0x02;
+	else if ((edat->flags & EDAT_FLAG_0x20) == 0)
+		hash_mode = 0x04;
+	else
+		hash_mode = 0x01;
+
+	if ((edat->flags  & EDAT_ENCRYPTED_KEY_FLAG) != 0)
+	{
+		crypto_mode |= 0x10000000;
+		hash_mode |= 0x10000000;
+	}
+
+	if ((edat->flags  & EDAT_DEBUG_DATA_FLAG) != 0)
+	{
+		// Simply copy the data without the header or the footer.
+		memcpy(dec_data, enc_data, length);
+		return true;
+	}
+
+	// IV is null if NPD version is 1 or 0.
+	unsigned char *iv = (npd->version <= 1) ? empty_iv : npd->digest;
+
+	// Call main crypto routine on this data block.
+	return decrypt(hash_mode, crypto_mode, (npd->version == 4), enc_data, dec_data, length, key_result, iv, hash, hash_result);
+}
+
 // EDAT/SDAT decryption.
 int decrypt_data(const fs::file* in, const fs::file* out, EDAT_HEADER *edat, NPD_HEADER *npd, unsigned char* crypt_key, bool verbose)
 {
@@ -147,21 +196,14 @@ int decrypt_data(const fs::file* in, const fs::file* out, EDAT_HEADER *edat, NPD
 
 	unsigned char *enc_data;
 	unsigned char *dec_data;
-	unsigned char *b_key;
-	unsigned char *iv;
 
-	unsigned char hash[0x10];
-	unsigned char key_result[0x10];
 	unsigned char hash_result[0x14];
-	memset(hash, 0, 0x10);
-	memset(key_result, 0, 0x10);
 	memset(hash_result, 0, 0x14);
 
 	unsigned long long offset = 0;
 	unsigned long long metadata_sec_offset = 0;
 	int length = 0;
 	int compression_end = 0;
-	unsigned char empty_iv[0x10] = {};
 
 	// Decrypt the metadata.
 	int i;
@@ -241,59 +283,16 @@ int decrypt_data(const fs::file* in, const fs::file* out, EDAT_HEADER *edat, NPD
 		dec_data = new unsigned char[length];
 		memset(enc_data, 0, length);
 		memset(dec_data, 0, length);
-		memset(hash, 0, 0x10);
-		memset(key_result, 0, 0x10);
 
 		in->seek(offset);
 		in->read(enc_data, length);
 
-		// Generate a key for the current block.
-		b_key = get_block_key(i, npd);
-
-		// Encrypt the block key with the crypto key.
-		aesecb128_encrypt(crypt_key, b_key, key_result);
-		if ((edat->flags & EDAT_FLAG_0x10) != 0)
-			aesecb128_encrypt(crypt_key, key_result, hash);  // If FLAG 0x10 is set, encrypt again to get the final hash.
-		else
-			memcpy(hash, key_result, 0x10);
-
-		// Setup the crypto and hashing mode based on the extra flags.
-		int crypto_mode = ((edat->flags & EDAT_FLAG_0x02) == 0) ? 0x2 : 0x1;
-		int hash_mode;
-
-		if ((edat->flags  & EDAT_FLAG_0x10) == 0)
-			hash_mode = 0x02;
-		else if ((edat->flags & EDAT_FLAG_0x20) == 0)
-			hash_mode = 0x04;
-		else
-			hash_mode = 0x01;
-
-		if ((edat->flags  & EDAT_ENCRYPTED_KEY_FLAG) != 0)
+		if (!decrypt_block(edat, npd, crypt_key, i, enc_data, dec_data, length, hash_result))
 		{
-			crypto_mode |= 0x10000000;
-			hash_mode |= 0x10000000;
-		}
+			if (verbose)
+				LOG_WARNING(LOADER, "EDAT: Block at offset 0x%llx has invalid hash!", (u64)offset);
 
-		if ((edat->flags  & EDAT_DEBUG_DATA_FLAG) != 0)
-		{
-			// Reset the flags.
-			crypto_mode |= 0x01000000;
-			hash_mode |= 0x01000000;
-			// Simply copy the data without the header or the footer.
-			memcpy(dec_data, enc_data, length);
-		}
-		else
-		{
-			// IV is null if NPD version is 1 or 0.
-			iv = (npd->version <= 1) ? empty_iv : npd->digest;
-			// Call main crypto routine on this data block.
-			if (!decrypt(hash_mode, crypto_mode, (npd->version == 4), enc_data, dec_data, length, key_result, iv, hash, hash_result))
-			{
-				if (verbose)
-					LOG_WARNING(LOADER, "EDAT: Block at offset 0x%llx has invalid hash!", (u64)offset);
-					
-				return 1;
-			}
+			return 1;
 		}
 
 		// Apply additional compression if needed and write the decrypted data.
@@ -895,3 +894,276 @@ int DecryptEDAT(const std::string& input_file_name, const std::string& output_fi
 	
 	return 0;
 }
+
+void GetEDATRifKey(const std::string& rap_file_name, unsigned char *rifkey)
+{
+	memset(rifkey, 0, 0x10);
+
+	if (fs::file rap{ rap_file_name })
+	{
+		unsigned char rapkey[0x10] = {};
+
+		rap.read(rapkey, 0x10);
+
+		rap_to_rif(rapkey, rifkey);
+	}
+}
+
+EDATADecrypter::EDATADecrypter(std::shared_ptr<vfsStream> input, const std::string& name, const unsigned char* devklic, const unsigned char* rifkey)
+	: m_file(std::move(input))
+	, m_name(name)
+	, m_npd{}
+	, m_edat{}
+	, m_key{}
+	, m_devklic{}
+	, m_rifkey{}
+{
+	if (devklic)
+	{
+		memcpy(m_devklic, devklic, 0x10);
+	}
+
+	if (rifkey)
+	{
+		memcpy(m_rifkey, rifkey, 0x10);
+	}
+}
+
+bool EDATADecrypter::ReadHeader()
+{
+	unsigned char npd_header[0x80];
+	unsigned char edat_header[0x10];
+
+	if (m_file->ReadAt(0, npd_header, sizeof(npd_header)) != sizeof(npd_header) || m_file->ReadAt(0x80, edat_header, sizeof(edat_header)) != sizeof(edat_header))
+	{
+		return false;
+	}
+
+	memcpy(m_npd.magic, npd_header, 4);
+	m_npd.version = swap32(*(int*)&npd_header[4]);
+	m_npd.license = swap32(*(int*)&npd_header[8]);
+	m_npd.type = swap32(*(int*)&npd_header[12]);
+	memcpy(m_npd.content_id, &npd_header[16], 0x30);
+	memcpy(m_npd.digest, &npd_header[64], 0x10);
+	memcpy(m_npd.title_hash, &npd_header[80], 0x10);
+	memcpy(m_npd.dev_hash, &npd_header[96], 0x10);
+	m_npd.unk1 = swap64(*(u64*)&npd_header[112]);
+	m_npd.unk2 = swap64(*(u64*)&npd_header[120]);
+
+	if (memcmp(m_npd.magic, "NPD\0", 4))
+	{
+		LOG_ERROR(LOADER, "EDAT: Invalid NPD header.");
+		return false;
+	}
+
+	m_edat.flags = swap32(*(int*)&edat_header[0]);
+	m_edat.block_size = swap32(*(int*)&edat_header[4]);
+	m_edat.file_size = swap64(*(u64*)&edat_header[8]);
+
+	if ((m_edat.flags & SDAT_FLAG) == SDAT_FLAG)
+	{
+		// Generate SDAT key.
+		xor_key(m_key, m_npd.dev_hash, SDAT_KEY, 0x10);
+	}
+	else
+	{
+		// Perform header validation (see extract_data()).
+		char real_file_name[MAX_PATH];
+		extract_file_name(m_name.c_str(), real_file_name);
+
+		if (!validate_npd_hashes(real_file_name, m_devklic, &m_npd, false) && (m_edat.flags & EDAT_DEBUG_DATA_FLAG) != EDAT_DEBUG_DATA_FLAG)
+		{
+			LOG_ERROR(LOADER, "EDAT: NPD hash validation failed!");
+			return false;
+		}
+
+		// Select EDAT key.
+		if ((m_npd.license & 0x3) == 0x3)
+		{
+			memcpy(m_key, m_devklic, 0x10);
+		}
+		else if ((m_npd.license & 0x2) == 0x2)
+		{
+			static const unsigned char empty_key[0x10] = {};
+
+			if (!memcmp(m_rifkey, empty_key, 0x10))
+			{
+				LOG_ERROR(LOADER, "EDAT: A valid RAP file is needed for this EDAT file!");
+				return false;
+			}
+
+			memcpy(m_key, m_rifkey, 0x10);
+		}
+		else if ((m_npd.license & 0x1) == 0x1)
+		{
+			LOG_ERROR(LOADER, "EDAT: Network license not supported!");
+			return false;
+		}
+	}
+
+	if (m_edat.flags & EDAT_COMPRESSED_FLAG)
+	{
+		LOG_ERROR(LOADER, "EDAT: Compressed data can't be decrypted on demand.");
+		return false;
+	}
+
+	if (m_edat.block_size <= 0 || m_edat.block_size & 0xF)
+	{
+		LOG_ERROR(LOADER, "EDAT: Invalid block size (0x%x).", m_edat.block_size);
+		return false;
+	}
+
+	m_block_count = (u32)((m_edat.file_size + m_edat.block_size - 1) / m_edat.block_size);
+
+	return true;
+}
+
+bool EDATADecrypter::DecryptBlock(u32 block, u8* dst)
+{
+	const int metadata_offset = 0x100;
+	const int metadata_section_size = (m_edat.flags & EDAT_FLAG_0x20) != 0 ? 0x20 : 0x10;
+
+	unsigned char hash_result[0x14] = {};
+	unsigned long long offset;
+
+	int length = m_edat.block_size;
+
+	if ((block == m_block_count - 1) && (m_edat.file_size % m_edat.block_size))
+		length = (int)(m_edat.file_size % m_edat.block_size);
+
+	// Locate the metadata and the real data (see decrypt_data()).
+	if ((m_edat.flags & EDAT_FLAG_0x20) != 0)
+	{
+		// If FLAG 0x20, the metadata precedes each data block.
+		const u64 metadata_sec_offset = metadata_offset + (u64)block * (metadata_section_size + m_edat.block_size);
+
+		unsigned char metadata[0x20];
+		if (m_file->ReadAt(metadata_sec_offset, metadata, 0x20) != 0x20)
+		{
+			return false;
+		}
+
+		memcpy(hash_result, metadata, 0x14);
+
+		for (int j = 0; j < 0x10; j++)
+			hash_result[j] = (unsigned char)(metadata[j] ^ metadata[j + 0x10]);
+
+		offset = metadata_sec_offset + 0x20;
+	}
+	else
+	{
+		if (m_file->ReadAt(metadata_offset + (u64)block * metadata_section_size, hash_result, 0x10) != 0x10)
+		{
+			return false;
+		}
+
+		offset = metadata_offset + (u64)block * m_edat.block_size + (u64)m_block_count * metadata_section_size;
+	}
+
+	const int pad_length = length;
+	length = (pad_length + 0xF) & 0xFFFFFFF0;
+
+	std::unique_ptr<unsigned char[]> enc_data(new unsigned char[length]());
+
+	if (m_file->ReadAt(offset, enc_data.get(), length) < (u64)pad_length)
+	{
+		return false;
+	}
+
+	std::unique_ptr<unsigned char[]> dec_data(new unsigned char[length]());
+
+	if (!decrypt_block(&m_edat, &m_npd, m_key, block, enc_data.get(), dec_data.get(), length, hash_result))
+	{
+		LOG_ERROR(LOADER, "EDAT: Block %d at offset 0x%llx has invalid hash!", block, (u64)offset);
+		return false;
+	}
+
+	memcpy(dst, dec_data.get(), pad_length);
+	return true;
+}
+
+u64 EDATADecrypter::ReadAt(u64 offset, void* dst, u64 count)
+{
+	if (offset >= m_edat.file_size)
+	{
+		return 0;
+	}
+
+	count = std::min<u64>(count, m_edat.file_size - offset);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	u64 done = 0;
+
+	while (done < count)
+	{
+		const u32 block = (u32)((offset + done) / m_edat.block_size);
+		const u32 pos = (u32)((offset + done) % m_edat.block_size);
+		const u64 size = std::min<u64>(m_edat.block_size - pos, count - done);
+
+		auto found = std::find_if(m_cache.begin(), m_cache.end(), [=](const std::pair<u32, std::vector<u8>>& entry) { return entry.first == block; });
+
+		if (found != m_cache.end())
+		{
+			// move to the back (most recently used)
+			std::rotate(found, found + 1, m_cache.end());
+		}
+		else
+		{
+			std::vector<u8> data(m_edat.block_size);
+
+			// the underlying stream may be read concurrently only if it supports positional reads
+			if (m_file->IsPositional()) lock.unlock();
+
+			const bool result = DecryptBlock(block, data.data());
+
+			if (!lock) lock.lock();
+
+			if (!result)
+			{
+				break;
+			}
+
+			// another reader may have decrypted the same block while the lock was released
+			found = std::find_if(m_cache.begin(), m_cache.end(), [=](const std::pair<u32, std::vector<u8>>& entry) { return entry.first == block; });
+
+			if (found != m_cache.end())
+			{
+				std::rotate(found, found + 1, m_cache.end());
+			}
+			else
+			{
+				if (m_cache.size() >= cache_size)
+				{
+					m_cache.erase(m_cache.begin());
+				}
+
+				m_cache.emplace_back(block, std::move(data));
+			}
+		}
+
+		memcpy((u8*)dst + done, m_cache.back().second.data() + pos, size);
+		done += size;
+	}
+
+	return done;
+}
+
+u64 EDATADecrypter::Read(void* dst, u64 count)
+{
+	const u64 result = ReadAt(m_pos, dst, count);
+	m_pos += result;
+	return result;
+}
+
+u64 EDATADecrypter::Seek(s64 offset, u32 mode)
+{
+	switch (mode)
+	{
+	case from_begin: m_pos = offset; break;
+	case from_cur: m_pos += offset; break;
+	case from_end: m_pos = m_edat.file_size + offset; break;
+	}
+
+	return m_pos;
+}
@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "utils.h"
+#include "Emu/FS/vfsStream.h"
 
 #define SDAT_FLAG 0x01000000
 #define EDAT_COMPRESSED_FLAG 0x00000001
@@ -34,3 +35,59 @@ typedef struct
 } EDAT_HEADER;
 
 int DecryptEDAT(const std::string& input_file_name, const std::string& output_file_name, int mode, const std::string& rap_file_name, unsigned char *custom_klic, bool verbose);
+
+// Read the RIF key from the RAP file (zero key if the file doesn't exist)
+void GetEDATRifKey(const std::string& rap_file_name, unsigned char *rifkey);
+
+// Read-only stream decrypting EDAT/SDATA blocks on demand (compressed data is not supported)
+class EDATADecrypter final : public vfsStream
+{
+	const std::shared_ptr<vfsStream> m_file;
+
+	const std::string m_name; // file name (checked by the NPD header hash)
+
+	NPD_HEADER m_npd;
+	EDAT_HEADER m_edat;
+	unsigned char m_key[0x10];
+	unsigned char m_devklic[0x10];
+	unsigned char m_rifkey[0x10];
+
+	u32 m_block_count = 0;
+	u64 m_pos = 0;
+
+	// recently decrypted blocks, the most recently used is at the back
+	std::mutex m_mutex;
+	std::vector<std::pair<u32, std::vector<u8>>> m_cache;
+
+	static const u32 cache_size = 8;
+
+	bool DecryptBlock(u32 block, u8* dst);
+
+public:
+	// EDAT files require the file name, klicensee and RIF key (depending on the license type), SDATA key is generated from the header
+	EDATADecrypter(std::shared_ptr<vfsStream> input, const std::string& name = "", const unsigned char* devklic = nullptr, const unsigned char* rifkey = nullptr);
+
+	// parse and check headers, must be called before reading
+	bool ReadHeader();
+
+	virtual u64 GetSize() const override { return m_edat.file_size; }
+
+	virtual u64 Write(const void* src, u64 count) override { return 0; }
+
+	virtual u64 Read(void* dst, u64 count) override;
+
+	virtual u64 Seek(s64 offset, u32 mode = from_begin) override;
+
+	virtual u64 Tell() const override { return m_pos; }
+
+	virtual u64 ReadAt(u64 offset, void* dst, u64 count) override;
+
+	virtual u64 WriteAt(u64 offset, const void* src, u64 count) override { return 0; }
+
+	virtual bool IsPositional() const override { return true; }
+
+	virtual bool IsOpened() const override { return m_file && m_file->IsOpened(); }
+
+	// encrypted stream
+	const std::shared_ptr<vfsStream>& GetInput() const { return m_file; }
+};
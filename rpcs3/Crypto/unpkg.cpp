@@ -1,10 +1,8 @@
 #include "stdafx.h"
 #include "Utilities/Log.h"
 #include "Utilities/File.h"
+#include "Utilities/Thread.h"
 #include "utils.h"
-#include "aes.h"
-#include "sha1.h"
-#include "key_vault.h"
 #include "unpkg.h"
 #include "restore_new.h"
 #pragma warning(push)
@@ -82,88 +80,34 @@ bool LoadHeader(const fs::file& pkg_f, PKGHeader* m_header)
 	return true;
 }
 
-int Decrypt(const fs::file& pkg_f, const fs::file& dec_pkg_f, PKGHeader* m_header)
+// Read and decrypt data from the encrypted area, large ranges are decrypted in 64 KiB parts by the worker pool
+u64 ReadDecrypted(const fs::file& pkg_f, const PKGHeader& header, u64 offset, void* data, u64 size)
 {
-	if (!LoadHeader(pkg_f, m_header))
+	const u64 read = pkg_f.read_at(header.data_offset + offset, data, size);
+
+	if (read == -1)
 	{
 		return -1;
 	}
 
-	aes_context c;
-	u8 iv[HASH_LEN];
-	u8 buf[BUF_SIZE];
-	u8 ctr[BUF_SIZE];
-	
-	// Debug key
-	u8 key[0x40];
-	memset(key, 0, 0x40);
-	memcpy(key+0x00, &m_header->qa_digest[0], 8); // &data[0x60]
-	memcpy(key+0x08, &m_header->qa_digest[0], 8); // &data[0x60]
-	memcpy(key+0x10, &m_header->qa_digest[8], 8); // &data[0x68]
-	memcpy(key+0x18, &m_header->qa_digest[8], 8); // &data[0x68]
-
-	pkg_f.seek(m_header->data_offset);
-	u32 parts = (m_header->data_size + BUF_SIZE - 1) / BUF_SIZE;
+	const u64 part = 0x10000;
 
-	wxProgressDialog pdlg("PKG Decrypter / Installer", "Please wait, decrypting...", parts, 0, wxPD_AUTO_HIDE | wxPD_APP_MODAL);
-
-	memcpy(iv, m_header->klicensee, sizeof(iv));
-	aes_setkey_enc(&c, PKG_AES_KEY, 128);
-	
-	for (u32 i = 0; i < parts; i++)
+	parallel_for(static_cast<u32>((read + part - 1) / part), [&](u32 i)
 	{
-		memset(buf, 0, sizeof(buf));
-		u32 length = pkg_f.read(buf, BUF_SIZE);
-		u32 bits = (length + HASH_LEN - 1) / HASH_LEN;
-		
-		if (m_header->pkg_type == PKG_RELEASE_TYPE_DEBUG)
-		{
-			for (u32 j = 0; j < bits; j++)
-			{
-				u8 hash[0x14];
-				sha1(key, 0x40, hash);
-				*(u64*)&buf[j * HASH_LEN + 0] ^= *(u64*)&hash[0];
-				*(u64*)&buf[j * HASH_LEN + 8] ^= *(u64*)&hash[8];
-				*(be_t<u64>*)&key[0x38] += 1;
-			}
-		}
+		const u64 pos = i * part;
 
-		if (m_header->pkg_type == PKG_RELEASE_TYPE_RELEASE)
-		{
-			for (u32 j = 0; j < bits; j++)
-			{
-				aes_crypt_ecb(&c, AES_ENCRYPT, iv, ctr + j * HASH_LEN);
-
-				be_t<u64> hi = *(be_t<u64>*)&iv[0];
-				be_t<u64> lo = *(be_t<u64>*)&iv[8];
-				lo++;
+		DecryptRange(header, offset + pos, static_cast<u8*>(data) + pos, std::min<u64>(part, read - pos));
+	});
 
-				if (lo == 0)
-					hi += 1;
-
-				*(be_t<u64>*)&iv[0] = hi;
-				*(be_t<u64>*)&iv[8] = lo;
-			}
-		
-			for (u32 j = 0; j < length; j++)
-			{
-				buf[j] ^= ctr[j];
-			}
-		}		
-		dec_pkg_f.write(buf, length);
-		pdlg.Update(i);
-	}
-	pdlg.Update(parts);
-	return 0;
+	return read;
 }
 
 // Unpacking.
-bool LoadEntries(const fs::file& dec_pkg_f, PKGHeader* m_header, PKGEntry* m_entries)
+bool LoadEntries(const fs::file& pkg_f, const PKGHeader& header, PKGEntry* m_entries)
 {
-	dec_pkg_f.seek(0);
-	dec_pkg_f.read(m_entries, sizeof(PKGEntry) * m_header->file_count);
-	
-	if (m_entries->name_offset / sizeof(PKGEntry) != m_header->file_count)
+	const u64 size = sizeof(PKGEntry) * header.file_count;
+
+	if (ReadDecrypted(pkg_f, header, 0, m_entries, size) != size || m_entries->name_offset / sizeof(PKGEntry) != header.file_count)
 	{
 		LOG_ERROR(LOADER, "PKG: Entries are damaged!");
 		return false;
@@ -172,14 +116,16 @@ bool LoadEntries(const fs::file& dec_pkg_f, PKGHeader* m_header, PKGEntry* m_ent
 	return true;
 }
 
-bool UnpackEntry(const fs::file& dec_pkg_f, const PKGEntry& entry, std::string dir)
+bool UnpackEntry(const fs::file& pkg_f, const PKGHeader& header, const PKGEntry& entry, std::string dir, std::vector<u8>& buf)
 {
-	char buf[BUF_SIZE];
+	std::string name(entry.name_size, '\0');
+
+	if (ReadDecrypted(pkg_f, header, entry.name_offset, &name.front(), entry.name_size) != entry.name_size)
+	{
+		LOG_ERROR(LOADER, "PKG Loader: Could not read entry name");
+		return false;
+	}
 
-	dec_pkg_f.seek(entry.name_offset);
-	dec_pkg_f.read(buf, entry.name_size);
-	buf[entry.name_size] = 0;
-	
 	switch (entry.type & 0xff)
 	{
 	case PKG_FILE_ENTRY_NPDRM:
@@ -187,7 +133,7 @@ bool UnpackEntry(const fs::file& dec_pkg_f, const PKGEntry& entry, std::string d
 	case PKG_FILE_ENTRY_SDAT:
 	case PKG_FILE_ENTRY_REGULAR:
 	{
-		const std::string path = dir + std::string(buf, entry.name_size);
+		const std::string path = dir + name;
 
 		if (fs::is_file(path))
 		{
@@ -198,20 +144,20 @@ bool UnpackEntry(const fs::file& dec_pkg_f, const PKGEntry& entry, std::string d
 
 		if (out)
 		{
-			dec_pkg_f.seek(entry.file_offset);
-
-			for (u64 size = 0; size < entry.file_size;)
+			// decrypted data is written directly to the destination
+			for (u64 pos = 0; pos < entry.file_size;)
 			{
-				size += dec_pkg_f.read(buf, BUF_SIZE);
+				const u64 size = std::min<u64>(buf.size(), entry.file_size - pos);
+				const u64 read = ReadDecrypted(pkg_f, header, entry.file_offset + pos, buf.data(), size);
 
-				if (size > entry.file_size)
+				if (read != size)
 				{
-					out.write(buf, BUF_SIZE - (size - entry.file_size));
-				}
-				else
-				{
-					out.write(buf, BUF_SIZE);
+					LOG_ERROR(LOADER, "PKG Loader: Unexpected end of package while extracting '%s'", path);
+					return false;
 				}
+
+				out.write(buf.data(), read);
+				pos += read;
 			}
 
 			return true;
@@ -225,7 +171,7 @@ bool UnpackEntry(const fs::file& dec_pkg_f, const PKGEntry& entry, std::string d
 
 	case PKG_FILE_ENTRY_FOLDER:
 	{
-		const std::string path = dir + std::string(buf, entry.name_size);
+		const std::string path = dir + name;
 
 		if (!fs::is_dir(path) && !fs::create_dir(path))
 		{
@@ -246,42 +192,32 @@ bool UnpackEntry(const fs::file& dec_pkg_f, const PKGEntry& entry, std::string d
 
 int Unpack(const fs::file& pkg_f, std::string src, std::string dst)
 {
-	PKGHeader* m_header = (PKGHeader*) malloc (sizeof(PKGHeader));
+	PKGHeader header;
 
-	// TODO: This shouldn't use current dir
-	std::string decryptedFile = "./dev_hdd1/" + src + ".dec";
-
-	fs::file dec_pkg_f(decryptedFile, o_read | o_write | o_create | o_trunc);
-	
-	if (Decrypt(pkg_f, dec_pkg_f, m_header) < 0)
+	if (!LoadHeader(pkg_f, &header))
 	{
 		return -1;
 	}
 
-	dec_pkg_f.seek(0);
-
 	std::vector<PKGEntry> m_entries;
-	m_entries.resize(m_header->file_count);
-
-	auto m_entries_ptr = m_entries.data();
+	m_entries.resize(header.file_count);
 
-	if (!LoadEntries(dec_pkg_f, m_header, m_entries_ptr))
+	if (!LoadEntries(pkg_f, header, m_entries.data()))
 	{
 		return -1;
 	}
 
 	wxProgressDialog pdlg("PKG Decrypter / Installer", "Please wait, unpacking...", m_entries.size(), 0, wxPD_AUTO_HIDE | wxPD_APP_MODAL);
 
+	std::vector<u8> buf(BUF_SIZE * 1024);
+
 	for (const auto& entry : m_entries)
 	{
-		UnpackEntry(dec_pkg_f, entry, dst + src + "/");
+		UnpackEntry(pkg_f, header, entry, dst + src + "/", buf);
 		pdlg.Update(pdlg.GetValue() + 1);
 	}
 
 	pdlg.Update(m_entries.size());
 
-	dec_pkg_f.close();
-	fs::remove_file(decryptedFile);
-
 	return 0;
 }
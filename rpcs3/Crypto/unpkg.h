@@ -58,4 +58,7 @@ struct PKGEntry
 
 namespace fs { struct file; }
 
-int Unpack(const fs::file& dec_pkg_f, std::string src, std::string dst);
+// Decrypt data located at the specified offset of the encrypted area (counter mode, so any range is independent)
+void DecryptRange(const PKGHeader& header, u64 offset, u8* data, u64 size);
+
+int Unpack(const fs::file& pkg_f, std::string src, std::string dst);
@@ -0,0 +1,64 @@
+#include "stdafx.h"
+#include "aes.h"
+#include "sha1.h"
+#include "key_vault.h"
+#include "unpkg.h"
+
+// Debug packages use a SHA-1 keystream of the QA digest, retail ones AES-CTR with klicensee as the initial counter
+void DecryptRange(const PKGHeader& header, u64 offset, u8* data, u64 size)
+{
+	u64 block = offset / HASH_LEN;
+	u64 skip = offset % HASH_LEN;
+
+	u8 ctr[HASH_LEN];
+
+	if (header.pkg_type == PKG_RELEASE_TYPE_DEBUG)
+	{
+		// Debug key
+		u8 key[0x40];
+		memset(key, 0, 0x40);
+		memcpy(key + 0x00, &header.qa_digest[0], 8);
+		memcpy(key + 0x08, &header.qa_digest[0], 8);
+		memcpy(key + 0x10, &header.qa_digest[8], 8);
+		memcpy(key + 0x18, &header.qa_digest[8], 8);
+
+		for (u64 done = 0; done < size; block++, skip = 0)
+		{
+			*(be_t<u64>*)&key[0x38] = block;
+
+			u8 hash[0x14];
+			sha1(key, 0x40, hash);
+
+			for (; skip < HASH_LEN && done < size; skip++, done++)
+			{
+				data[done] ^= hash[skip];
+			}
+		}
+	}
+	else
+	{
+		aes_context c;
+		aes_setkey_enc(&c, PKG_AES_KEY, 128);
+
+		// iv = klicensee + block (128-bit big-endian addition)
+		u8 iv[HASH_LEN];
+		const u64 lo = *(be_t<u64>*)&header.klicensee[8];
+		*(be_t<u64>*)&iv[0] = *(be_t<u64>*)&header.klicensee[0] + (lo + block < lo);
+		*(be_t<u64>*)&iv[8] = lo + block;
+
+		for (u64 done = 0; done < size; skip = 0)
+		{
+			aes_crypt_ecb(&c, AES_ENCRYPT, iv, ctr);
+
+			for (; skip < HASH_LEN && done < size; skip++, done++)
+			{
+				data[done] ^= ctr[skip];
+			}
+
+			if (!++*(be_t<u64>*)&iv[8])
+			{
+				*(be_t<u64>*)&iv[0] += 1;
+			}
+		}
+	}
+}
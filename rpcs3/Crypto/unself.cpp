@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "Utilities/Log.h"
 #include "Utilities/File.h"
+#include "Utilities/Thread.h"
 #include "aes.h"
 #include "sha1.h"
 #include "utils.h"
@@ -1008,7 +1009,8 @@ bool SELFDecrypter::LoadMetadata()
 
 bool SELFDecrypter::DecryptData()
 {
-	aes_context aes;
+	// Offsets of the encrypted sections in the data buffer.
+	std::vector<u32> data_offsets(meta_hdr.section_count, -1);
 
 	// Calculate the total data size.
 	for (unsigned int i = 0; i < meta_hdr.section_count; i++)
@@ -1016,59 +1018,48 @@ bool SELFDecrypter::DecryptData()
 		if (meta_shdr[i].encrypted == 3)
 		{
 			if ((meta_shdr[i].key_idx <= meta_hdr.key_count - 1) && (meta_shdr[i].iv_idx <= meta_hdr.key_count))
+			{
+				data_offsets[i] = data_buf_length;
 				data_buf_length += meta_shdr[i].data_size;
+			}
 		}
 	}
 
 	// Allocate a buffer to store decrypted data.
 	data_buf = (u8*)malloc(data_buf_length);
 
-	// Set initial offset.
-	u32 data_buf_offset = 0;
-
-	// Parse the metadata section headers to find the offsets of encrypted data.
+	// Read the encrypted data sequentially.
 	for (unsigned int i = 0; i < meta_hdr.section_count; i++)
 	{
-		size_t ctr_nc_off = 0;
-		u8 ctr_stream_block[0x10];
-		u8 data_key[0x10];
-		u8 data_iv[0x10];
-
-		// Check if this is an encrypted section.
-		if (meta_shdr[i].encrypted == 3)
+		if (data_offsets[i] != -1)
 		{
-			// Make sure the key and iv are not out of boundaries.
-			if((meta_shdr[i].key_idx <= meta_hdr.key_count - 1) && (meta_shdr[i].iv_idx <= meta_hdr.key_count))
-			{
-				// Get the key and iv from the previously stored key buffer.
-				memcpy(data_key, data_keys + meta_shdr[i].key_idx * 0x10, 0x10);
-				memcpy(data_iv, data_keys + meta_shdr[i].iv_idx * 0x10, 0x10);
-
-				// Allocate a buffer to hold the data.
-				u8 *buf = (u8 *)malloc(meta_shdr[i].data_size);
-
-				// Seek to the section data offset and read the encrypted data.
-				self_f.Seek(meta_shdr[i].data_offset);
-				self_f.Read(buf, meta_shdr[i].data_size);
-
-				// Zero out our ctr nonce.
-				memset(ctr_stream_block, 0, sizeof(ctr_stream_block));
+			self_f.Seek(meta_shdr[i].data_offset);
+			self_f.Read(data_buf + data_offsets[i], meta_shdr[i].data_size);
+		}
+	}
 
-				// Perform AES-CTR encryption on the data blocks.
-				aes_setkey_enc(&aes, data_key, 128);
-				aes_crypt_ctr(&aes, meta_shdr[i].data_size, &ctr_nc_off, data_iv, ctr_stream_block, buf, buf);
+	// Decrypt the sections in parallel.
+	parallel_for(meta_hdr.section_count, [&](u32 i)
+	{
+		if (data_offsets[i] == -1)
+		{
+			return;
+		}
 
-				// Copy the decrypted data.
-				memcpy(data_buf + data_buf_offset, buf, meta_shdr[i].data_size);
+		aes_context aes;
+		size_t ctr_nc_off = 0;
+		u8 ctr_stream_block[0x10] = {};
+		u8 data_key[0x10];
+		u8 data_iv[0x10];
 
-				// Advance the buffer's offset.
-				data_buf_offset += meta_shdr[i].data_size;
+		// Get the key and iv from the previously stored key buffer.
+		memcpy(data_key, data_keys + meta_shdr[i].key_idx * 0x10, 0x10);
+		memcpy(data_iv, data_keys + meta_shdr[i].iv_idx * 0x10, 0x10);
 
-				// Release the temporary buffer.
-				free(buf);
-			}
-		}
-	}
+		// Perform AES-CTR encryption on the data blocks.
+		aes_setkey_enc(&aes, data_key, 128);
+		aes_crypt_ctr(&aes, meta_shdr[i].data_size, &ctr_nc_off, data_iv, ctr_stream_block, data_buf + data_offsets[i], data_buf + data_offsets[i]);
+	});
 
 	return true;
 }
@@ -1127,46 +1118,61 @@ bool SELFDecrypter::MakeElf(const std::string& elf, bool isElf32)
 		for(u32 i = 0; i < elf64_hdr.e_phnum; ++i)
 			WritePhdr(e, phdr64_arr[i]);
 
-		// Write data.
+		// Find the data of the PHDR type sections.
+		std::vector<u32> data_offsets(meta_hdr.section_count, -1);
+
 		for (unsigned int i = 0; i < meta_hdr.section_count; i++)
 		{
-			// PHDR type.
 			if (meta_shdr[i].type == 2)
 			{
-				// Decompress if necessary.
-				if (meta_shdr[i].compressed == 2)
-				{
-					// Allocate a buffer for decompression.
-					u8 *decomp_buf = (u8 *)malloc(phdr64_arr[meta_shdr[i].program_idx].p_filesz);
+				data_offsets[i] = data_buf_offset;
+				data_buf_offset += meta_shdr[i].data_size;
+			}
+		}
 
-					// Set up memory streams for input/output.
-					wxMemoryInputStream decomp_stream_in(data_buf + data_buf_offset, meta_shdr[i].data_size);
-					wxMemoryOutputStream decomp_stream_out;
+		// Decompress the sections in parallel.
+		std::vector<std::unique_ptr<u8[]>> decomp_bufs(meta_hdr.section_count);
 
-					// Create a Zlib stream, read the data and flush the stream.
-					wxZlibInputStream* z_stream = new wxZlibInputStream(decomp_stream_in);
-					z_stream->Read(decomp_stream_out);
-					delete z_stream;
+		parallel_for(meta_hdr.section_count, [&](u32 i)
+		{
+			if (data_offsets[i] == -1 || meta_shdr[i].compressed != 2)
+			{
+				return;
+			}
 
-					// Copy the decompressed result from the stream.
-					decomp_stream_out.CopyTo(decomp_buf, phdr64_arr[meta_shdr[i].program_idx].p_filesz);
+			// Allocate a buffer for decompression.
+			decomp_bufs[i].reset(new u8[phdr64_arr[meta_shdr[i].program_idx].p_filesz]);
 
+			// Set up memory streams for input/output.
+			wxMemoryInputStream decomp_stream_in(data_buf + data_offsets[i], meta_shdr[i].data_size);
+			wxMemoryOutputStream decomp_stream_out;
+
+			// Create a Zlib stream, read the data and flush the stream.
+			wxZlibInputStream z_stream(decomp_stream_in);
+			z_stream.Read(decomp_stream_out);
+
+			// Copy the decompressed result from the stream.
+			decomp_stream_out.CopyTo(decomp_bufs[i].get(), phdr64_arr[meta_shdr[i].program_idx].p_filesz);
+		});
+
+		// Write data.
+		for (unsigned int i = 0; i < meta_hdr.section_count; i++)
+		{
+			// PHDR type.
+			if (meta_shdr[i].type == 2)
+			{
+				if (decomp_bufs[i])
+				{
 					// Seek to the program header data offset and write the data.
 					e.seek(phdr64_arr[meta_shdr[i].program_idx].p_offset);
-					e.write(decomp_buf, phdr64_arr[meta_shdr[i].program_idx].p_filesz);
-
-					// Release the decompression buffer.
-					free(decomp_buf);
+					e.write(decomp_bufs[i].get(), phdr64_arr[meta_shdr[i].program_idx].p_filesz);
 				}
 				else
 				{
 					// Seek to the program header data offset and write the data.
 					e.seek(phdr64_arr[meta_shdr[i].program_idx].p_offset);
-					e.write(data_buf + data_buf_offset, meta_shdr[i].data_size);
+					e.write(data_buf + data_offsets[i], meta_shdr[i].data_size);
 				}
-
-				// Advance the data buffer offset by data size.
-				data_buf_offset += meta_shdr[i].data_size;
 			}
 		}
 
@@ -1232,6 +1238,41 @@ bool IsSelf(const std::string& path)
 	return hdr.CheckMagic();
 }
 
+bool GetSelfDigest(const std::string& path, std::string& digest)
+{
+	vfsLocalFile f(nullptr);
+
+	if (!f.Open(path))
+		return false;
+
+	SceHeader hdr;
+	hdr.Load(f);
+
+	if (!hdr.CheckMagic() || hdr.se_hsize > 0x100000)
+		return false;
+
+	// The header contains the encrypted metadata (keys and section hashes), so it identifies the content.
+	std::vector<u8> header(hdr.se_hsize);
+	f.Seek(0);
+
+	if (f.Read(header.data(), header.size()) != header.size())
+		return false;
+
+	u8 hash[20];
+	sha1(header.data(), header.size(), hash);
+
+	digest.clear();
+
+	for (u8 v : hash)
+	{
+		digest += fmt::format("%02x", v);
+	}
+
+	digest += fmt::format("-%llx", f.GetSize());
+
+	return true;
+}
+
 bool IsSelfElf32(const std::string& path)
 {
 	vfsLocalFile f(nullptr);
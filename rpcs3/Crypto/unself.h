@@ -391,5 +391,6 @@ public:
 
 extern bool IsSelf(const std::string& path);
 extern bool IsSelfElf32(const std::string& path);
+extern bool GetSelfDigest(const std::string& path, std::string& digest);
 extern bool CheckDebugSelf(const std::string& self, const std::string& elf);
 extern bool DecryptSelf(const std::string& elf, const std::string& self);
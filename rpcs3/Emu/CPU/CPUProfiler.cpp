@@ -0,0 +1,256 @@
+#include "stdafx.h"
+#include "Utilities/Log.h"
+#include "Utilities/File.h"
+#include "Emu/Memory/Memory.h"
+#include "Emu/System.h"
+#include "Emu/CPU/CPUThreadManager.h"
+#include "Emu/Cell/PPUThread.h"
+#include "Emu/SysCalls/Modules.h"
+#include "Emu/SysCalls/SysCalls.h"
+#include "CPUProfiler.h"
+
+// sampling interval
+const auto g_cpu_profiler_period = std::chrono::milliseconds(1);
+
+struct cpu_sample_t
+{
+	u32 type;
+	u32 id;
+	u32 pc;
+	u64 hle_code;
+
+	bool operator ==(const cpu_sample_t& right) const
+	{
+		return type == right.type && id == right.id && pc == right.pc && hle_code == right.hle_code;
+	}
+};
+
+struct cpu_sample_hash_t
+{
+	std::size_t operator ()(const cpu_sample_t& sample) const
+	{
+		return std::hash<u64>()((u64)sample.type << 56 ^ (u64)sample.id << 32 ^ sample.pc ^ sample.hle_code * 0x9e3779b97f4a7c15ull);
+	}
+};
+
+struct cpu_profiler_t
+{
+	std::atomic<bool> stop{ false };
+	thread_t thread;
+
+	// written only by the sampling thread
+	std::unordered_map<cpu_sample_t, u64, cpu_sample_hash_t> samples;
+	std::map<std::pair<u32, u32>, std::string> names; // (type, id) -> thread name
+	u64 count = 0;
+
+	~cpu_profiler_t()
+	{
+		stop = true;
+
+		if (thread.joinable())
+		{
+			thread.join();
+		}
+	}
+};
+
+std::unique_ptr<cpu_profiler_t> g_cpu_profiler;
+
+struct cpu_symbol_t
+{
+	u32 size; // 0 if unknown
+	u64 id;
+};
+
+// known guest functions and code segments, filled by the loader
+std::mutex g_cpu_symbols_mutex;
+std::map<u32, cpu_symbol_t> g_cpu_functions;
+std::map<u32, u32> g_cpu_segments;
+
+void cpu_profiler_add_function(u32 addr, u32 size, u64 id)
+{
+	std::lock_guard<std::mutex> lock(g_cpu_symbols_mutex);
+
+	g_cpu_functions[addr] = { size, id };
+}
+
+void cpu_profiler_add_segment(u32 addr, u32 size)
+{
+	std::lock_guard<std::mutex> lock(g_cpu_symbols_mutex);
+
+	g_cpu_segments[addr] = size;
+}
+
+void cpu_profiler_start()
+{
+	if (g_cpu_profiler)
+	{
+		return;
+	}
+
+	g_cpu_profiler.reset(new cpu_profiler_t);
+
+	auto& profiler = *g_cpu_profiler;
+
+	profiler.thread.start([]{ return std::string("CPU Profiler"); }, [&profiler]()
+	{
+		while (!profiler.stop)
+		{
+			// threads don't run while the emulation is paused
+			if (Emu.IsPaused())
+			{
+				std::this_thread::sleep_for(g_cpu_profiler_period);
+				continue;
+			}
+
+			for (auto& t : CPUThreadManager::GetAllThreads())
+			{
+				if (!t->is_alive() || t->is_stopped())
+				{
+					continue;
+				}
+
+				const u32 type = t->get_type();
+				const u32 id = t->get_id();
+
+				const auto name = profiler.names.emplace(std::make_pair(type, id), std::string());
+
+				if (name.second)
+				{
+					name.first->second = t->GetFName();
+				}
+
+				const u64 hle_code = type == CPU_THREAD_PPU ? static_cast<PPUThread&>(*t).hle_code : 0;
+
+				profiler.samples[{ type, id, t->get_pc(), hle_code }]++;
+				profiler.count++;
+			}
+
+			std::this_thread::sleep_for(g_cpu_profiler_period);
+		}
+	});
+
+	LOG_NOTICE(GENERAL, "CPU profiler started");
+}
+
+void cpu_profiler_stop(const std::string& path)
+{
+	std::map<u32, cpu_symbol_t> functions;
+	std::map<u32, u32> segments;
+
+	{
+		std::lock_guard<std::mutex> lock(g_cpu_symbols_mutex);
+
+		functions = std::move(g_cpu_functions);
+		segments = std::move(g_cpu_segments);
+		g_cpu_functions.clear();
+		g_cpu_segments.clear();
+	}
+
+	if (!g_cpu_profiler)
+	{
+		return;
+	}
+
+	g_cpu_profiler->stop = true;
+	g_cpu_profiler->thread.join();
+
+	const std::unique_ptr<cpu_profiler_t> profiler(std::move(g_cpu_profiler));
+
+	// find the function containing the address (returns nullptr if outside of any known function extent)
+	auto find_function = [&](u32 addr) -> const cpu_symbol_t*
+	{
+		auto found = functions.upper_bound(addr);
+
+		if (found == functions.begin())
+		{
+			return nullptr;
+		}
+
+		const auto next = found--;
+
+		if (found->second.size)
+		{
+			return addr - found->first < found->second.size ? &found->second : nullptr;
+		}
+
+		// unknown size: up to the next known function or the end of the segment
+		if (next != functions.end() && addr >= next->first)
+		{
+			return nullptr;
+		}
+
+		auto segment = segments.upper_bound(found->first);
+
+		if (segment == segments.begin() || (--segment, addr - segment->first >= segment->second))
+		{
+			return nullptr;
+		}
+
+		return &found->second;
+	};
+
+	std::unordered_map<u64, std::string> func_names;
+
+	auto get_func_name = [&](u64 id) -> const std::string&
+	{
+		auto found = func_names.find(id);
+
+		if (found == func_names.end())
+		{
+			found = func_names.emplace(id, SysCalls::GetFuncName(id)).first;
+		}
+
+		return found->second;
+	};
+
+	// aggregate samples by collapsed stack
+	std::map<std::string, u64> stacks;
+
+	for (auto& sample : profiler->samples)
+	{
+		std::string stack = profiler->names[std::make_pair(sample.first.type, sample.first.id)] + ";";
+
+		if (sample.first.hle_code)
+		{
+			// executing HLE function or syscall
+			stack += get_func_name(sample.first.hle_code);
+		}
+		else if (sample.first.type == CPU_THREAD_PPU)
+		{
+			if (const auto func = find_function(sample.first.pc))
+			{
+				stack += get_func_name(func->id);
+			}
+			else
+			{
+				stack += fmt::format("0x%08x", sample.first.pc);
+			}
+		}
+		else
+		{
+			stack += fmt::format("0x%05x", sample.first.pc);
+		}
+
+		stacks[stack] += sample.second;
+	}
+
+	std::string text;
+
+	for (auto& stack : stacks)
+	{
+		text += fmt::format("%s %llu\n", stack.first, stack.second);
+	}
+
+	fs::file file(path, o_write | o_create | o_trunc);
+
+	if (!file)
+	{
+		LOG_ERROR(GENERAL, "Failed to create CPU profile (%s)", path);
+		return;
+	}
+
+	file.write(text.data(), text.size());
+
+	LOG_NOTICE(GENERAL, "CPU profile written (%s, %llu samples)", path, profiler->count);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+// Sampling profiler for guest code (enabled by Ini.CPUProfiler)
+// PC and current HLE function of every CPU thread are sampled periodically.
+// The result is written in the collapsed stack format ("thread;function count" lines) used by flamegraph.pl.
+
+// register a loaded guest function to name PPU samples (export tables and import stubs, filled by the loader)
+// size 0 means that the size is unknown: the function extends to the next known function within its segment
+void cpu_profiler_add_function(u32 addr, u32 size, u64 id);
+
+// register a loaded code segment (bounds functions of unknown size)
+void cpu_profiler_add_segment(u32 addr, u32 size);
+
+// start the sampling thread
+void cpu_profiler_start();
+
+// stop the sampling thread and write the result (must be called before guest memory is released), clears registered functions
+void cpu_profiler_stop(const std::string& path);
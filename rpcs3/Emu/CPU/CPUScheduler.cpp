@@ -0,0 +1,199 @@
+#include "stdafx.h"
+#include "Utilities/Log.h"
+#include "Emu/Memory/Memory.h"
+#include "Emu/System.h"
+#include "Emu/Cell/PPUThread.h"
+#include "Emu/Cell/SPUThread.h"
+#include "CPUScheduler.h"
+
+extern u64 get_system_time();
+
+template<typename T> typename std::vector<typename cpu_scheduler_t<T>::waiter_t*>::iterator cpu_scheduler_t<T>::get_best_waiter(u64 time)
+{
+	return std::min_element(m_waiters.begin(), m_waiters.end(), [time](waiter_t* a, waiter_t* b)
+	{
+		const bool a_starved = time - a->since >= g_cpu_sched_starve;
+		const bool b_starved = time - b->since >= g_cpu_sched_starve;
+
+		if (a_starved != b_starved)
+		{
+			return a_starved;
+		}
+
+		// starved waiters are served in FIFO order
+		return (!a_starved && a->prio < b->prio) || ((a_starved || a->prio == b->prio) && a->order < b->order);
+	});
+}
+
+template<typename T> void cpu_scheduler_t<T>::grant(u64 time)
+{
+	const auto best = get_best_waiter(time);
+	const auto waiter = *best;
+
+	m_waiters.erase(best);
+	m_running.emplace(waiter->thread, owner_t{ waiter->prio, time, time - waiter->since >= g_cpu_sched_starve });
+
+	waiter->granted = true;
+	waiter->thread->cv.notify_one();
+}
+
+template<typename T> void cpu_scheduler_t<T>::request_yield(const waiter_t& waiter, u64 time)
+{
+	const bool starved = time - waiter.since >= g_cpu_sched_starve;
+
+	for (auto& owner : m_running)
+	{
+		const bool expired = time - owner.second.time >= g_cpu_sched_slice;
+
+		// a starved thread gets at least one time slice
+		if (owner.second.starved && !expired)
+		{
+			continue;
+		}
+
+		if (owner.second.prio > waiter.prio || (expired && (owner.second.prio == waiter.prio || starved)))
+		{
+			owner.first->request_yield();
+		}
+	}
+}
+
+template<typename T> void cpu_scheduler_t<T>::init(u32 slots)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_free = slots;
+	m_running.clear();
+	m_waiters.clear();
+
+	m_slots = slots;
+}
+
+template<typename T> bool cpu_scheduler_t<T>::reserve(u32 slots)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const u32 old_slots = m_slots.load();
+
+	if (!old_slots || slots <= old_slots)
+	{
+		return false;
+	}
+
+	m_free += slots - old_slots;
+	m_slots = slots;
+
+	const u64 time = get_system_time();
+
+	while (m_free && m_waiters.size())
+	{
+		m_free--;
+		grant(time);
+	}
+
+	return true;
+}
+
+template<typename T> bool cpu_scheduler_t<T>::acquire(T& thread)
+{
+	if (!m_slots.load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+
+	const s32 prio = m_get_prio(thread);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (m_running.count(&thread))
+	{
+		return false;
+	}
+
+	if (m_free)
+	{
+		m_free--;
+		m_running.emplace(&thread, owner_t{ prio, get_system_time(), false });
+
+		return true;
+	}
+
+	waiter_t waiter{ &thread, prio, m_order++, get_system_time(), false };
+
+	m_waiters.emplace_back(&waiter);
+
+	while (!waiter.granted)
+	{
+		if (Emu.IsStopped() || thread.is_stopped())
+		{
+			m_waiters.erase(std::find(m_waiters.begin(), m_waiters.end(), &waiter));
+
+			return false;
+		}
+
+		request_yield(waiter, get_system_time());
+
+		// the slot is granted by release() with the mutex locked
+		thread.cv.wait_for(lock, std::chrono::microseconds(g_cpu_sched_slice));
+	}
+
+	return true;
+}
+
+template<typename T> bool cpu_scheduler_t<T>::release(T& thread)
+{
+	if (!m_slots.load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (!m_running.erase(&thread))
+	{
+		return false;
+	}
+
+	if (m_waiters.empty())
+	{
+		m_free++;
+
+		return true;
+	}
+
+	// pass the slot to the best waiting thread
+	grant(get_system_time());
+
+	return true;
+}
+
+template<typename T> void cpu_scheduler_t<T>::yield(T& thread)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		const auto found = m_running.find(&thread);
+
+		if (m_waiters.empty() || found == m_running.end())
+		{
+			return;
+		}
+
+		const u64 time = get_system_time();
+		const auto best = *get_best_waiter(time);
+
+		// don't yield to threads of worse priority unless they are starved
+		if (best->prio > found->second.prio && time - best->since < g_cpu_sched_starve)
+		{
+			return;
+		}
+	}
+
+	if (release(thread))
+	{
+		acquire(thread);
+	}
+}
+
+template class cpu_scheduler_t<PPUThread>;
+template class cpu_scheduler_t<SPUThread>;
@@ -0,0 +1,90 @@
+#pragma once
+
+// Run-slot scheduler (shared by the PPU and SPU schedulers)
+// Limits the number of threads executing guest code at once to the specified count of run slots.
+// Free slots are given to the waiting thread with the best priority (lowest value returned by the priority callback), FIFO among equal priorities.
+// Running threads of worse priority (or of equal priority after their time slice) are asked to yield (T::request_yield()).
+//
+// Starvation: a thread which busy-waits (polls memory) for a thread of worse priority never blocks, so it would keep its slot forever.
+// Waiters which didn't get a slot within g_cpu_sched_starve are therefore served first, regardless of priority, and their owners
+// may only be preempted after their first time slice.
+
+// time slice for threads of equal priority (microseconds)
+const u64 g_cpu_sched_slice = 10000;
+
+// waiting time after which a thread is served regardless of priority (microseconds)
+const u64 g_cpu_sched_starve = 100000;
+
+template<typename T> class cpu_scheduler_t final
+{
+public:
+	// get priority of the thread (lower value is better), called without the scheduler mutex locked
+	using get_prio_t = s32(*)(T& thread);
+
+private:
+	struct waiter_t
+	{
+		T* thread;
+		s32 prio;
+		u64 order;
+		u64 since; // time when the thread started waiting
+		bool granted;
+	};
+
+	struct owner_t
+	{
+		s32 prio;
+		u64 time; // time when the slot was taken
+		bool starved; // the slot was granted to a starved waiter
+	};
+
+	const get_prio_t m_get_prio;
+
+	std::mutex m_mutex;
+
+	std::atomic<u32> m_slots{ 0 }; // total run slots (0 = disabled)
+
+	u32 m_free = 0; // free run slots
+
+	u64 m_order = 0; // waiter counter (FIFO order among equal priorities)
+
+	std::unordered_map<T*, owner_t> m_running;
+
+	std::vector<waiter_t*> m_waiters;
+
+	// get the waiter with the best priority (starved waiters first)
+	typename std::vector<waiter_t*>::iterator get_best_waiter(u64 time);
+
+	// pass a free slot to the best waiting thread (mutex must be locked)
+	void grant(u64 time);
+
+	// ask slot owners to yield for the specified waiter (mutex must be locked)
+	void request_yield(const waiter_t& waiter, u64 time);
+
+public:
+	cpu_scheduler_t(get_prio_t get_prio)
+		: m_get_prio(get_prio)
+	{
+	}
+
+	// set the number of run slots and reset the state (called before threads are started)
+	void init(u32 slots);
+
+	// raise the number of run slots to the specified count, returns false if not changed or the scheduler is disabled
+	bool reserve(u32 slots);
+
+	// get the number of run slots (0 = disabled)
+	u32 get_slots() const
+	{
+		return m_slots.load(std::memory_order_relaxed);
+	}
+
+	// take a run slot (waits if none available), returns false if already owned, the scheduler is disabled or the thread is stopped
+	bool acquire(T& thread);
+
+	// give the run slot to the best waiting thread, returns false if not owned
+	bool release(T& thread);
+
+	// give the run slot away if a thread of better or equal priority (or a starved thread) is waiting
+	void yield(T& thread);
+};
@@ -26,8 +26,9 @@ enum : u64
 	CPU_STATE_RETURN  = (1ull << 5), // used for callback return
 	CPU_STATE_SIGNAL  = (1ull << 6), // used for HLE signaling
 	CPU_STATE_INTR    = (1ull << 7), // thread interrupted
+	CPU_STATE_YIELD   = (1ull << 8), // the thread is asked to give up its run slot (PPU and SPU schedulers)
 
-	CPU_STATE_MAX     = (1ull << 8), // added to (subtracted from) m_state by Sleep()/Awake() calls to trigger status check
+	CPU_STATE_MAX     = (1ull << 9), // added to (subtracted from) m_state by Sleep()/Awake() calls to trigger status check
 };
 
 // "HLE return" exception event
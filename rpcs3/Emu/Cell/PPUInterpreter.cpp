@@ -1793,7 +1793,7 @@ void ppu_interpreter::LDX(PPUThread& CPU, ppu_opcode_t op)
 void ppu_interpreter::LWZX(PPUThread& CPU, ppu_opcode_t op)
 {
 	const u64 addr = op.ra ? CPU.GPR[op.ra] + CPU.GPR[op.rb] : CPU.GPR[op.rb];
-	CPU.GPR[op.rd] = vm::read32(VM_CAST(addr));
+	CPU.GPR[op.rd] = ppu_read32(VM_CAST(addr));
 }
 
 void ppu_interpreter::SLW(PPUThread& CPU, ppu_opcode_t op)
@@ -1898,7 +1898,7 @@ void ppu_interpreter::DCBST(PPUThread& CPU, ppu_opcode_t op)
 void ppu_interpreter::LWZUX(PPUThread& CPU, ppu_opcode_t op)
 {
 	const u64 addr = CPU.GPR[op.ra] + CPU.GPR[op.rb];
-	CPU.GPR[op.rd] = vm::read32(VM_CAST(addr));
+	CPU.GPR[op.rd] = ppu_read32(VM_CAST(addr));
 	CPU.GPR[op.ra] = addr;
 }
 
@@ -2086,7 +2086,7 @@ void ppu_interpreter::STWCX_(PPUThread& CPU, ppu_opcode_t op)
 void ppu_interpreter::STWX(PPUThread& CPU, ppu_opcode_t op)
 {
 	const u64 addr = op.ra ? CPU.GPR[op.ra] + CPU.GPR[op.rb] : CPU.GPR[op.rb];
-	vm::write32(VM_CAST(addr), (u32)CPU.GPR[op.rs]);
+	ppu_write32(VM_CAST(addr), (u32)CPU.GPR[op.rs]);
 }
 
 void ppu_interpreter::STVEHX(PPUThread& CPU, ppu_opcode_t op)
@@ -2106,7 +2106,7 @@ void ppu_interpreter::STDUX(PPUThread& CPU, ppu_opcode_t op)
 void ppu_interpreter::STWUX(PPUThread& CPU, ppu_opcode_t op)
 {
 	const u64 addr = CPU.GPR[op.ra] + CPU.GPR[op.rb];
-	vm::write32(VM_CAST(addr), (u32)CPU.GPR[op.rs]);
+	ppu_write32(VM_CAST(addr), (u32)CPU.GPR[op.rs]);
 	CPU.GPR[op.ra] = addr;
 }
 
@@ -2279,7 +2279,7 @@ void ppu_interpreter::MFSPR(PPUThread& CPU, ppu_opcode_t op)
 void ppu_interpreter::LWAX(PPUThread& CPU, ppu_opcode_t op)
 {
 	const u64 addr = op.ra ? CPU.GPR[op.ra] + CPU.GPR[op.rb] : CPU.GPR[op.rb];
-	CPU.GPR[op.rd] = (s64)(s32)vm::read32(VM_CAST(addr));
+	CPU.GPR[op.rd] = (s64)(s32)ppu_read32(VM_CAST(addr));
 }
 
 void ppu_interpreter::DST(PPUThread& CPU, ppu_opcode_t op)
@@ -2314,7 +2314,7 @@ void ppu_interpreter::MFTB(PPUThread& CPU, ppu_opcode_t op)
 void ppu_interpreter::LWAUX(PPUThread& CPU, ppu_opcode_t op)
 {
 	const u64 addr = op.ra ? CPU.GPR[op.ra] + CPU.GPR[op.rb] : CPU.GPR[op.rb];
-	CPU.GPR[op.rd] = (s64)(s32)vm::read32(VM_CAST(addr));
+	CPU.GPR[op.rd] = (s64)(s32)ppu_read32(VM_CAST(addr));
 	CPU.GPR[op.ra] = addr;
 }
 
@@ -2858,13 +2858,13 @@ void ppu_interpreter::DCBZ(PPUThread& CPU, ppu_opcode_t op)
 void ppu_interpreter::LWZ(PPUThread& CPU, ppu_opcode_t op)
 {
 	const u64 addr = op.ra ? CPU.GPR[op.ra] + op.simm16 : op.simm16;
-	CPU.GPR[op.rd] = vm::read32(VM_CAST(addr));
+	CPU.GPR[op.rd] = ppu_read32(VM_CAST(addr));
 }
 
 void ppu_interpreter::LWZU(PPUThread& CPU, ppu_opcode_t op)
 {
 	const u64 addr = CPU.GPR[op.ra] + op.simm16;
-	CPU.GPR[op.rd] = vm::read32(VM_CAST(addr));
+	CPU.GPR[op.rd] = ppu_read32(VM_CAST(addr));
 	CPU.GPR[op.ra] = addr;
 }
 
@@ -2884,13 +2884,13 @@ void ppu_interpreter::LBZU(PPUThread& CPU, ppu_opcode_t op)
 void ppu_interpreter::STW(PPUThread& CPU, ppu_opcode_t op)
 {
 	const u64 addr = op.ra ? CPU.GPR[op.ra] + op.simm16 : op.simm16;
-	vm::write32(VM_CAST(addr), (u32)CPU.GPR[op.rs]);
+	ppu_write32(VM_CAST(addr), (u32)CPU.GPR[op.rs]);
 }
 
 void ppu_interpreter::STWU(PPUThread& CPU, ppu_opcode_t op)
 {
 	const u64 addr = CPU.GPR[op.ra] + op.simm16;
-	vm::write32(VM_CAST(addr), (u32)CPU.GPR[op.rs]);
+	ppu_write32(VM_CAST(addr), (u32)CPU.GPR[op.rs]);
 	CPU.GPR[op.ra] = addr;
 }
 
@@ -3032,7 +3032,7 @@ void ppu_interpreter::LDU(PPUThread& CPU, ppu_opcode_t op)
 void ppu_interpreter::LWA(PPUThread& CPU, ppu_opcode_t op)
 {
 	const u64 addr = (op.simm16 & ~3) + (op.ra ? CPU.GPR[op.ra] : 0);
-	CPU.GPR[op.rd] = (s64)(s32)vm::read32(VM_CAST(addr));
+	CPU.GPR[op.rd] = (s64)(s32)ppu_read32(VM_CAST(addr));
 }
 
 void ppu_interpreter::FDIVS(PPUThread& CPU, ppu_opcode_t op)
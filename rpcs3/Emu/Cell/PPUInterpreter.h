@@ -5,6 +5,7 @@
 #include "rpcs3/Ini.h"
 #include "Emu/SysCalls/Modules.h"
 #include "Emu/Memory/Memory.h"
+#include "Emu/Cell/RawSPUThread.h"
 
 #include <stdint.h>
 #ifdef _MSC_VER
@@ -2492,7 +2493,7 @@ private:
 	void LWZX(u32 rd, u32 ra, u32 rb)
 	{
 		const u64 addr = ra ? CPU.GPR[ra] + CPU.GPR[rb] : CPU.GPR[rb];
-		CPU.GPR[rd] = vm::read32(VM_CAST(addr));
+		CPU.GPR[rd] = ppu_read32(VM_CAST(addr));
 	}
 	void SLW(u32 ra, u32 rs, u32 rb, u32 rc)
 	{
@@ -2587,7 +2588,7 @@ private:
 	void LWZUX(u32 rd, u32 ra, u32 rb)
 	{
 		const u64 addr = CPU.GPR[ra] + CPU.GPR[rb];
-		CPU.GPR[rd] = vm::read32(VM_CAST(addr));
+		CPU.GPR[rd] = ppu_read32(VM_CAST(addr));
 		CPU.GPR[ra] = addr;
 	}
 	void CNTLZD(u32 ra, u32 rs, u32 rc)
@@ -2758,7 +2759,7 @@ private:
 	void STWX(u32 rs, u32 ra, u32 rb)
 	{
 		const u64 addr = ra ? CPU.GPR[ra] + CPU.GPR[rb] : CPU.GPR[rb];
-		vm::write32(VM_CAST(addr), (u32)CPU.GPR[rs]);
+		ppu_write32(VM_CAST(addr), (u32)CPU.GPR[rs]);
 	}
 	void STVEHX(u32 vs, u32 ra, u32 rb)
 	{
@@ -2775,7 +2776,7 @@ private:
 	void STWUX(u32 rs, u32 ra, u32 rb)
 	{
 		const u64 addr = CPU.GPR[ra] + CPU.GPR[rb];
-		vm::write32(VM_CAST(addr), (u32)CPU.GPR[rs]);
+		ppu_write32(VM_CAST(addr), (u32)CPU.GPR[rs]);
 		CPU.GPR[ra] = addr;
 	}
 	void STVEWX(u32 vs, u32 ra, u32 rb)
@@ -2904,7 +2905,7 @@ private:
 	void LWAX(u32 rd, u32 ra, u32 rb)
 	{
 		const u64 addr = ra ? CPU.GPR[ra] + CPU.GPR[rb] : CPU.GPR[rb];
-		CPU.GPR[rd] = (s64)(s32)vm::read32(VM_CAST(addr));
+		CPU.GPR[rd] = (s64)(s32)ppu_read32(VM_CAST(addr));
 	}
 	void DST(u32 ra, u32 rb, u32 strm, u32 t)
 	{
@@ -2934,7 +2935,7 @@ private:
 	void LWAUX(u32 rd, u32 ra, u32 rb)
 	{
 		const u64 addr = ra ? CPU.GPR[ra] + CPU.GPR[rb] : CPU.GPR[rb];
-		CPU.GPR[rd] = (s64)(s32)vm::read32(VM_CAST(addr));
+		CPU.GPR[rd] = (s64)(s32)ppu_read32(VM_CAST(addr));
 		CPU.GPR[ra] = addr;
 	}
 	void DSTST(u32 ra, u32 rb, u32 strm, u32 t)
@@ -3444,12 +3445,12 @@ private:
 	void LWZ(u32 rd, u32 ra, s32 d)
 	{
 		const u64 addr = ra ? CPU.GPR[ra] + d : d;
-		CPU.GPR[rd] = vm::read32(VM_CAST(addr));
+		CPU.GPR[rd] = ppu_read32(VM_CAST(addr));
 	}
 	void LWZU(u32 rd, u32 ra, s32 d)
 	{
 		const u64 addr = CPU.GPR[ra] + d;
-		CPU.GPR[rd] = vm::read32(VM_CAST(addr));
+		CPU.GPR[rd] = ppu_read32(VM_CAST(addr));
 		CPU.GPR[ra] = addr;
 	}
 	void LBZ(u32 rd, u32 ra, s32 d)
@@ -3466,12 +3467,12 @@ private:
 	void STW(u32 rs, u32 ra, s32 d)
 	{
 		const u64 addr = ra ? CPU.GPR[ra] + d : d;
-		vm::write32(VM_CAST(addr), (u32)CPU.GPR[rs]);
+		ppu_write32(VM_CAST(addr), (u32)CPU.GPR[rs]);
 	}
 	void STWU(u32 rs, u32 ra, s32 d)
 	{
 		const u64 addr = CPU.GPR[ra] + d;
-		vm::write32(VM_CAST(addr), (u32)CPU.GPR[rs]);
+		ppu_write32(VM_CAST(addr), (u32)CPU.GPR[rs]);
 		CPU.GPR[ra] = addr;
 	}
 	void STB(u32 rs, u32 ra, s32 d)
@@ -3630,7 +3631,7 @@ private:
 	void LWA(u32 rd, u32 ra, s32 ds)
 	{
 		const u64 addr = ra ? CPU.GPR[ra] + ds : ds;
-		CPU.GPR[rd] = (s64)(s32)vm::read32(VM_CAST(addr));
+		CPU.GPR[rd] = (s64)(s32)ppu_read32(VM_CAST(addr));
 	}
 	void FDIVS(u32 frd, u32 fra, u32 frb, u32 rc) {FDIV(frd, fra, frb, rc, true);}
 	void FSUBS(u32 frd, u32 fra, u32 frb, u32 rc) {FSUB(frd, fra, frb, rc, true);}
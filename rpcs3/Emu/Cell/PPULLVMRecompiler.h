@@ -912,6 +912,9 @@ namespace ppu_recompiler_llvm {
 		/// Write to memory
 		void WriteMemory(llvm::Value * addr_i64, llvm::Value * val_ix, u32 alignment = 0, bool bswap = true, bool could_be_mmio = true);
 
+		/// Branch to the raw SPU MMIO block (insert point is set to it) or to the block following it, which falls through to merge_bb
+		void CreateMmioBlocks(llvm::Value * addr_i64, llvm::BasicBlock *& mmio_bb, llvm::BasicBlock *& merge_bb);
+
 		/// Convert a C++ type to an LLVM type
 		template<class T>
 		llvm::Type * CppToLlvmType() {
@@ -4,6 +4,7 @@
 #include "Emu/System.h"
 #include "Emu/Cell/PPULLVMRecompiler.h"
 #include "Emu/Memory/Memory.h"
+#include "Emu/Cell/RawSPUThread.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/ManagedStatic.h"
@@ -5261,6 +5262,24 @@ void Compiler::CreateBranch(llvm::Value * cmp_i1, llvm::Value * target_i32, bool
 
 Value * Compiler::ReadMemory(Value * addr_i64, u32 bits, u32 alignment, bool bswap, bool could_be_mmio) {
 	addr_i64 = m_ir_builder->CreateAnd(addr_i64, 0xFFFFFFFF);
+
+	BasicBlock * mmio_bb = nullptr;
+	BasicBlock * merge_bb = nullptr;
+	Value * mmio_val_i32 = nullptr;
+
+	if (bits == 32 && could_be_mmio) {
+		// Raw SPU MMIO registers are read by calling the handler directly instead of handling access violation
+		CreateMmioBlocks(addr_i64, mmio_bb, merge_bb);
+		mmio_val_i32 = Call<u32>("raw_spu_mmio_read32", raw_spu_mmio_read32, m_ir_builder->CreateTrunc(addr_i64, m_ir_builder->getInt32Ty()));
+		if (!bswap) {
+			mmio_val_i32 = m_ir_builder->CreateCall(Intrinsic::getDeclaration(m_module, Intrinsic::bswap, m_ir_builder->getInt32Ty()), mmio_val_i32);
+		}
+
+		mmio_bb = m_ir_builder->GetInsertBlock();
+		m_ir_builder->CreateBr(merge_bb);
+		m_ir_builder->SetInsertPoint(merge_bb->getPrevNode());
+	}
+
 	auto eaddr_i64 = m_ir_builder->CreateAdd(addr_i64, m_ir_builder->getInt64((u64)vm::get_ptr<u8>(0)));
 	auto eaddr_ix_ptr = m_ir_builder->CreateIntToPtr(eaddr_i64, m_ir_builder->getIntNTy(bits)->getPointerTo());
 	auto val_ix = (Value *)m_ir_builder->CreateLoad(eaddr_ix_ptr, alignment);
@@ -5268,18 +5287,63 @@ Value * Compiler::ReadMemory(Value * addr_i64, u32 bits, u32 alignment, bool bsw
 		val_ix = m_ir_builder->CreateCall(Intrinsic::getDeclaration(m_module, Intrinsic::bswap, m_ir_builder->getIntNTy(bits)), val_ix);
 	}
 
+	if (merge_bb) {
+		auto memory_bb = m_ir_builder->GetInsertBlock();
+		m_ir_builder->CreateBr(merge_bb);
+		m_ir_builder->SetInsertPoint(merge_bb);
+		auto phi_i32 = m_ir_builder->CreatePHI(m_ir_builder->getInt32Ty(), 2);
+		phi_i32->addIncoming(mmio_val_i32, mmio_bb);
+		phi_i32->addIncoming(val_ix, memory_bb);
+		val_ix = phi_i32;
+	}
+
 	return val_ix;
 }
 
 void Compiler::WriteMemory(Value * addr_i64, Value * val_ix, u32 alignment, bool bswap, bool could_be_mmio) {
+	addr_i64 = m_ir_builder->CreateAnd(addr_i64, 0xFFFFFFFF);
+
+	BasicBlock * merge_bb = nullptr;
+
+	if (val_ix->getType()->getIntegerBitWidth() == 32 && could_be_mmio) {
+		// Raw SPU MMIO registers are written by calling the handler directly instead of handling access violation
+		BasicBlock * mmio_bb;
+		CreateMmioBlocks(addr_i64, mmio_bb, merge_bb);
+		auto mmio_val_i32 = val_ix;
+		if (!bswap) {
+			mmio_val_i32 = m_ir_builder->CreateCall(Intrinsic::getDeclaration(m_module, Intrinsic::bswap, m_ir_builder->getInt32Ty()), mmio_val_i32);
+		}
+
+		Call<void>("raw_spu_mmio_write32", raw_spu_mmio_write32, m_ir_builder->CreateTrunc(addr_i64, m_ir_builder->getInt32Ty()), mmio_val_i32);
+		m_ir_builder->CreateBr(merge_bb);
+		m_ir_builder->SetInsertPoint(merge_bb->getPrevNode());
+	}
+
 	if (val_ix->getType()->getIntegerBitWidth() > 8 && bswap) {
 		val_ix = m_ir_builder->CreateCall(Intrinsic::getDeclaration(m_module, Intrinsic::bswap, val_ix->getType()), val_ix);
 	}
 
-	addr_i64 = m_ir_builder->CreateAnd(addr_i64, 0xFFFFFFFF);
 	auto eaddr_i64 = m_ir_builder->CreateAdd(addr_i64, m_ir_builder->getInt64((u64)vm::get_ptr<u8>(0)));
 	auto eaddr_ix_ptr = m_ir_builder->CreateIntToPtr(eaddr_i64, val_ix->getType()->getPointerTo());
 	m_ir_builder->CreateAlignedStore(val_ix, eaddr_ix_ptr, alignment);
+
+	if (merge_bb) {
+		m_ir_builder->CreateBr(merge_bb);
+		m_ir_builder->SetInsertPoint(merge_bb);
+	}
+}
+
+void Compiler::CreateMmioBlocks(Value * addr_i64, BasicBlock *& mmio_bb, BasicBlock *& merge_bb) {
+	// Blocks are created after the current one (the instruction may access memory several times, so names are made unique by LLVM)
+	auto current_bb = m_ir_builder->GetInsertBlock();
+	auto name = GetBasicBlockNameFromAddress(m_state.current_instruction_address, "mmio");
+	merge_bb = BasicBlock::Create(m_ir_builder->getContext(), name + "_merge", m_state.function, current_bb->getNextNode());
+	auto memory_bb = BasicBlock::Create(m_ir_builder->getContext(), name + "_memory", m_state.function, merge_bb);
+	mmio_bb = BasicBlock::Create(m_ir_builder->getContext(), name + "_then", m_state.function, memory_bb);
+
+	auto cmp_i1 = m_ir_builder->CreateICmpULT(m_ir_builder->CreateSub(addr_i64, m_ir_builder->getInt64(RAW_SPU_BASE_ADDR)), m_ir_builder->getInt64(6 * RAW_SPU_OFFSET));
+	m_ir_builder->CreateCondBr(cmp_i1, mmio_bb, memory_bb);
+	m_ir_builder->SetInsertPoint(mmio_bb);
 }
 
 llvm::Value * Compiler::IndirectCall(u32 address, Value * context_i64, bool is_function) {
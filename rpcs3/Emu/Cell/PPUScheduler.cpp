@@ -0,0 +1,37 @@
+#include "stdafx.h"
+#include "Utilities/Log.h"
+#include "Emu/Memory/Memory.h"
+#include "Emu/CPU/CPUScheduler.h"
+
+#include "PPUThread.h"
+#include "PPUScheduler.h"
+
+cpu_scheduler_t<PPUThread> g_ppu_sched([](PPUThread& ppu) -> s32
+{
+	return ppu.prio;
+});
+
+void ppu_scheduler_init(u32 slots)
+{
+	g_ppu_sched.init(slots);
+
+	if (slots)
+	{
+		LOG_NOTICE(PPU, "PPU scheduler enabled (%d run slots)", slots);
+	}
+}
+
+bool ppu_scheduler_acquire(PPUThread& ppu)
+{
+	return g_ppu_sched.acquire(ppu);
+}
+
+bool ppu_scheduler_release(PPUThread& ppu)
+{
+	return g_ppu_sched.release(ppu);
+}
+
+void ppu_scheduler_yield(PPUThread& ppu)
+{
+	g_ppu_sched.yield(ppu);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+// Optional PPU scheduler (Ini.PPUThreadSlots, 0 = disabled)
+// Limits the number of PPU threads executing guest code at once to the specified count of run slots.
+// A thread releases its slot while executing HLE functions and syscalls (where it may block) and takes it again on return.
+// Free slots are given to the waiting thread with the best lv2 priority (lowest value), FIFO among equal priorities.
+// Running threads of worse priority (or of equal priority after their time slice) are asked to yield (CPU_STATE_YIELD),
+// which the interpreters check between instructions. Starved threads are served regardless of priority (see cpu_scheduler_t).
+
+class PPUThread;
+
+// set the number of run slots and reset the state (called before PPU threads are started)
+void ppu_scheduler_init(u32 slots);
+
+// take a run slot (waits if none available), returns false if already owned, the scheduler is disabled or the emulation is stopped
+bool ppu_scheduler_acquire(PPUThread& ppu);
+
+// give the run slot to the best waiting thread, returns false if not owned
+bool ppu_scheduler_release(PPUThread& ppu);
+
+// give the run slot away if a thread of better or equal priority is waiting (called after CPU_STATE_YIELD is set)
+void ppu_scheduler_yield(PPUThread& ppu);
+
+// owns the run slot while guest code is executed
+class ppu_sched_run_scope_t final
+{
+	PPUThread& m_ppu;
+	const bool m_owner;
+
+public:
+	ppu_sched_run_scope_t(PPUThread& ppu)
+		: m_ppu(ppu)
+		, m_owner(ppu_scheduler_acquire(ppu))
+	{
+	}
+
+	~ppu_sched_run_scope_t()
+	{
+		if (m_owner)
+		{
+			ppu_scheduler_release(m_ppu);
+		}
+	}
+};
+
+// releases the run slot while HLE code is executed
+class ppu_sched_hle_scope_t final
+{
+	PPUThread& m_ppu;
+	const bool m_released;
+
+public:
+	ppu_sched_hle_scope_t(PPUThread& ppu)
+		: m_ppu(ppu)
+		, m_released(ppu_scheduler_release(ppu))
+	{
+	}
+
+	~ppu_sched_hle_scope_t()
+	{
+		if (m_released)
+		{
+			ppu_scheduler_acquire(m_ppu);
+		}
+	}
+};
@@ -11,6 +11,7 @@
 #include "Emu/Cell/PPUInterpreter.h"
 #include "Emu/Cell/PPUInterpreter2.h"
 #include "Emu/Cell/PPULLVMRecompiler.h"
+#include "Emu/Cell/PPUScheduler.h"
 //#include "Emu/Cell/PPURecompiler.h"
 
 #ifdef _WIN32
@@ -688,6 +689,11 @@ void PPUThread::fast_stop()
 	m_state |= CPU_STATE_RETURN;
 }
 
+void PPUThread::request_yield()
+{
+	m_state |= CPU_STATE_YIELD;
+}
+
 void PPUThread::task()
 {
 	SetHostRoundingMode(FPSCR_RN_NEAR);
@@ -699,11 +705,20 @@ void PPUThread::task()
 		return custom_task(*this);
 	}
 
+	// take the run slot for guest code execution (if the PPU scheduler is enabled)
+	ppu_sched_run_scope_t run_slot(*this);
+
 	if (m_dec)
 	{
 		while (true)
 		{
-			if (m_state.load() && check_status()) break;
+			if (m_state.load())
+			{
+				// give up the run slot if asked by the PPU scheduler
+				if (m_state._and_not(CPU_STATE_YIELD) & CPU_STATE_YIELD) ppu_scheduler_yield(*this);
+
+				if (check_status()) break;
+			}
 
 			// decode instruction using specified decoder
 			m_dec->DecodeMemory(PC);
@@ -716,7 +731,13 @@ void PPUThread::task()
 	{
 		while (true)
 		{
-			if (m_state.load() && check_status()) break;
+			if (m_state.load())
+			{
+				// give up the run slot if asked by the PPU scheduler
+				if (m_state._and_not(CPU_STATE_YIELD) & CPU_STATE_YIELD) ppu_scheduler_yield(*this);
+
+				if (check_status()) break;
+			}
 
 			// get interpreter function
 			const auto func = g_ppu_inter_func_list[*(u32*)((u8*)g_ppu_exec_map + PC)];
@@ -819,6 +819,9 @@ public:
 	u64 get_stack_arg(s32 i);
 	void fast_call(u32 addr, u32 rtoc);
 	void fast_stop();
+
+	// set YIELD (called by the PPU scheduler)
+	void request_yield();
 };
 
 class ppu_thread : cpu_thread
@@ -3,6 +3,7 @@
 #include "Emu/Memory/Memory.h"
 #include "Emu/System.h"
 #include "Emu/SysCalls/Callback.h"
+#include "Emu/CPU/CPUThreadManager.h"
 
 #include "Emu/Cell/RawSPUThread.h"
 
@@ -237,6 +238,42 @@ bool RawSPUThread::write_reg(const u32 addr, const u32 value)
 	return false;
 }
 
+u32 raw_spu_mmio_read32(u32 addr)
+{
+	if (addr % RAW_SPU_OFFSET >= RAW_SPU_PROB_OFFSET)
+	{
+		if (const auto thread = Emu.GetCPU().GetRawSPUThread((addr - RAW_SPU_BASE_ADDR) / RAW_SPU_OFFSET))
+		{
+			u32 value;
+
+			if (thread->read_reg(addr, value))
+			{
+				return value;
+			}
+		}
+	}
+
+	// LS, unavailable thread or invalid register (the access violation handler reports the error)
+	return vm::ps3::read32(addr);
+}
+
+void raw_spu_mmio_write32(u32 addr, u32 value)
+{
+	if (addr % RAW_SPU_OFFSET >= RAW_SPU_PROB_OFFSET)
+	{
+		if (const auto thread = Emu.GetCPU().GetRawSPUThread((addr - RAW_SPU_BASE_ADDR) / RAW_SPU_OFFSET))
+		{
+			if (thread->write_reg(addr, value))
+			{
+				return;
+			}
+		}
+	}
+
+	// LS, unavailable thread or invalid register (the access violation handler reports the error)
+	vm::ps3::write32(addr, value);
+}
+
 void RawSPUThread::task()
 {
 	// get next PC and SPU Interrupt status
@@ -15,6 +15,32 @@ force_inline static u32 GetRawSPURegAddrByNum(int num, int offset)
 	return RAW_SPU_OFFSET * num + RAW_SPU_BASE_ADDR + RAW_SPU_PROB_OFFSET + offset;
 }
 
+// access raw SPU problem state register directly (other addresses and invalid registers are accessed normally, so an invalid access still triggers access violation)
+u32 raw_spu_mmio_read32(u32 addr);
+void raw_spu_mmio_write32(u32 addr, u32 value);
+
+// 32-bit load used by PPU instructions (avoids access violation handling for raw SPU MMIO)
+force_inline static u32 ppu_read32(u32 addr)
+{
+	if (addr - RAW_SPU_BASE_ADDR < 6 * RAW_SPU_OFFSET)
+	{
+		return raw_spu_mmio_read32(addr);
+	}
+
+	return vm::ps3::read32(addr);
+}
+
+// 32-bit store used by PPU instructions (avoids access violation handling for raw SPU MMIO)
+force_inline static void ppu_write32(u32 addr, u32 value)
+{
+	if (addr - RAW_SPU_BASE_ADDR < 6 * RAW_SPU_OFFSET)
+	{
+		return raw_spu_mmio_write32(addr, value);
+	}
+
+	vm::ps3::write32(addr, value);
+}
+
 class RawSPUThread final : public SPUThread
 {
 public:
@@ -0,0 +1,55 @@
+#include "stdafx.h"
+#include "Utilities/Log.h"
+#include "Emu/Memory/Memory.h"
+#include "Emu/System.h"
+#include "Emu/SysCalls/lv2/sys_spu.h"
+#include "Emu/CPU/CPUScheduler.h"
+
+#include "SPUThread.h"
+#include "SPUScheduler.h"
+
+// priority of the SPU thread group (raw SPUs have no group and are scheduled first)
+cpu_scheduler_t<SPUThread> g_spu_sched([](SPUThread& spu) -> s32
+{
+	if (const auto group = spu.tg.lock())
+	{
+		return group->prio;
+	}
+
+	return 0;
+});
+
+void spu_scheduler_init(u32 slots)
+{
+	g_spu_sched.init(slots);
+
+	if (slots)
+	{
+		LOG_NOTICE(SPU, "SPU scheduler enabled (%d run slots)", slots);
+	}
+}
+
+void spu_scheduler_reserve(u32 count)
+{
+	const u32 slots = g_spu_sched.get_slots();
+
+	if (g_spu_sched.reserve(count))
+	{
+		LOG_WARNING(SPU, "SPU scheduler: run slots increased from %d to %d (SPU thread group size)", slots, count);
+	}
+}
+
+bool spu_scheduler_acquire(SPUThread& spu)
+{
+	return g_spu_sched.acquire(spu);
+}
+
+bool spu_scheduler_release(SPUThread& spu)
+{
+	return g_spu_sched.release(spu);
+}
+
+void spu_scheduler_yield(SPUThread& spu)
+{
+	g_spu_sched.yield(spu);
+}
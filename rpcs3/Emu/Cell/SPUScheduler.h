@@ -0,0 +1,79 @@
+#pragma once
+
+// Optional SPU scheduler (Ini.SPUThreadSlots, 0 = disabled)
+// Limits the number of SPU threads (of all groups and raw SPUs) executing SPU code at once to the specified count of run slots.
+// A thread releases its slot while it's blocked on channel access or in stop_and_signal and takes it again after waking up.
+// Free slots are given to the waiting thread of the group with the best priority (lowest value, raw SPUs first), FIFO among equal priorities.
+// Running threads of worse priority (or of equal priority after their time slice) are asked to yield (CPU_STATE_YIELD).
+// Starved threads are served regardless of priority (see cpu_scheduler_t).
+// Threads of a group are gang-scheduled on real hardware and may busy-wait for each other, so the number of run slots is
+// raised to the size of the biggest started SPU thread group (spu_scheduler_reserve()).
+
+class SPUThread;
+
+// set the number of run slots and reset the state (called before SPU threads are started)
+void spu_scheduler_init(u32 slots);
+
+// make sure that all threads of a group can run at once (called when the SPU thread group is started)
+void spu_scheduler_reserve(u32 count);
+
+// take a run slot (waits if none available), returns false if already owned, the scheduler is disabled or the thread is stopped
+bool spu_scheduler_acquire(SPUThread& spu);
+
+// give the run slot to the best waiting thread, returns false if not owned
+bool spu_scheduler_release(SPUThread& spu);
+
+// give the run slot away if a thread of better or equal priority is waiting (called after CPU_STATE_YIELD is set)
+void spu_scheduler_yield(SPUThread& spu);
+
+// owns the run slot while SPU code is executed
+class spu_sched_run_scope_t final
+{
+	SPUThread& m_spu;
+	const bool m_owner;
+
+public:
+	spu_sched_run_scope_t(SPUThread& spu)
+		: m_spu(spu)
+		, m_owner(spu_scheduler_acquire(spu))
+	{
+	}
+
+	~spu_sched_run_scope_t()
+	{
+		if (m_owner)
+		{
+			spu_scheduler_release(m_spu);
+		}
+	}
+};
+
+// releases the run slot before blocking (release() is called only when the thread is going to wait)
+class spu_sched_wait_scope_t final
+{
+	SPUThread& m_spu;
+	bool m_released = false;
+
+public:
+	spu_sched_wait_scope_t(SPUThread& spu)
+		: m_spu(spu)
+	{
+	}
+
+	void release()
+	{
+		if (!m_released)
+		{
+			m_released = spu_scheduler_release(m_spu);
+		}
+	}
+
+	~spu_sched_wait_scope_t()
+	{
+		// don't wait for the slot if the thread is being stopped
+		if (m_released && !std::uncaught_exception())
+		{
+			spu_scheduler_acquire(m_spu);
+		}
+	}
+};
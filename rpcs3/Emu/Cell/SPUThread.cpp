@@ -14,6 +14,8 @@
 
 #include "Emu/Cell/SPUDisAsm.h"
 #include "Emu/Cell/SPUThread.h"
+#include "Emu/Cell/RawSPUThread.h"
+#include "Emu/Cell/SPUScheduler.h"
 #include "Emu/Cell/SPUDecoder.h"
 #include "Emu/Cell/SPUInterpreter.h"
 #include "Emu/Cell/SPUInterpreter2.h"
@@ -23,6 +25,32 @@
 
 extern u64 get_timebased_time();
 
+// instructions (or recompiled blocks) executed before queued DMA commands are forced to complete
+// (an SPU may poll LS for the result of a PUT without accessing channels)
+const u32 g_spu_mfc_queue_max_wait = 1024;
+
+// polling iterations before blocking on channel access (disabled on single-core hosts where the other side can't run meanwhile)
+const u32 g_spu_spin_count = std::thread::hardware_concurrency() > 1 ? 1000 : 0;
+
+// poll the predicate for a short time, so a fast response doesn't require the mutex and cv round-trip (the waiting flag isn't set meanwhile)
+template<typename F> force_inline static bool spu_spin_wait(F pred)
+{
+	for (u32 i = 0; i < g_spu_spin_count; i++)
+	{
+		if (pred())
+		{
+			return true;
+		}
+
+		_mm_pause();
+	}
+
+	return false;
+}
+
+// maximal time (microseconds) a thread stays parked on a channel (the thread status is checked after it, stop() only notifies the cv)
+const u64 g_spu_park_timeout = 10000;
+
 void spu_int_ctrl_t::set(u64 ints)
 {
 	// leave only enabled interrupts
@@ -151,11 +179,25 @@ void SPUThread::task()
 		return custom_task(*this);
 	}
 	
+	// take the run slot for SPU code execution (if the SPU scheduler is enabled)
+	spu_sched_run_scope_t run_slot(*this);
+
 	if (m_dec)
 	{
 		while (true)
 		{
-			if (m_state.load() && check_status()) break;
+			if (m_state.load())
+			{
+				// give up the run slot if asked by the SPU scheduler
+				if (m_state._and_not(CPU_STATE_YIELD) & CPU_STATE_YIELD) spu_scheduler_yield(*this);
+
+				if (check_status()) break;
+			}
+
+			if (mfc_cmd_queue.size() && ++mfc_cmd_wait >= g_spu_mfc_queue_max_wait)
+			{
+				process_mfc_queue();
+			}
 
 			// decode instruction using specified decoder
 			m_dec->DecodeMemory(PC + offset);
@@ -168,7 +210,18 @@ void SPUThread::task()
 	{
 		while (true)
 		{
-			if (m_state.load() && check_status()) break;
+			if (m_state.load())
+			{
+				// give up the run slot if asked by the SPU scheduler
+				if (m_state._and_not(CPU_STATE_YIELD) & CPU_STATE_YIELD) spu_scheduler_yield(*this);
+
+				if (check_status()) break;
+			}
+
+			if (mfc_cmd_queue.size() && ++mfc_cmd_wait >= g_spu_mfc_queue_max_wait)
+			{
+				process_mfc_queue();
+			}
 
 			// read opcode
 			const spu_opcode_t opcode = { vm::read32(PC + offset) };
@@ -185,6 +238,11 @@ void SPUThread::task()
 	}
 }
 
+void SPUThread::request_yield()
+{
+	m_state |= CPU_STATE_YIELD;
+}
+
 void SPUThread::init_regs()
 {
 	memset(GPR, 0, sizeof(GPR));
@@ -192,8 +250,11 @@ void SPUThread::init_regs()
 
 	ch_mfc_args = {};
 	mfc_queue.clear();
+	mfc_cmd_queue.clear();
+	mfc_cmd_wait = 0;
 
 	ch_tag_mask = 0;
+	ch_tag_upd = MFC_TAG_UPDATE_IMMEDIATE;
 	ch_tag_stat = {};
 	ch_stall_stat = {};
 	ch_atomic_stat = {};
@@ -345,13 +406,14 @@ void SPUThread::do_dma_transfer(u32 cmd, spu_mfc_arg_t args)
 	case MFC_PUT_CMD:
 	case MFC_PUTR_CMD:
 	{
-		memcpy(vm::get_ptr(eal), vm::get_ptr(offset + args.lsa), args.size);
+		// non-temporal stores are opt-in (slower if the destination is read soon, see dma_bench), never used for LS
+		vm::copy(vm::get_ptr(eal), vm::get_ptr(offset + args.lsa), args.size, Ini.SPUStreamPut.GetValue() && args.ea < RAW_SPU_BASE_ADDR);
 		return;
 	}
 
 	case MFC_GET_CMD:
 	{
-		memcpy(vm::get_ptr(offset + args.lsa), vm::get_ptr(eal), args.size);
+		vm::copy(vm::get_ptr(offset + args.lsa), vm::get_ptr(eal), args.size);
 		return;
 	}
 	}
@@ -377,6 +439,9 @@ void SPUThread::do_dma_list_cmd(u32 cmd, spu_mfc_arg_t args)
 		be_t<u32> ea; // External Address Low
 	};
 
+	// adjacent elements are merged into a single transfer
+	spu_mfc_arg_t transfer = {};
+
 	for (u32 i = 0; i < list_size; i++)
 	{
 		auto rec = vm::ptr<list_element>::make(offset + list_addr + i * 8);
@@ -386,19 +451,35 @@ void SPUThread::do_dma_list_cmd(u32 cmd, spu_mfc_arg_t args)
 
 		if (size)
 		{
-			spu_mfc_arg_t transfer;
-			transfer.ea = addr;
-			transfer.lsa = args.lsa | (addr & 0xf);
-			transfer.tag = args.tag;
-			transfer.size = size;
+			const u32 lsa = args.lsa | (addr & 0xf);
+
+			if (transfer.size && addr == transfer.eal + transfer.size && lsa == transfer.lsa + transfer.size && transfer.size + size <= 0xffff && addr < SYS_SPU_THREAD_BASE_LOW)
+			{
+				transfer.size += size;
+			}
+			else
+			{
+				if (transfer.size)
+				{
+					do_dma_transfer(cmd & ~MFC_LIST_MASK, transfer);
+				}
 
-			do_dma_transfer(cmd & ~MFC_LIST_MASK, transfer);
+				transfer.ea = addr;
+				transfer.lsa = lsa;
+				transfer.tag = args.tag;
+				transfer.size = size;
+			}
 
 			args.lsa += std::max<u32>(size, 16);
 		}
 
 		if (rec->sb & 0x8000)
 		{
+			if (transfer.size)
+			{
+				do_dma_transfer(cmd & ~MFC_LIST_MASK, transfer);
+			}
+
 			ch_stall_stat.set_value((1 << args.tag) | ch_stall_stat.get_value());
 
 			spu_mfc_arg_t stalled;
@@ -411,6 +492,83 @@ void SPUThread::do_dma_list_cmd(u32 cmd, spu_mfc_arg_t args)
 			return;
 		}
 	}
+
+	if (transfer.size)
+	{
+		do_dma_transfer(cmd & ~MFC_LIST_MASK, transfer);
+	}
+}
+
+void SPUThread::process_mfc_queue()
+{
+	// adjacent commands of the same type are merged into a single transfer
+	spu_mfc_arg_t transfer = {};
+	u32 transfer_cmd = 0;
+
+	for (auto& cmd : mfc_cmd_queue)
+	{
+		const auto& args = cmd.second;
+
+		if (transfer.size && !(cmd.first & MFC_LIST_MASK) && (cmd.first & ~(MFC_BARRIER_MASK | MFC_FENCE_MASK)) == (transfer_cmd & ~(MFC_BARRIER_MASK | MFC_FENCE_MASK)) &&
+			args.ea == transfer.ea + transfer.size && args.lsa == transfer.lsa + transfer.size && transfer.size + args.size <= 0xffff && args.ea < SYS_SPU_THREAD_BASE_LOW)
+		{
+			transfer.size += args.size;
+			continue;
+		}
+
+		if (transfer.size)
+		{
+			do_dma_transfer(transfer_cmd, transfer);
+			transfer.size = 0;
+		}
+
+		if (cmd.first & MFC_LIST_MASK)
+		{
+			do_dma_list_cmd(cmd.first, args);
+		}
+		else if (args.size)
+		{
+			transfer = args;
+			transfer_cmd = cmd.first;
+		}
+	}
+
+	if (transfer.size)
+	{
+		do_dma_transfer(transfer_cmd, transfer);
+	}
+
+	mfc_cmd_queue.clear();
+	mfc_cmd_wait = 0;
+}
+
+u32 SPUThread::get_stalled_tags() const
+{
+	u32 result = 0;
+
+	for (auto& cmd : mfc_queue)
+	{
+		result |= 1 << cmd.second.tag;
+	}
+
+	return result;
+}
+
+void SPUThread::update_tag_status()
+{
+	if (ch_tag_upd == MFC_TAG_UPDATE_IMMEDIATE)
+	{
+		return;
+	}
+
+	// queued commands are already executed, only stalled list transfers may be incomplete
+	const u32 completed = ch_tag_mask & ~get_stalled_tags();
+
+	if ((ch_tag_upd == MFC_TAG_UPDATE_ANY && completed) || (ch_tag_upd == MFC_TAG_UPDATE_ALL && completed == ch_tag_mask))
+	{
+		ch_tag_stat.set_value(completed);
+		ch_tag_upd = MFC_TAG_UPDATE_IMMEDIATE;
+	}
 }
 
 void SPUThread::process_mfc_cmd(u32 cmd)
@@ -431,10 +589,6 @@ void SPUThread::process_mfc_cmd(u32 cmd)
 	case MFC_GET_CMD:
 	case MFC_GETB_CMD:
 	case MFC_GETF_CMD:
-	{
-		return do_dma_transfer(cmd, ch_mfc_args);
-	}
-
 	case MFC_PUTL_CMD:
 	case MFC_PUTLB_CMD:
 	case MFC_PUTLF_CMD:
@@ -445,9 +599,22 @@ void SPUThread::process_mfc_cmd(u32 cmd)
 	case MFC_GETLB_CMD:
 	case MFC_GETLF_CMD:
 	{
-		return do_dma_list_cmd(cmd, ch_mfc_args);
+		// enqueue the command (executed in order at the next synchronization point or when the queue is full)
+		if (mfc_cmd_queue.size() >= MFC_SPU_MAX_QUEUE_SPACE)
+		{
+			process_mfc_queue();
+		}
+
+		mfc_cmd_queue.emplace_back(cmd, ch_mfc_args);
+		return;
 	}
+	}
+
+	// atomic commands are executed immediately after all queued commands
+	process_mfc_queue();
 
+	switch (cmd)
+	{
 	case MFC_GETLLAR_CMD: // acquire reservation
 	{
 		if (ch_mfc_args.size != 128)
@@ -510,7 +677,7 @@ void SPUThread::process_mfc_cmd(u32 cmd)
 
 		vm::reservation_op(VM_CAST(ch_mfc_args.ea), 128, [this]()
 		{
-			std::memcpy(vm::priv_ptr(VM_CAST(ch_mfc_args.ea)), vm::get_ptr(offset + ch_mfc_args.lsa), 128);
+			vm::copy(vm::priv_ptr(VM_CAST(ch_mfc_args.ea)), vm::get_ptr(offset + ch_mfc_args.lsa), 128);
 		});
 
 		if (last_raddr != 0 && vm::g_tls_did_break_reservation)
@@ -612,9 +779,15 @@ u32 SPUThread::get_ch_count(u32 ch)
 		LOG_NOTICE(SPU, "get_ch_count(ch=%d [%s])", ch, ch < 128 ? spu_ch_name[ch] : "???");
 	}
 
+	// complete queued DMA commands (including the case when the queue is full)
+	if (mfc_cmd_queue.size() && (ch != MFC_Cmd || mfc_cmd_queue.size() >= MFC_SPU_MAX_QUEUE_SPACE))
+	{
+		process_mfc_queue();
+	}
+
 	switch (ch)
 	{
-	//case MFC_Cmd:             return 16;
+	case MFC_Cmd:             return MFC_SPU_MAX_QUEUE_SPACE - static_cast<u32>(mfc_cmd_queue.size());
 	//case SPU_WrSRR0:          return 1; break;
 	//case SPU_RdSRR0:          return 1; break;
 	case SPU_WrOutMbox:       return ch_out_mbox.get_count() ^ 1; break;
@@ -639,10 +812,20 @@ u32 SPUThread::get_ch_value(u32 ch)
 		LOG_NOTICE(SPU, "get_ch_value(ch=%d [%s])", ch, ch < 128 ? spu_ch_name[ch] : "???");
 	}
 
+	// complete queued DMA commands before reading any channel (the SPU may be waiting for their result)
+	if (mfc_cmd_queue.size())
+	{
+		process_mfc_queue();
+	}
+
 	auto read_channel = [this](spu_channel_t& channel) -> u32
 	{
+		spu_sched_wait_scope_t wait_slot(*this);
+
 		std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
 
+		spu_spin_wait([&]{ return channel.get_count() != 0; });
+
 		while (true)
 		{
 			bool result;
@@ -661,6 +844,16 @@ u32 SPUThread::get_ch_value(u32 ch)
 
 			if (!lock)
 			{
+				// give up the run slot before blocking (if the SPU scheduler is enabled)
+				wait_slot.release();
+
+				if (g_thread_park)
+				{
+					// sleep on the channel word instead of the cv (woken by the channel)
+					channel.park(g_spu_park_timeout);
+					continue;
+				}
+
 				lock.lock();
 				continue;
 			}
@@ -676,8 +869,12 @@ u32 SPUThread::get_ch_value(u32 ch)
 	//	break;
 	case SPU_RdInMbox:
 	{
+		spu_sched_wait_scope_t wait_slot(*this);
+
 		std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
 
+		spu_spin_wait([&]{ return ch_in_mbox.get_count() != 0; });
+
 		while (true)
 		{
 			bool result;
@@ -702,6 +899,16 @@ u32 SPUThread::get_ch_value(u32 ch)
 
 			if (!lock)
 			{
+				// give up the run slot before blocking (if the SPU scheduler is enabled)
+				wait_slot.release();
+
+				if (g_thread_park)
+				{
+					// sleep on the channel word instead of the cv (woken by the channel)
+					ch_in_mbox.park(g_spu_park_timeout);
+					continue;
+				}
+
 				lock.lock();
 				continue;
 			}
@@ -752,6 +959,8 @@ u32 SPUThread::get_ch_value(u32 ch)
 
 	case SPU_RdEventStat:
 	{
+		spu_sched_wait_scope_t wait_slot(*this);
+
 		std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
 
 		// start waiting or return immediately
@@ -760,6 +969,9 @@ u32 SPUThread::get_ch_value(u32 ch)
 			return res;
 		}
 
+		// give up the run slot before blocking (if the SPU scheduler is enabled)
+		wait_slot.release();
+
 		if (ch_event_mask.load() & SPU_EVENT_LR)
 		{
 			// register waiter if polling reservation status is required
@@ -803,6 +1015,12 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 		LOG_NOTICE(SPU, "set_ch_value(ch=%d [%s], value=0x%x)", ch, ch < 128 ? spu_ch_name[ch] : "???", value);
 	}
 
+	// complete queued DMA commands before writing any channel except MFC command parameters and tag mask
+	if (mfc_cmd_queue.size() && (ch < MFC_LSA || ch > MFC_WrTagMask))
+	{
+		process_mfc_queue();
+	}
+
 	switch (ch)
 	{
 	//case SPU_WrSRR0:
@@ -812,8 +1030,12 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 	{
 		if (m_type == CPU_THREAD_RAW_SPU)
 		{
+			spu_sched_wait_scope_t wait_slot(*this);
+
 			std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
 
+			spu_spin_wait([&]{ return ch_out_intr_mbox.get_count() == 0; });
+
 			while (!ch_out_intr_mbox.try_push(value))
 			{
 				CHECK_EMU_STATUS;
@@ -822,6 +1044,16 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 
 				if (!lock)
 				{
+					// give up the run slot before blocking (if the SPU scheduler is enabled)
+					wait_slot.release();
+
+					if (g_thread_park)
+					{
+						// sleep on the channel word instead of the cv (woken by the channel)
+						ch_out_intr_mbox.park(g_spu_park_timeout);
+						continue;
+					}
+
 					lock.lock();
 					continue;
 				}
@@ -839,8 +1071,6 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 			{
 				/* ===== sys_spu_thread_send_event (used by spu_printf) ===== */
 
-				LV2_LOCK;
-
 				const u8 spup = code & 63;
 
 				if (!ch_out_mbox.get_count())
@@ -862,7 +1092,14 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 					LOG_NOTICE(SPU, "sys_spu_thread_send_event(spup=%d, data0=0x%x, data1=0x%x)", spup, value & 0x00ffffff, data);
 				}
 
-				const auto queue = this->spup[spup].lock();
+				std::shared_ptr<lv2_event_queue_t> queue;
+
+				{
+					// SPU ports are protected by the core mutex
+					LV2_LOCK;
+
+					queue = this->spup[spup].lock();
+				}
 
 				if (!queue)
 				{
@@ -870,6 +1107,14 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 					return ch_in_mbox.set_values(1, CELL_ENOTCONN); // TODO: check error passing
 				}
 
+				lv2_lock_t lv2_lock(queue->sync);
+
+				// check whether the queue was destroyed before locking
+				if (!Emu.GetIdManager().check_id<lv2_event_queue_t>(queue->id))
+				{
+					return ch_in_mbox.set_values(1, CELL_ENOTCONN);
+				}
+
 				if (queue->events.size() >= queue->size)
 				{
 					return ch_in_mbox.set_values(1, CELL_EBUSY);
@@ -883,8 +1128,6 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 			{
 				/* ===== sys_spu_thread_throw_event ===== */
 
-				LV2_LOCK;
-
 				const u8 spup = code & 63;
 
 				if (!ch_out_mbox.get_count())
@@ -901,7 +1144,14 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 					LOG_WARNING(SPU, "sys_spu_thread_throw_event(spup=%d, data0=0x%x, data1=0x%x)", spup, value & 0x00ffffff, data);
 				}
 
-				const auto queue = this->spup[spup].lock();
+				std::shared_ptr<lv2_event_queue_t> queue;
+
+				{
+					// SPU ports are protected by the core mutex
+					LV2_LOCK;
+
+					queue = this->spup[spup].lock();
+				}
 
 				if (!queue)
 				{
@@ -909,6 +1159,14 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 					return;
 				}
 
+				lv2_lock_t lv2_lock(queue->sync);
+
+				// check whether the queue was destroyed before locking
+				if (!Emu.GetIdManager().check_id<lv2_event_queue_t>(queue->id))
+				{
+					return;
+				}
+
 				// TODO: check passing spup value
 				if (queue->events.size() >= queue->size)
 				{
@@ -923,8 +1181,6 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 			{
 				/* ===== sys_event_flag_set_bit ===== */
 
-				LV2_LOCK;
-
 				const u32 flag = value & 0xffffff;
 
 				if (!ch_out_mbox.get_count())
@@ -958,6 +1214,14 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 					return ch_in_mbox.set_values(1, CELL_ESRCH);
 				}
 
+				lv2_lock_t lv2_lock(eflag->sync);
+
+				// check whether the object was destroyed before locking
+				if (!Emu.GetIdManager().check_id<lv2_event_flag_t>(data))
+				{
+					return ch_in_mbox.set_values(1, CELL_ESRCH);
+				}
+
 				const u64 bitptn = 1ull << flag;
 
 				if (~eflag->pattern.fetch_or(bitptn) & bitptn)
@@ -972,8 +1236,6 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 			{
 				/* ===== sys_event_flag_set_bit_impatient ===== */
 
-				LV2_LOCK;
-
 				const u32 flag = value & 0xffffff;
 
 				if (!ch_out_mbox.get_count())
@@ -1002,6 +1264,8 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 					return;
 				}
 
+				lv2_lock_t lv2_lock(eflag->sync);
+
 				const u64 bitptn = 1ull << flag;
 
 				if (~eflag->pattern.fetch_or(bitptn) & bitptn)
@@ -1028,8 +1292,12 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 
 	case SPU_WrOutMbox:
 	{
+		spu_sched_wait_scope_t wait_slot(*this);
+
 		std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
 
+		spu_spin_wait([&]{ return ch_out_mbox.get_count() == 0; });
+
 		while (!ch_out_mbox.try_push(value))
 		{
 			CHECK_EMU_STATUS;
@@ -1038,6 +1306,16 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 
 			if (!lock)
 			{
+				// give up the run slot before blocking (if the SPU scheduler is enabled)
+				wait_slot.release();
+
+				if (g_thread_park)
+				{
+					// sleep on the channel word instead of the cv (woken by the channel)
+					ch_out_mbox.park(g_spu_park_timeout);
+					continue;
+				}
+
 				lock.lock();
 				continue;
 			}
@@ -1056,7 +1334,21 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 
 	case MFC_WrTagUpdate:
 	{
-		ch_tag_stat.set_value(ch_tag_mask); // hack
+		if (value > MFC_TAG_UPDATE_ALL)
+		{
+			break;
+		}
+
+		// queued commands are complete at this point, tags of stalled list transfers are pending until acknowledged
+		ch_tag_upd = value;
+
+		if (value == MFC_TAG_UPDATE_IMMEDIATE)
+		{
+			ch_tag_stat.set_value(ch_tag_mask & ~get_stalled_tags());
+			return;
+		}
+
+		update_tag_status();
 		return;
 	}
 
@@ -1144,6 +1436,8 @@ void SPUThread::set_ch_value(u32 ch, u32 value)
 			}
 		}
 
+		// a conditional tag status update may be satisfied now
+		update_tag_status();
 		return;
 	}
 
@@ -1194,6 +1488,11 @@ void SPUThread::stop_and_signal(u32 code)
 		LOG_NOTICE(SPU, "stop_and_signal(code=0x%x)", code);
 	}
 
+	process_mfc_queue();
+
+	// must be destroyed after LV2_LOCK (the slot is taken again without it)
+	spu_sched_wait_scope_t wait_slot(*this);
+
 	if (m_type == CPU_THREAD_RAW_SPU)
 	{
 		status.atomic_op([code](u32& status)
@@ -1300,6 +1599,8 @@ void SPUThread::stop_and_signal(u32 code)
 
 			if (is_stopped()) throw CPUThreadStop{};
 
+			wait_slot.release();
+
 			group->cv.wait_for(lv2_lock, std::chrono::milliseconds(1));
 		}
 
@@ -1318,31 +1619,48 @@ void SPUThread::stop_and_signal(u32 code)
 			throw EXCEPTION("Unexpected SPU Thread Group state (%d)", group->state);
 		}
 
-		if (queue->events.size())
-		{
-			auto& event = queue->events.front();
-			ch_in_mbox.set_values(4, CELL_OK, static_cast<u32>(std::get<1>(event)), static_cast<u32>(std::get<2>(event)), static_cast<u32>(std::get<3>(event)));
+		// the event queue is protected by its own lock, which can't be locked with the core mutex held
+		lv2_lock.unlock();
 
-			queue->events.pop_front();
-		}
-		else
 		{
-			// add waiter; protocol is ignored in current implementation
-			sleep_queue_entry_t waiter(*this, queue->sq);
+			lv2_lock_t queue_lock(queue->sync);
 
-			// wait on the event queue
-			while (!unsignal())
+			if (!Emu.GetIdManager().check_id<lv2_event_queue_t>(queue->id))
 			{
-				CHECK_EMU_STATUS;
-
-				if (is_stopped()) throw CPUThreadStop{};
+				// destroyed before locking
+				ch_in_mbox.set_values(1, CELL_ECANCELED);
+			}
+			else if (queue->events.size())
+			{
+				auto& event = queue->events.front();
+				ch_in_mbox.set_values(4, CELL_OK, static_cast<u32>(std::get<1>(event)), static_cast<u32>(std::get<2>(event)), static_cast<u32>(std::get<3>(event)));
 
-				cv.wait(lv2_lock);
+				queue->events.pop_front();
 			}
+			else
+			{
+				// add waiter; protocol is ignored in current implementation
+				sleep_queue_entry_t waiter(*this, queue->sq);
 
-			// event data must be set by push()
+				// give up the run slot before blocking (if the SPU scheduler is enabled)
+				wait_slot.release();
+
+				// wait on the event queue
+				while (!unsignal())
+				{
+					CHECK_EMU_STATUS;
+
+					if (is_stopped()) throw CPUThreadStop{};
+
+					cv.wait(queue_lock);
+				}
+
+				// event data must be set by push()
+			}
 		}
-		
+
+		lv2_lock.lock();
+
 		// restore thread group status
 		if (group->state == SPU_THREAD_GROUP_STATUS_WAITING)
 		{
@@ -1457,6 +1775,8 @@ void SPUThread::halt()
 		LOG_NOTICE(SPU, "halt()");
 	}
 
+	process_mfc_queue();
+
 	if (m_type == CPU_THREAD_RAW_SPU)
 	{
 		status.atomic_op([](u32& status)
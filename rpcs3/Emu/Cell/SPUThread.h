@@ -4,6 +4,7 @@
 #include "Emu/CPU/CPUThread.h"
 #include "Emu/Cell/SPUContext.h"
 #include "MFC.h"
+#include "Utilities/Park.h"
 
 struct lv2_event_queue_t;
 struct spu_group_t;
@@ -150,6 +151,19 @@ union spu_channel_t
 
 	atomic_t<sync_var_t> sync_var;
 
+	// wake the thread parked on the channel, returns true if the condition variable must be notified instead
+	bool unpark()
+	{
+		if (!g_thread_park)
+		{
+			return true;
+		}
+
+		thread_unpark_all(reinterpret_cast<volatile u32*>(&sync_var.data));
+
+		return false;
+	}
+
 public:
 	// returns true on success
 	bool try_push(u32 value)
@@ -186,7 +200,7 @@ public:
 			}
 
 			return false;
-		});
+		}) && unpark();
 	}
 
 	// push unconditionally (overwriting previous value), returns true if needs signaling
@@ -205,7 +219,7 @@ public:
 			}
 
 			return false;
-		});
+		}) && unpark();
 	}
 
 	// returns true on success and u32 value
@@ -226,7 +240,7 @@ public:
 	// pop unconditionally (loading last value), returns u32 value and bool value (true if needs signaling)
 	std::tuple<u32, bool> pop()
 	{
-		return sync_var.atomic_op([](sync_var_t& data)
+		const auto result = sync_var.atomic_op([](sync_var_t& data)
 		{
 			const auto result = std::make_tuple(u32{ data.value }, data.waiting != 0);
 
@@ -236,6 +250,19 @@ public:
 			
 			return result;
 		});
+
+		return std::make_tuple(std::get<0>(result), std::get<1>(result) && unpark());
+	}
+
+	// sleep after failed try_pop() or try_push() until the channel is notified (if g_thread_park is set), may return spuriously
+	void park(u64 timeout)
+	{
+		const sync_var_t data = sync_var.load();
+
+		if (data.waiting)
+		{
+			thread_park(reinterpret_cast<volatile u32*>(&sync_var.data), reinterpret_cast<const u32&>(data), timeout);
+		}
 	}
 
 	void set_value(u32 value, u32 count = 1)
@@ -272,6 +299,19 @@ struct spu_channel_4_t
 	atomic_t<sync_var_t> sync_var;
 	atomic_t<u32> value3;
 
+	// wake the thread parked on the channel, returns true if the condition variable must be notified instead
+	bool unpark()
+	{
+		if (!g_thread_park)
+		{
+			return true;
+		}
+
+		thread_unpark_all(reinterpret_cast<volatile u32*>(&sync_var.data));
+
+		return false;
+	}
+
 public:
 	void clear()
 	{
@@ -302,7 +342,7 @@ public:
 			}
 
 			return false;
-		});
+		}) && unpark();
 	}
 
 	// returns true on success and two u32 values: data and count after removing the first element
@@ -330,6 +370,17 @@ public:
 		});
 	}
 
+	// sleep after failed try_pop() until the channel is notified (if g_thread_park is set), may return spuriously
+	void park(u64 timeout)
+	{
+		const sync_var_t data = sync_var.load();
+
+		if (data.waiting)
+		{
+			thread_park(reinterpret_cast<volatile u32*>(&sync_var.data), reinterpret_cast<const u32&>(data), timeout);
+		}
+	}
+
 	u32 get_count() volatile
 	{
 		return sync_var.data.count;
@@ -552,8 +603,11 @@ public:
 	spu_mfc_arg_t ch_mfc_args;
 
 	std::vector<std::pair<u32, spu_mfc_arg_t>> mfc_queue; // Only used for stalled list transfers
+	std::vector<std::pair<u32, spu_mfc_arg_t>> mfc_cmd_queue; // Queued GET/PUT commands (executed at synchronization points)
+	u32 mfc_cmd_wait; // Instructions executed while mfc_cmd_queue isn't empty
 
 	u32 ch_tag_mask;
+	u32 ch_tag_upd; // Pending conditional tag status update (MFC_TAG_UPDATE_ANY or MFC_TAG_UPDATE_ALL)
 	spu_channel_t ch_tag_stat;
 	spu_channel_t ch_stall_stat;
 	spu_channel_t ch_atomic_stat;
@@ -628,6 +682,9 @@ public:
 	void do_dma_transfer(u32 cmd, spu_mfc_arg_t args);
 	void do_dma_list_cmd(u32 cmd, spu_mfc_arg_t args);
 	void process_mfc_cmd(u32 cmd);
+	void process_mfc_queue();
+	u32 get_stalled_tags() const;
+	void update_tag_status();
 
 	u32 get_events(bool waiting = false);
 	void set_events(u32 mask);
@@ -705,6 +762,9 @@ public:
 
 	void fast_call(u32 ls_addr);
 
+	// set YIELD (called by the SPU scheduler)
+	void request_yield();
+
 	virtual std::string RegsToString() const override
 	{
 		std::string ret = "Registers:\n=========\n";
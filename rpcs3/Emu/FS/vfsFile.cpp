@@ -73,6 +73,21 @@ u64 vfsFile::Tell() const
 	return m_stream->Tell();
 }
 
+u64 vfsFile::ReadAt(u64 offset, void* dst, u64 size)
+{
+	return m_stream->ReadAt(offset, dst, size);
+}
+
+u64 vfsFile::WriteAt(u64 offset, const void* src, u64 size)
+{
+	return m_stream->WriteAt(offset, src, size);
+}
+
+bool vfsFile::IsPositional() const
+{
+	return m_stream && m_stream->IsPositional();
+}
+
 bool vfsFile::IsOpened() const
 {
 	return m_stream && m_stream->IsOpened();
@@ -36,3 +36,8 @@ u32 vfsFileBase::GetOpenMode() const
 {
 	return m_mode;
 }
+
+vfsDevice* vfsFileBase::GetDevice() const
+{
+	return m_device;
+}
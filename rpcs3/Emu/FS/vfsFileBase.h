@@ -31,4 +31,5 @@ public:
 
 	std::string GetPath() const;
 	u32 GetOpenMode() const;
+	vfsDevice* GetDevice() const;
 };
@@ -43,6 +43,25 @@ u64 vfsLocalFile::Tell() const
 	return m_file.seek(0, from_cur);
 }
 
+u64 vfsLocalFile::ReadAt(u64 offset, void* dst, u64 size)
+{
+	return m_file.read_at(offset, dst, size);
+}
+
+u64 vfsLocalFile::WriteAt(u64 offset, const void* src, u64 size)
+{
+	return m_file.write_at(offset, src, size);
+}
+
+bool vfsLocalFile::IsPositional() const
+{
+#ifdef _WIN32
+	return false; // the file pointer is saved and restored
+#else
+	return true;
+#endif
+}
+
 bool vfsLocalFile::IsOpened() const
 {
 	return m_file && vfsFileBase::IsOpened();
@@ -23,6 +23,10 @@ public:
 	virtual u64 Seek(s64 offset, u32 mode = from_begin) override;
 	virtual u64 Tell() const override;
 
+	virtual u64 ReadAt(u64 offset, void* dst, u64 size) override;
+	virtual u64 WriteAt(u64 offset, const void* src, u64 size) override;
+	virtual bool IsPositional() const override;
+
 	virtual bool IsOpened() const override;
 	
 	virtual const fs::file& GetFile() const { return m_file; }
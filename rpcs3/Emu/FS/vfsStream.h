@@ -35,6 +35,31 @@ struct vfsStream
 
 	virtual u64 Tell() const = 0;
 
+	// positional read/write (doesn't change the stream position)
+	virtual u64 ReadAt(u64 offset, void* dst, u64 count)
+	{
+		const u64 old_position = Tell();
+		Seek(offset);
+		const u64 result = Read(dst, count);
+		Seek(old_position);
+		return result;
+	}
+
+	virtual u64 WriteAt(u64 offset, const void* src, u64 count)
+	{
+		const u64 old_position = Tell();
+		Seek(offset);
+		const u64 result = Write(src, count);
+		Seek(old_position);
+		return result;
+	}
+
+	// true if ReadAt/WriteAt may be called concurrently with other operations without external locking
+	virtual bool IsPositional() const
+	{
+		return false;
+	}
+
 	virtual bool Eof() const
 	{
 		return Tell() >= GetSize();
@@ -61,27 +61,15 @@ void vfsHDDManager::AppendEntry(vfsHDD_Entry entry)
 
 bool vfsHDDFile::goto_block(u64 n)
 {
-	vfsHDD_Block block_info;
+	const u64 block = find_block(n);
 
-	if (m_info.data_block >= m_hdd_info.block_count)
+	if (!block || block >= m_hdd_info.block_count)
 	{
 		return false;
 	}
 
-	m_hdd.Seek(m_info.data_block * m_hdd_info.block_size);
-	block_info.next_block = m_info.data_block;
-
-	for (u64 i = 0; i<n; ++i)
-	{
-		if (!block_info.next_block || !block_info.is_used || block_info.next_block >= m_hdd_info.block_count)
-		{
-			return false;
-		}
-
-		m_hdd.Seek(block_info.next_block * m_hdd_info.block_size);
-		m_hdd.Read(&block_info, sizeof(vfsHDD_Block));
-	}
-
+	m_cur_block = block;
+	m_cur_index = n;
 	return true;
 }
 
@@ -151,6 +139,7 @@ void vfsHDDFile::Open(u64 info_block)
 	ReadEntry(m_info_block, m_info);
 	m_position = 0;
 	m_cur_block = m_info.data_block;
+	m_cur_index = 0;
 }
 
 u64 vfsHDDFile::FindFreeBlock()
@@ -172,12 +161,26 @@ u64 vfsHDDFile::FindFreeBlock()
 
 bool vfsHDDFile::Seek(u64 pos)
 {
-	if (!goto_block(pos / m_hdd_info.block_size))
+	const u32 block_size = GetBlockDataSize();
+
+	if (!pos && !m_info.data_block)
+	{
+		// empty file, the first block is allocated by Write()
+		m_cur_block = 0;
+		m_cur_index = 0;
+		m_position = 0;
+		return true;
+	}
+
+	// the end of file at a block boundary is the end of the last block (Write() continues in a new block)
+	const u64 n = pos && pos == m_info.size && pos % block_size == 0 ? pos / block_size - 1 : pos / block_size;
+
+	if (!goto_block(n))
 	{
 		return false;
 	}
 
-	m_position = pos % m_hdd_info.block_size;
+	m_position = static_cast<u32>(pos - n * block_size);
 	return true;
 }
 
@@ -194,7 +197,7 @@ u64 vfsHDDFile::Read(void* dst, u64 size)
 
 	//vfsDeviceLocker lock(m_hdd);
 
-	const u32 block_size = m_hdd_info.block_size - sizeof(vfsHDD_Block);
+	const u32 block_size = GetBlockDataSize();
 	u64 rsize = std::min<u64>(block_size - m_position, size);
 
 	vfsHDD_Block cur_block_info;
@@ -219,6 +222,7 @@ u64 vfsHDDFile::Read(void* dst, u64 size)
 		}
 
 		m_cur_block = cur_block_info.next_block;
+		m_cur_index++;
 		rsize = std::min<u64>(block_size, size);
 
 		m_hdd.Seek(cur_block_info.next_block * m_hdd_info.block_size);
@@ -235,6 +239,104 @@ u64 vfsHDDFile::Read(void* dst, u64 size)
 	return offset;
 }
 
+u64 vfsHDDFile::find_block(u64 n) const
+{
+	vfsHDD_Block block_info;
+	u64 block = m_info.data_block;
+
+	// follow the chain without touching the position
+	for (; n; n--)
+	{
+		if (!block || block >= m_hdd_info.block_count || m_hdd.ReadAt(block * m_hdd_info.block_size, &block_info, sizeof(vfsHDD_Block)) != sizeof(vfsHDD_Block))
+		{
+			return 0;
+		}
+
+		block = block_info.is_used ? block_info.next_block : 0;
+	}
+
+	return block;
+}
+
+u64 vfsHDDFile::ReadAt(u64 offset, void* dst, u64 size)
+{
+	const u32 block_size = GetBlockDataSize();
+
+	if (offset >= m_info.size)
+	{
+		return 0;
+	}
+
+	size = std::min<u64>(size, m_info.size - offset);
+
+	vfsHDD_Block block_info;
+	u64 block = find_block(offset / block_size);
+
+	u64 position = offset % block_size;
+	u64 done = 0;
+
+	while (done < size)
+	{
+		if (!block || block >= m_hdd_info.block_count || m_hdd.ReadAt(block * m_hdd_info.block_size, &block_info, sizeof(vfsHDD_Block)) != sizeof(vfsHDD_Block))
+		{
+			break;
+		}
+
+		const u64 rsize = std::min<u64>(block_size - position, size - done);
+
+		if (m_hdd.ReadAt(block * m_hdd_info.block_size + sizeof(vfsHDD_Block) + position, (u8*)dst + done, rsize) != rsize)
+		{
+			break;
+		}
+
+		done += rsize;
+		position = 0;
+		block = block_info.is_used ? block_info.next_block : 0;
+	}
+
+	return done;
+}
+
+u64 vfsHDDFile::WriteAt(u64 offset, const void* src, u64 size)
+{
+	const u32 block_size = GetBlockDataSize();
+
+	// only overwrites existing data, the file isn't extended
+	if (offset >= m_info.size)
+	{
+		return 0;
+	}
+
+	size = std::min<u64>(size, m_info.size - offset);
+
+	vfsHDD_Block block_info;
+	u64 block = find_block(offset / block_size);
+
+	u64 position = offset % block_size;
+	u64 done = 0;
+
+	while (done < size)
+	{
+		if (!block || block >= m_hdd_info.block_count || m_hdd.ReadAt(block * m_hdd_info.block_size, &block_info, sizeof(vfsHDD_Block)) != sizeof(vfsHDD_Block))
+		{
+			break;
+		}
+
+		const u64 wsize = std::min<u64>(block_size - position, size - done);
+
+		if (m_hdd.WriteAt(block * m_hdd_info.block_size + sizeof(vfsHDD_Block) + position, (const u8*)src + done, wsize) != wsize)
+		{
+			break;
+		}
+
+		done += wsize;
+		position = 0;
+		block = block_info.is_used ? block_info.next_block : 0;
+	}
+
+	return done;
+}
+
 u64 vfsHDDFile::Write(const void* src, u64 size)
 {
 	if (!size)
@@ -242,7 +344,7 @@ u64 vfsHDDFile::Write(const void* src, u64 size)
 
 	//vfsDeviceLocker lock(m_hdd);
 
-	const u32 block_size = m_hdd_info.block_size - sizeof(vfsHDD_Block);
+	const u32 block_size = GetBlockDataSize();
 
 	if (!m_cur_block)
 	{
@@ -262,6 +364,7 @@ u64 vfsHDDFile::Write(const void* src, u64 size)
 		}
 
 		m_cur_block = m_info.data_block;
+		m_cur_index = 0;
 		m_position = 0;
 	}
 
@@ -299,6 +402,7 @@ u64 vfsHDDFile::Write(const void* src, u64 size)
 		}
 
 		m_cur_block = new_block;
+		m_cur_index++;
 		wsize = std::min<u64>(block_size, size);
 
 		block_info.next_block = m_cur_block;
@@ -764,6 +868,47 @@ u64 vfsHDD::Tell() const
 	return m_file.Tell(); // ???
 }
 
+u64 vfsHDD::ReadAt(u64 offset, void* dst, u64 size)
+{
+	return m_file.ReadAt(offset, dst, size);
+}
+
+u64 vfsHDD::WriteAt(u64 offset, const void* src, u64 size)
+{
+	const u64 file_size = m_file.GetSize();
+
+	if (offset + size <= file_size)
+	{
+		return m_file.WriteAt(offset, src, size);
+	}
+
+	if (offset > file_size)
+	{
+		LOG_ERROR(HLE, "vfsHDD::WriteAt(): writing past the end of file is not supported (offset=0x%llx, size=0x%llx)", offset, file_size);
+		return 0;
+	}
+
+	// overwrite existing data, then append the rest (appending requires block allocation)
+	const u64 done = m_file.WriteAt(offset, src, file_size - offset);
+
+	if (done != file_size - offset)
+	{
+		return done;
+	}
+
+	const u64 old_position = m_file.Tell();
+
+	if (!m_file.Seek(file_size))
+	{
+		return done;
+	}
+
+	const u64 appended = m_file.Write((const u8*)src + done, size - done);
+	m_file.Seek(old_position);
+
+	return done + appended;
+}
+
 bool vfsHDD::Eof() const
 {
 	return m_file.Eof();
@@ -61,11 +61,14 @@ class vfsHDDFile
 	vfsHDD_Entry m_info;
 	const vfsHDD_Hdr& m_hdd_info;
 	vfsLocalFile& m_hdd;
-	u32 m_position;
+	u32 m_position; // position in the current block
 	u64 m_cur_block;
+	u64 m_cur_index; // index of the current block in the chain
 
 	bool goto_block(u64 n);
 
+	u64 find_block(u64 n) const;
+
 	void RemoveBlocks(u64 start_block);
 
 	void WriteBlock(u64 block, const vfsHDD_Block& data);
@@ -87,6 +90,12 @@ class vfsHDDFile
 		return m_hdd_info.block_size - sizeof(vfsHDD_Entry);
 	}
 
+	// file data stored in a single block (file offsets are mapped to blocks with this size)
+	force_inline u32 GetBlockDataSize() const
+	{
+		return m_hdd_info.block_size - sizeof(vfsHDD_Block);
+	}
+
 public:
 	vfsHDDFile(vfsLocalFile& hdd, const vfsHDD_Hdr& hdd_info)
 		: m_hdd(hdd)
@@ -111,7 +120,7 @@ public:
 
 	u64 Tell() const
 	{
-		return m_cur_block * m_hdd_info.block_size + m_position; // ???
+		return m_cur_index * GetBlockDataSize() + m_position;
 	}
 
 	void SaveInfo();
@@ -120,9 +129,14 @@ public:
 
 	u64 Write(const void* src, u64 size);
 
+	// positional access within the allocated blocks (doesn't change the position)
+	u64 ReadAt(u64 offset, void* dst, u64 size);
+
+	u64 WriteAt(u64 offset, const void* src, u64 size);
+
 	bool Eof() const
 	{
-		return m_info.size <= (m_cur_block * m_hdd_info.block_size + m_position);
+		return m_info.size <= Tell();
 	}
 };
 
@@ -200,6 +214,10 @@ public:
 
 	virtual u64 Tell() const override;
 
+	virtual u64 ReadAt(u64 offset, void* dst, u64 count) override;
+
+	virtual u64 WriteAt(u64 offset, const void* src, u64 count) override;
+
 	virtual bool Eof() const override;
 
 	virtual bool IsOpened() const override;
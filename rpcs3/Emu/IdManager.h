@@ -1,5 +1,7 @@
 #pragma once
 
+#include <typeindex>
+
 #define ID_MANAGER_INCLUDED
 
 // ID type
@@ -57,32 +59,131 @@ public:
 	ID_data_t& operator =(ID_data_t&& other) = delete;
 };
 
+// lookup table entry (IDs are never reused until clear(), so every slot is used once)
+struct ID_slot_t
+{
+	std::atomic<u32> readers{ 0 }; // lookups in progress
+	std::atomic<const ID_data_t*> data{ nullptr }; // points to the element of m_id_map
+};
+
 class ID_manager
 {
+	static const u32 page_size = 4096; // slots per page
+	static const u32 page_count = 4096; // IDs above page_size * page_count are only available through m_id_map
+
+	// m_mutex protects m_id_map, counters and creation/removal of IDs, lookups by ID don't lock
 	std::mutex m_mutex;
 
 	std::unordered_map<u32, ID_data_t> m_id_map;
 	u32 m_cur_id = 1; // first ID
 
-public:
-	// check if ID exists and has specified type
-	template<typename T> bool check_id(u32 id)
+	std::array<std::atomic<ID_slot_t*>, page_count> m_pages{};
+
+	std::unordered_map<std::type_index, u32> m_counts; // number of IDs by type_info
+	std::unordered_map<u32, u32> m_type_counts; // number of IDs by ID type
+
+	// call func(const ID_data_t*) with the data of ID (or nullptr), the data can't be removed during the call
+	template<typename F> auto access(u32 id, F func) -> decltype(func(nullptr))
 	{
+		if (id / page_size < page_count)
+		{
+			const auto page = m_pages[id / page_size].load(std::memory_order_acquire);
+
+			if (!page)
+			{
+				return func(nullptr);
+			}
+
+			const struct reader_t
+			{
+				ID_slot_t& slot;
+
+				reader_t(ID_slot_t& slot) : slot(slot) { slot.readers++; }
+				~reader_t() { slot.readers--; }
+			}
+			reader(page[id % page_size]);
+
+			return func(reader.slot.data.load());
+		}
+
+		// slow path for IDs out of table bounds
 		std::lock_guard<std::mutex> lock(m_mutex);
 
-		auto f = m_id_map.find(id);
+		const auto f = m_id_map.find(id);
 
-		return f != m_id_map.end() && f->second.info == typeid(T);
+		return func(f == m_id_map.end() ? nullptr : &f->second);
 	}
 
-	// check if ID exists and has specified type
-	bool check_id(u32 id, u32 type)
+	// register new ID (m_mutex must be locked)
+	void insert(ID_data_t&& data)
 	{
-		std::lock_guard<std::mutex> lock(m_mutex);
+		const u32 id = data.id;
+
+		m_counts[data.info]++;
+		m_type_counts[data.type]++;
+
+		const auto& stored = m_id_map.emplace(id, std::move(data)).first->second;
+
+		if (id / page_size < page_count)
+		{
+			auto& page = m_pages[id / page_size];
+
+			if (!page.load(std::memory_order_relaxed))
+			{
+				page.store(new ID_slot_t[page_size], std::memory_order_release);
+			}
+
+			page.load(std::memory_order_relaxed)[id % page_size].data.store(&stored);
+		}
+	}
 
-		auto f = m_id_map.find(id);
+	// unregister ID (m_mutex must be locked), waits for lookups in progress
+	void erase(std::unordered_map<u32, ID_data_t>::iterator item)
+	{
+		if (item->first / page_size < page_count)
+		{
+			auto& slot = m_pages[item->first / page_size].load(std::memory_order_relaxed)[item->first % page_size];
+
+			slot.data.store(nullptr);
 
-		return f != m_id_map.end() && f->second.type == type;
+			while (slot.readers.load())
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		m_counts[item->second.info]--;
+		m_type_counts[item->second.type]--;
+
+		m_id_map.erase(item);
+	}
+
+public:
+	ID_manager() = default;
+
+	ID_manager(const ID_manager&) = delete;
+
+	~ID_manager()
+	{
+		clear();
+	}
+
+	// check if ID exists and has specified type
+	template<typename T> bool check_id(u32 id)
+	{
+		return access(id, [](const ID_data_t* data)
+		{
+			return data && data->info == typeid(T);
+		});
+	}
+
+	// check if ID exists and has specified type
+	bool check_id(u32 id, u32 type)
+	{
+		return access(id, [=](const ID_data_t* data)
+		{
+			return data && data->type == type;
+		});
 	}
 
 	// must be called from the constructor called through make() to get further ID of current object
@@ -102,11 +203,19 @@ public:
 		return m_cur_id;
 	}
 
+	// must not be called while other threads use IDs
 	void clear()
 	{
 		std::lock_guard<std::mutex> lock(m_mutex);
 
+		for (auto& page : m_pages)
+		{
+			delete[] page.exchange(nullptr);
+		}
+
 		m_id_map.clear();
+		m_counts.clear();
+		m_type_counts.clear();
 		m_cur_id = 1; // first ID
 	}
 
@@ -119,7 +228,7 @@ public:
 
 		auto ptr = std::make_shared<T>(std::forward<Args>(args)...);
 
-		m_id_map.emplace(m_cur_id, ID_data_t(ptr, type, m_cur_id));
+		insert(ID_data_t(ptr, type, m_cur_id));
 
 		return m_cur_id++, std::move(ptr);
 	}
@@ -131,7 +240,7 @@ public:
 
 		const u32 type = ID_type<T>::type;
 
-		m_id_map.emplace(m_cur_id, ID_data_t(std::make_shared<T>(std::forward<Args>(args)...), type, m_cur_id));
+		insert(ID_data_t(std::make_shared<T>(std::forward<Args>(args)...), type, m_cur_id));
 
 		return m_cur_id++;
 	}
@@ -139,16 +248,15 @@ public:
 	// load ID created with type Orig, optionally static_cast to T
 	template<typename T, typename Orig = T> auto get(u32 id) -> decltype(std::shared_ptr<T>(static_cast<T*>(std::declval<Orig*>())))
 	{
-		std::lock_guard<std::mutex> lock(m_mutex);
-
-		auto f = m_id_map.find(id);
-
-		if (f == m_id_map.end() || f->second.info != typeid(Orig))
+		return access(id, [](const ID_data_t* data) -> std::shared_ptr<T>
 		{
-			return nullptr;
-		}
+			if (!data || data->info != typeid(Orig))
+			{
+				return nullptr;
+			}
 
-		return std::static_pointer_cast<T>(f->second.data);
+			return std::static_pointer_cast<T>(data->data);
+		});
 	}
 
 	// load all IDs created with type Orig, optionally static_cast to T
@@ -182,7 +290,7 @@ public:
 			return false;
 		}
 
-		m_id_map.erase(item);
+		erase(item);
 
 		return true;
 	}
@@ -191,36 +299,18 @@ public:
 	{
 		std::lock_guard<std::mutex> lock(m_mutex);
 
-		u32 result = 0;
-
-		const std::size_t hash = typeid(T).hash_code();
-
-		for (auto& v : m_id_map)
-		{
-			if (v.second.hash == hash && v.second.info == typeid(T))
-			{
-				result++;
-			}
-		}
+		const auto found = m_counts.find(typeid(T));
 
-		return result;
+		return found == m_counts.end() ? 0 : found->second;
 	}
 
 	u32 get_count(u32 type)
 	{
 		std::lock_guard<std::mutex> lock(m_mutex);
 
-		u32 result = 0;
+		const auto found = m_type_counts.find(type);
 
-		for (auto& v : m_id_map)
-		{
-			if (v.second.type == type)
-			{
-				result++;
-			}
-		}
-
-		return result;
+		return found == m_type_counts.end() ? 0 : found->second;
 	}
 
 	// get sorted ID list
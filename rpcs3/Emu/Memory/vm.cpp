@@ -147,17 +147,23 @@ namespace vm
 
 	reservation_mutex_t g_reservation_mutex;
 
-	std::array<waiter_t, 1024> g_waiter_list;
+	// waiters are distributed between buckets by the page of their address (the waited range never crosses the page)
+	struct waiter_bucket_t
+	{
+		std::mutex mutex;
 
-	std::size_t g_waiter_max = 0; // min unused position
-	std::size_t g_waiter_nil = 0; // min search position
+		std::vector<waiter_t*> list;
+	};
 
-	std::mutex g_waiter_list_mutex;
+	std::array<waiter_bucket_t, 256> g_waiter_buckets;
 
-	waiter_t* _add_waiter(thread_t& thread, u32 addr, u32 size)
+	inline waiter_bucket_t& _get_waiter_bucket(u32 addr)
 	{
-		std::lock_guard<std::mutex> lock(g_waiter_list_mutex);
+		return g_waiter_buckets[(addr / 4096) % g_waiter_buckets.size()];
+	}
 
+	void _add_waiter(waiter_t& waiter, thread_t& thread, u32 addr, u32 size)
+	{
 		const u64 align = 0x80000000ull >> cntlz32(size);
 
 		if (!size || !addr || size > 4096 || size != align || addr & (align - 1))
@@ -165,49 +171,27 @@ namespace vm
 			throw EXCEPTION("Invalid arguments (addr=0x%x, size=0x%x)", addr, size);
 		}
 
-		thread.mutex.lock();
+		auto& bucket = _get_waiter_bucket(addr);
 
-		// look for empty position
-		for (; g_waiter_nil < g_waiter_max; g_waiter_nil++)
-		{
-			waiter_t& waiter = g_waiter_list[g_waiter_nil];
+		std::lock_guard<std::mutex> lock(bucket.mutex);
 
-			if (!waiter.thread)
-			{
-				// store next position for further addition
-				g_waiter_nil++;
+		bucket.list.emplace_back(waiter.reset(addr, size, thread));
 
-				return waiter.reset(addr, size, thread);
-			}
-		}
-
-		if (g_waiter_max >= g_waiter_list.size())
-		{
-			throw EXCEPTION("Waiter list limit broken (%lld)", g_waiter_max);
-		}
-
-		waiter_t& waiter = g_waiter_list[g_waiter_max++];
-
-		g_waiter_nil = g_waiter_max;
-		
-		return waiter.reset(addr, size, thread);
+		thread.mutex.lock();
 	}
 
-	void _remove_waiter(waiter_t* waiter)
+	void _remove_waiter(waiter_t* waiter, u32 addr)
 	{
-		std::lock_guard<std::mutex> lock(g_waiter_list_mutex);
+		auto& bucket = _get_waiter_bucket(addr);
 
-		// mark as deleted
-		waiter->thread = nullptr;
+		std::lock_guard<std::mutex> lock(bucket.mutex);
 
-		// amortize adding new element
-		g_waiter_nil = std::min<std::size_t>(g_waiter_nil, waiter - g_waiter_list.data());
+		// swap with the last element (order doesn't matter)
+		const auto found = std::find(bucket.list.begin(), bucket.list.end(), waiter);
 
-		// amortize polling
-		while (g_waiter_max && !g_waiter_list[g_waiter_max - 1].thread)
-		{
-			g_waiter_max--;
-		}
+		*found = bucket.list.back();
+
+		bucket.list.pop_back();
 	}
 
 	bool waiter_t::try_notify()
@@ -253,47 +237,47 @@ namespace vm
 	void waiter_lock_t::wait()
 	{
 		// if another thread successfully called pred(), it must be set to null
-		while (m_waiter->pred)
+		while (m_waiter.pred)
 		{
 			// if pred() called by another thread threw an exception, it'll be rethrown
-			if (m_waiter->pred())
+			if (m_waiter.pred())
 			{
 				return;
 			}
 
 			CHECK_EMU_STATUS;
 
-			m_waiter->thread->cv.wait(m_lock);
+			m_waiter.thread->cv.wait(m_lock);
 		}
 	}	
 
 	waiter_lock_t::~waiter_lock_t()
 	{
 		// reset some data to avoid excessive signaling
-		m_waiter->addr = 0;
-		m_waiter->mask = ~0;
-		m_waiter->pred = nullptr;
+		m_waiter.addr = 0;
+		m_waiter.mask = ~0;
+		m_waiter.pred = nullptr;
 
-		// unlock thread's mutex to avoid deadlock with g_waiter_list_mutex
+		// unlock thread's mutex to avoid deadlock with the bucket mutex
 		m_lock.unlock();
 
-		_remove_waiter(m_waiter);
+		_remove_waiter(&m_waiter, m_addr);
 	}
 
 	void _notify_at(u32 addr, u32 size)
 	{
-		std::lock_guard<std::mutex> lock(g_waiter_list_mutex);
+		auto& bucket = _get_waiter_bucket(addr);
+
+		std::lock_guard<std::mutex> lock(bucket.mutex);
 
 		const u32 mask = ~(size - 1);
 
-		for (std::size_t i = 0; i < g_waiter_max; i++)
+		for (const auto waiter : bucket.list)
 		{
-			waiter_t& waiter = g_waiter_list[i];
-
 			// check address range overlapping using masks generated from size (power of 2)
-			if (waiter.thread && ((waiter.addr ^ addr) & (mask & waiter.mask)) == 0)
+			if (((waiter->addr ^ addr) & (mask & waiter->mask)) == 0)
 			{
-				waiter.try_notify();
+				waiter->try_notify();
 			}
 		}
 	}
@@ -312,22 +296,23 @@ namespace vm
 
 	bool notify_all()
 	{
-		std::unique_lock<std::mutex> lock(g_waiter_list_mutex);
-
 		std::size_t waiters = 0;
 		std::size_t signaled = 0;
 
-		for (std::size_t i = 0; i < g_waiter_max; i++)
+		for (auto& bucket : g_waiter_buckets)
 		{
-			waiter_t& waiter = g_waiter_list[i];
+			std::lock_guard<std::mutex> lock(bucket.mutex);
 
-			if (waiter.thread && waiter.addr)
+			for (const auto waiter : bucket.list)
 			{
-				waiters++;
-
-				if (waiter.try_notify())
+				if (waiter->addr)
 				{
-					signaled++;
+					waiters++;
+
+					if (waiter->try_notify())
+					{
+						signaled++;
+					}
 				}
 			}
 		}
@@ -407,7 +392,7 @@ namespace vm
 
 	void reservation_acquire(void* data, u32 addr, u32 size)
 	{
-		std::lock_guard<reservation_mutex_t> lock(g_reservation_mutex);
+		std::unique_lock<reservation_mutex_t> lock(g_reservation_mutex);
 
 		const u64 align = 0x80000000ull >> cntlz32(size);
 
@@ -426,8 +411,12 @@ namespace vm
 		// silent unlocking to prevent priority boost for threads going to break reservation
 		//g_reservation_mutex.do_notify = false;
 
+		const u32 raddr = g_reservation_addr;
+		const u32 rsize = g_reservation_size;
+		const bool foreign = g_reservation_owner && g_reservation_owner != get_current_thread_ctrl();
+
 		// break the reservation
-		g_tls_did_break_reservation = g_reservation_owner && _reservation_break(g_reservation_addr);
+		g_tls_did_break_reservation = g_reservation_owner && _reservation_break(raddr);
 
 		// change memory protection to read-only
 		_reservation_set(addr);
@@ -441,7 +430,13 @@ namespace vm
 		g_reservation_owner = get_current_thread_ctrl();
 
 		// copy data
-		std::memcpy(data, get_ptr(addr), size);
+		copy(data, get_ptr(addr), size);
+
+		if (g_tls_did_break_reservation && foreign)
+		{
+			// notify waiters of the lost reservation (like reservation_break())
+			lock.unlock(), _notify_at(raddr, rsize);
+		}
 	}
 
 	bool reservation_update(u32 addr, const void* data, u32 size)
@@ -465,7 +460,7 @@ namespace vm
 		_reservation_set(addr, true);
 
 		// update memory using privileged access
-		std::memcpy(priv_ptr(addr), data, size);
+		copy(priv_ptr(addr), data, size);
 
 		// free the reservation and restore memory protection
 		_reservation_break(addr);
@@ -574,6 +569,65 @@ namespace vm
 		lock.unlock(), _notify_at(addr, size);
 	}
 
+	template<u32 Size> force_inline void _copy_fixed(__m128i* dst, const __m128i* src)
+	{
+		__m128i data[Size / 16];
+
+		for (u32 i = 0; i < Size / 16; i++)
+		{
+			data[i] = _mm_load_si128(src + i);
+		}
+
+		for (u32 i = 0; i < Size / 16; i++)
+		{
+			_mm_store_si128(dst + i, data[i]);
+		}
+	}
+
+	// minimal size of the copy using non-temporal stores (smaller copies are faster if the destination is cached)
+	const u32 g_copy_stream_min = 4096;
+
+	void copy(void* dst, const void* src, u32 size, bool stream)
+	{
+		if ((size | reinterpret_cast<std::uintptr_t>(dst) | reinterpret_cast<std::uintptr_t>(src)) % 16)
+		{
+			std::memcpy(dst, src, size);
+			return;
+		}
+
+		const auto _dst = static_cast<__m128i*>(dst);
+		const auto _src = static_cast<const __m128i*>(src);
+
+		switch (size)
+		{
+		case 16: return _copy_fixed<16>(_dst, _src);
+		case 32: return _copy_fixed<32>(_dst, _src);
+		case 64: return _copy_fixed<64>(_dst, _src);
+		case 128: return _copy_fixed<128>(_dst, _src);
+		}
+
+		if (stream && size >= g_copy_stream_min && size % 64 == 0)
+		{
+			for (u32 i = 0; i < size / 16; i += 4)
+			{
+				const __m128i data0 = _mm_load_si128(_src + i + 0);
+				const __m128i data1 = _mm_load_si128(_src + i + 1);
+				const __m128i data2 = _mm_load_si128(_src + i + 2);
+				const __m128i data3 = _mm_load_si128(_src + i + 3);
+				_mm_stream_si128(_dst + i + 0, data0);
+				_mm_stream_si128(_dst + i + 1, data1);
+				_mm_stream_si128(_dst + i + 2, data2);
+				_mm_stream_si128(_dst + i + 3, data3);
+			}
+
+			// make non-temporal stores visible to other threads
+			_mm_sfence();
+			return;
+		}
+
+		std::memcpy(dst, src, size);
+	}
+
 	void _page_map(u32 addr, u32 size, u8 flags)
 	{
 		assert(size && (size | addr) % 4096 == 0 && flags < page_allocated);
@@ -974,6 +1028,40 @@ namespace vm
 		return nullptr;
 	}
 
+	bool use_huge_pages(memory_location_t location)
+	{
+		const auto block = get(location);
+
+		if (!block)
+		{
+			return false;
+		}
+
+#ifdef MADV_HUGEPAGE
+		// only whole 2 MiB pages inside of the block can be backed by huge pages
+		const u32 start = ::align(block->addr, 0x200000);
+		const u32 end = (block->addr + block->size) & ~0x1fffff;
+
+		if (start >= end)
+		{
+			return false;
+		}
+
+		// guest memory is a shm_open() object, so /dev/shm must be mounted with huge=advise (or within_size, always)
+		if (madvise(get_ptr(start), end - start, MADV_HUGEPAGE) || madvise(priv_ptr(start), end - start, MADV_HUGEPAGE))
+		{
+			LOG_ERROR(MEMORY, "vm::use_huge_pages(): madvise() failed (location=%d, addr=0x%x, size=0x%x, errno=%d)", location, start, end - start, errno);
+			return false;
+		}
+
+		LOG_NOTICE(MEMORY, "Huge pages enabled (location=%d, addr=0x%x, size=0x%x)", location, start, end - start);
+		return true;
+#else
+		LOG_WARNING(MEMORY, "vm::use_huge_pages(): not supported on this platform");
+		return false;
+#endif
+	}
+
 	namespace ps3
 	{
 		void init()
@@ -62,26 +62,27 @@ namespace vm
 		bool try_notify();
 	};
 
-	// for internal use
-	waiter_t* _add_waiter(thread_t& thread, u32 addr, u32 size);
+	// for internal use (registers the waiter in the bucket of its address and locks thread's mutex)
+	void _add_waiter(waiter_t& waiter, thread_t& thread, u32 addr, u32 size);
 
 	class waiter_lock_t
 	{
-		waiter_t* m_waiter;
+		waiter_t m_waiter;
+		const u32 m_addr; // waiter.addr is reset after notification
 		std::unique_lock<std::mutex> m_lock;
 
 	public:
 		waiter_lock_t() = delete;
 
 		template<typename T> inline waiter_lock_t(T& thread, u32 addr, u32 size)
-			: m_waiter(_add_waiter(static_cast<thread_t&>(thread), addr, size))
-			, m_lock(thread.mutex, std::adopt_lock) // must be locked in _add_waiter
+			: m_addr(addr)
+			, m_lock((_add_waiter(m_waiter, static_cast<thread_t&>(thread), addr, size), thread.mutex), std::adopt_lock) // must be locked in _add_waiter
 		{
 		}
 
-		waiter_t* operator ->() const
+		waiter_t* operator ->()
 		{
-			return m_waiter;
+			return &m_waiter;
 		}
 
 		void wait();
@@ -140,6 +141,10 @@ namespace vm
 	// Perform atomic operation unconditionally
 	void reservation_op(u32 addr, u32 size, std::function<void()> proc);
 
+	// Copy memory for DMA transfers and reservations (16-byte aligned 16, 32, 64 and 128-byte copies use fixed SSE2 kernels, other copies use memcpy)
+	// If `stream` is set, large aligned copies use non-temporal stores (only faster if the destination is not in the cache and not read soon)
+	void copy(void* dst, const void* src, u32 size, bool stream = false);
+
 	// Change memory protection of specified memory region
 	bool page_protect(u32 addr, u32 size, u8 flags_test = 0, u8 flags_set = 0, u8 flags_clear = 0);
 
@@ -201,6 +206,11 @@ namespace vm
 
 	// get memory block associated with optionally specified memory location or optionally specified address
 	std::shared_ptr<block_t> get(memory_location_t location, u32 addr = 0);
+
+	// Advise the host to back the memory location with 2 MiB pages (transparent huge pages, Linux only), returns false if unsupported
+	// Page protection still works with 4 KiB granularity (the kernel splits the affected huge page mapping)
+	// Must be called before the memory is accessed: pages which are already mapped stay 4 KiB pages
+	bool use_huge_pages(memory_location_t location);
 	
 	template<typename T = void> T* get_ptr(u32 addr)
 	{
@@ -0,0 +1,185 @@
+#include "stdafx.h"
+#include "Utilities/Log.h"
+#include "Utilities/File.h"
+#include "Emu/Memory/Memory.h"
+#include "Emu/System.h"
+#include "Emu/Cell/PPUThread.h"
+#include "Emu/SysCalls/Modules.h"
+#include "Emu/SysCalls/SysCalls.h"
+#include "HLETrace.h"
+
+std::atomic<bool> g_hle_trace_enabled{ false };
+
+struct hle_trace_buffer_t
+{
+	std::mutex mutex;
+	std::vector<hle_trace_record_t> records;
+};
+
+std::mutex g_hle_trace_mutex; // protects the file and the buffer list
+std::unique_ptr<fs::file> g_hle_trace_file;
+std::string g_hle_trace_path;
+std::vector<std::shared_ptr<hle_trace_buffer_t>> g_hle_trace_buffers;
+std::chrono::steady_clock::time_point g_hle_trace_start;
+
+const u32 g_hle_trace_buffer_size = 0x10000 / sizeof(hle_trace_record_t);
+
+void hle_trace_flush(hle_trace_buffer_t& buffer)
+{
+	std::lock_guard<std::mutex> lock(g_hle_trace_mutex);
+
+	if (g_hle_trace_file && buffer.records.size())
+	{
+		g_hle_trace_file->write(buffer.records.data(), buffer.records.size() * sizeof(hle_trace_record_t));
+	}
+
+	buffer.records.clear();
+}
+
+struct hle_trace_buffer_owner_t
+{
+	std::shared_ptr<hle_trace_buffer_t> buffer;
+
+	~hle_trace_buffer_owner_t()
+	{
+		if (buffer)
+		{
+			std::lock_guard<std::mutex> lock(buffer->mutex);
+
+			hle_trace_flush(*buffer);
+		}
+	}
+};
+
+thread_local hle_trace_buffer_owner_t g_tls_hle_trace_buffer;
+
+void hle_trace_start(const std::string& path)
+{
+	std::lock_guard<std::mutex> lock(g_hle_trace_mutex);
+
+	g_hle_trace_file.reset(new fs::file(path, o_write | o_create | o_trunc));
+
+	if (!*g_hle_trace_file)
+	{
+		LOG_ERROR(HLE, "Failed to create HLE trace file (%s)", path);
+		g_hle_trace_file.reset();
+		return;
+	}
+
+	hle_trace_header_t header = {};
+	std::memcpy(header.magic, HLE_TRACE_MAGIC, sizeof(header.magic));
+	header.version = HLE_TRACE_VERSION;
+	header.record_size = sizeof(hle_trace_record_t);
+
+	g_hle_trace_file->write(&header, sizeof(header));
+	g_hle_trace_path = path;
+	g_hle_trace_start = std::chrono::steady_clock::now();
+	g_hle_trace_enabled = true;
+
+	LOG_NOTICE(HLE, "HLE trace started (%s)", path);
+}
+
+void hle_trace_stop()
+{
+	if (!g_hle_trace_enabled.exchange(false))
+	{
+		return;
+	}
+
+	std::vector<std::shared_ptr<hle_trace_buffer_t>> buffers;
+	{
+		std::lock_guard<std::mutex> lock(g_hle_trace_mutex);
+		buffers = std::move(g_hle_trace_buffers);
+	}
+
+	for (auto& buffer : buffers)
+	{
+		std::lock_guard<std::mutex> lock(buffer->mutex);
+
+		hle_trace_flush(*buffer);
+	}
+
+	std::lock_guard<std::mutex> lock(g_hle_trace_mutex);
+
+	g_hle_trace_file.reset();
+
+	// write names of all known functions and syscalls
+	fs::file names(g_hle_trace_path + ".names", o_write | o_create | o_trunc);
+
+	if (names)
+	{
+		std::string text;
+
+		for (u32 i = 0; i < 1024; i++)
+		{
+			text += fmt::format("0x%016llx %s\n", ~(u64)i, SysCalls::GetFuncName(~(u64)i));
+		}
+
+		for (u32 i = 0; const auto func = get_ppu_func_by_index(i); i++)
+		{
+			text += fmt::format("0x%016llx %s\n", (u64)func->id, SysCalls::GetFuncName(func->id));
+		}
+
+		names.write(text.data(), text.size());
+	}
+
+	LOG_NOTICE(HLE, "HLE trace stopped (%s)", g_hle_trace_path);
+}
+
+u64 hle_trace_time()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_hle_trace_start).count();
+}
+
+void hle_trace_push(const hle_trace_record_t& record)
+{
+	auto& buffer = g_tls_hle_trace_buffer.buffer;
+
+	if (!buffer)
+	{
+		buffer = std::make_shared<hle_trace_buffer_t>();
+		buffer->records.reserve(g_hle_trace_buffer_size);
+
+		std::lock_guard<std::mutex> lock(g_hle_trace_mutex);
+		g_hle_trace_buffers.emplace_back(buffer);
+	}
+
+	std::lock_guard<std::mutex> lock(buffer->mutex);
+
+	buffer->records.emplace_back(record);
+
+	if (buffer->records.size() >= g_hle_trace_buffer_size)
+	{
+		hle_trace_flush(*buffer);
+	}
+}
+
+hle_trace_scope_t::hle_trace_scope_t(PPUThread& CPU, u64 id, u32 caller)
+	: m_cpu(CPU)
+	, m_enabled(g_hle_trace_enabled.load(std::memory_order_relaxed))
+{
+	if (m_enabled)
+	{
+		m_record.id = id;
+		m_record.thread = CPU.get_id();
+		m_record.caller = caller;
+
+		for (u32 i = 0; i < 8; i++)
+		{
+			m_record.args[i] = CPU.GPR[3 + i];
+		}
+
+		m_record.start = hle_trace_time();
+	}
+}
+
+hle_trace_scope_t::~hle_trace_scope_t()
+{
+	if (m_enabled)
+	{
+		m_record.duration = hle_trace_time() - m_record.start;
+		m_record.result = m_cpu.GPR[3];
+
+		hle_trace_push(m_record);
+	}
+}
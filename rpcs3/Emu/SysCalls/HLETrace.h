@@ -0,0 +1,58 @@
+#pragma once
+
+// Binary trace of HLE function calls and syscalls (enabled by Ini.HLETrace)
+// The file starts with hle_trace_header_t followed by hle_trace_record_t entries.
+// Function names are written to a separate text file ("0x%016llx name" lines) when the trace is stopped.
+
+#define HLE_TRACE_MAGIC "RPCS3HTR"
+#define HLE_TRACE_VERSION 1
+
+struct hle_trace_header_t
+{
+	char magic[8];
+	u32 version;
+	u32 record_size;
+};
+
+struct hle_trace_record_t
+{
+	u64 id; // NID or inverted syscall number (same as PPUThread::hle_code)
+	u32 thread; // PPU thread id
+	u32 caller; // return address (syscall instruction address for syscalls)
+	u64 start; // nanoseconds since the trace started
+	u64 duration; // nanoseconds, including nested calls
+	u64 args[8]; // r3-r10
+	u64 result; // r3
+};
+
+static_assert(sizeof(hle_trace_header_t) == 16, "Invalid hle_trace_header_t size");
+static_assert(sizeof(hle_trace_record_t) == 104, "Invalid hle_trace_record_t size");
+
+class PPUThread;
+
+extern std::atomic<bool> g_hle_trace_enabled;
+
+// open the trace file and the names file (path + ".names")
+void hle_trace_start(const std::string& path);
+
+// flush all threads, write function names and close the trace (all PPU threads must be stopped)
+void hle_trace_stop();
+
+// get current trace timestamp
+u64 hle_trace_time();
+
+// write the record to the current thread's buffer
+void hle_trace_push(const hle_trace_record_t& record);
+
+// records a single call from the constructor to the destructor
+class hle_trace_scope_t final
+{
+	PPUThread& m_cpu;
+	const bool m_enabled;
+	hle_trace_record_t m_record;
+
+public:
+	hle_trace_scope_t(PPUThread& CPU, u64 id, u32 caller);
+
+	~hle_trace_scope_t();
+};
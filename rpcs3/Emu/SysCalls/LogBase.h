@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Utilities/Log.h"
+
 class LogBase
 {
 	bool m_logging;
@@ -14,11 +16,17 @@ class LogBase
 		LogTodo,
 	};
 
-	void LogOutput(LogType type, const std::string& text) const;
-
+	// formatting (including the module name prefix) is deferred to the log thread
 	template<typename... Args> never_inline void LogPrepare(LogType type, const char* fmt, Args... args) const
 	{
-		LogOutput(type, fmt::Format(fmt, args...));
+		switch (type)
+		{
+		case LogNotice: log_message_prefixed(HLE, Log::Severity::Notice, GetName(), ": ", fmt, args...); break;
+		case LogSuccess: log_message_prefixed(HLE, Log::Severity::Success, GetName(), ": ", fmt, args...); break;
+		case LogWarning: log_message_prefixed(HLE, Log::Severity::Warning, GetName(), ": ", fmt, args...); break;
+		case LogError: log_message_prefixed(HLE, Log::Severity::Error, GetName(), ": ", fmt, args...); break;
+		case LogTodo: log_message_prefixed(HLE, Log::Severity::Error, GetName(), " TODO: ", fmt, args...); break;
+		}
 	}
 
 public:
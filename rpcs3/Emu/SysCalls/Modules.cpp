@@ -8,9 +8,14 @@
 #include "Crypto/sha1.h"
 #include "ModuleManager.h"
 #include "Emu/Cell/PPUInstrTable.h"
+#include "HLETrace.h"
+#include "Emu/Cell/PPUScheduler.h"
+#include "Utilities/Thread.h"
+#include "Emu/CPU/CPUProfiler.h"
 
 std::vector<ModuleFunc> g_ppu_func_list;
 std::vector<StaticFunc> g_ppu_func_subs;
+std::unordered_map<u32, u32> g_ppu_func_index; // NID -> index in g_ppu_func_list
 
 u32 add_ppu_func(ModuleFunc func)
 {
@@ -18,19 +23,20 @@ u32 add_ppu_func(ModuleFunc func)
 	{
 		// prevent relocations if the array growths, must be sizeof(ModuleFunc) * 0x8000 ~~ about 1 MB of memory
 		g_ppu_func_list.reserve(0x8000);
+		g_ppu_func_index.reserve(0x8000);
 	}
 
-	for (auto& f : g_ppu_func_list)
+	const auto result = g_ppu_func_index.emplace(func.id, (u32)g_ppu_func_list.size());
+
+	if (!result.second)
 	{
-		if (f.id == func.id)
-		{
-			// if NIDs overlap or if the same function is added twice
-			throw EXCEPTION("NID already exists: 0x%08x (%s)", f.id, f.name);
-		}
+		// if NIDs overlap or if the same function is added twice
+		const auto& f = g_ppu_func_list[result.first->second];
+		throw EXCEPTION("NID already exists: 0x%08x (%s)", f.id, f.name);
 	}
 
 	g_ppu_func_list.push_back(func);
-	return (u32)g_ppu_func_list.size() - 1;
+	return result.first->second;
 }
 
 u32 add_ppu_func_sub(StaticFunc func)
@@ -52,20 +58,19 @@ u32 add_ppu_func_sub(const std::initializer_list<SearchPatternEntry>& ops, const
 
 ModuleFunc* get_ppu_func_by_nid(u32 nid, u32* out_index)
 {
-	for (auto& f : g_ppu_func_list)
+	const auto found = g_ppu_func_index.find(nid);
+
+	if (found == g_ppu_func_index.end())
 	{
-		if (f.id == nid)
-		{
-			if (out_index)
-			{
-				*out_index = (u32)(&f - g_ppu_func_list.data());
-			}
+		return nullptr;
+	}
 
-			return &f;
-		}
+	if (out_index)
+	{
+		*out_index = found->second;
 	}
 
-	return nullptr;
+	return &g_ppu_func_list[found->second];
 }
 
 ModuleFunc* get_ppu_func_by_index(u32 index)
@@ -134,6 +139,12 @@ void execute_ppu_func_by_index(PPUThread& CPU, u32 index)
 		// change current syscall/NID value
 		CPU.hle_code = func->id;
 
+		// record the call if the binary trace is enabled
+		hle_trace_scope_t trace(CPU, func->id, VM_CAST(CPU.LR));
+
+		// release the PPU scheduler run slot while executing HLE code
+		ppu_sched_hle_scope_t run_slot(CPU);
+
 		if (func->lle_func && !(func->flags & MFF_FORCED_HLE))
 		{
 			// call LLE function if available
@@ -198,6 +209,7 @@ void clear_ppu_functions()
 {
 	g_ppu_func_list.clear();
 	g_ppu_func_subs.clear();
+	g_ppu_func_index.clear();
 }
 
 u32 get_function_id(const char* name)
@@ -216,148 +228,243 @@ u32 get_function_id(const char* name)
 	return (u32&)output[0];
 }
 
-void hook_ppu_func(vm::ptr<u32> base, u32 pos, u32 size)
+// check whether the pattern matches at the position, the first instruction is passed separately because it may be already replaced
+bool match_ppu_func(const StaticFunc& sub, vm::ptr<u32> base, u32 pos, u32 size, be_t<u32> first)
 {
-	using namespace PPU_instr;
+	if (sub.ops.empty())
+	{
+		return false;
+	}
+
+	std::unordered_map<u32, u32> labels;
 
-	for (auto& sub : g_ppu_func_subs)
+	for (u32 k = pos, x = 0; x + 1 <= sub.ops.size(); k++, x++)
 	{
-		bool found = sub.ops.size() != 0;
+		if (k >= size)
+		{
+			return false;
+		}
 
-		for (u32 k = pos, x = 0; x + 1 <= sub.ops.size(); k++, x++)
+		const be_t<u32> op = k == pos ? first : base[k];
+
+		// skip NOP
+		if (op == 0x60000000)
 		{
-			if (k >= size)
+			x--;
+			continue;
+		}
+
+		const u32 data = sub.ops[x].data.data();
+		const u32 mask = sub.ops[x].mask.data();
+
+		const bool match = (op.data() & mask) == data;
+
+		switch (sub.ops[x].type)
+		{
+		case SPET_MASKED_OPCODE:
+		{
+			// masked pattern
+			if (!match)
 			{
-				found = false;
-				break;
+				return false;
 			}
 
-			// skip NOP
-			if (base[k] == 0x60000000)
+			break;
+		}
+		case SPET_OPTIONAL_MASKED_OPCODE:
+		{
+			// optional masked pattern
+			if (!match)
 			{
-				x--;
-				continue;
+				k--;
 			}
 
-			const u32 data = sub.ops[x].data.data();
-			const u32 mask = sub.ops[x].mask.data();
-
-			const bool match = (base[k].data() & mask) == data;
+			break;
+		}
+		case SPET_LABEL:
+		{
+			const auto addr = (base + k--).addr();
+			const auto lnum = data;
+			const auto label = labels.find(lnum);
 
-			switch (sub.ops[x].type)
-			{
-			case SPET_MASKED_OPCODE:
+			if (label == labels.end()) // register the label
 			{
-				// masked pattern
-				if (!match)
-				{
-					found = false;
-				}
-
-				break;
+				labels[lnum] = addr;
 			}
-			case SPET_OPTIONAL_MASKED_OPCODE:
+			else if (label->second != addr) // or check registered label
 			{
-				// optional masked pattern
-				if (!match)
-				{
-					k--;
-				}
-
-				break;
+				return false;
 			}
-			case SPET_LABEL:
+
+			break;
+		}
+		case SPET_BRANCH_TO_LABEL:
+		{
+			if (!match)
 			{
-				const auto addr = (base + k--).addr();
-				const auto lnum = data;
-				const auto label = sub.labels.find(lnum);
+				return false;
+			}
 
-				if (label == sub.labels.end()) // register the label
-				{
-					sub.labels[lnum] = addr;
-				}
-				else if (label->second != addr) // or check registered label
-				{
-					found = false;
-				}
+			const auto addr = (op & 2 ? 0 : (base + k).addr()) + ((s32)op << cntlz32(mask) >> (cntlz32(mask) + 2));
+			const auto lnum = sub.ops[x].num;
+			const auto label = labels.find(lnum);
 
-				break;
+			if (label == labels.end()) // register the label
+			{
+				labels[lnum] = addr;
 			}
-			case SPET_BRANCH_TO_LABEL:
+			else if (label->second != addr) // or check registered label
 			{
-				if (!match)
-				{
-					found = false;
-					break;
-				}
+				return false;
+			}
 
-				const auto addr = (base[k] & 2 ? 0 : (base + k).addr()) + ((s32)base[k] << cntlz32(mask) >> (cntlz32(mask) + 2));
-				const auto lnum = sub.ops[x].num;
-				const auto label = sub.labels.find(lnum);
+			break;
+		}
+		//case SPET_BRANCH_TO_FUNC:
+		//{
+		//	if (!match)
+		//	{
+		//		return false;
+		//	}
+
+		//	const auto addr = (op & 2 ? 0 : (base + k).addr()) + ((s32)op << cntlz32(mask) >> (cntlz32(mask) + 2));
+		//	const auto nid = sub.ops[x].num;
+		//	// TODO: recursive call
+		//}
+		default:
+		{
+			throw EXCEPTION("Unknown search pattern type (%d)", sub.ops[x].type);
+		}
+		}
+	}
 
-				if (label == sub.labels.end()) // register the label
-				{
-					sub.labels[lnum] = addr;
-				}
-				else if (label->second != addr) // or check registered label
-				{
-					found = false;
-				}
+	return true;
+}
 
-				break;
-			}
-			//case SPET_BRANCH_TO_FUNC:
-			//{
-			//	if (!match)
-			//	{
-			//		found = false;
-			//		break;
-			//	}
-
-			//	const auto addr = (base[k] & 2 ? 0 : (base + k).addr()) + ((s32)base[k] << cntlz32(mask) >> (cntlz32(mask) + 2));
-			//	const auto nid = sub.ops[x].num;
-			//	// TODO: recursive call
-			//}
-			default:
+// candidate patterns grouped by the first instruction
+struct ppu_func_sub_index_t
+{
+	// first opcode mask -> masked first opcode -> pattern indices
+	std::vector<std::pair<u32, std::unordered_map<u32, std::vector<u32>>>> masked;
+
+	// patterns which don't start with a mandatory opcode
+	std::vector<u32> other;
+
+	ppu_func_sub_index_t()
+	{
+		for (u32 i = 0; i < g_ppu_func_subs.size(); i++)
+		{
+			const auto& ops = g_ppu_func_subs[i].ops;
+
+			if (ops.empty())
 			{
-				throw EXCEPTION("Unknown search pattern type (%d)", sub.ops[x].type);
+				continue;
 			}
+
+			if (ops[0].type != SPET_MASKED_OPCODE && ops[0].type != SPET_BRANCH_TO_LABEL)
+			{
+				other.emplace_back(i);
+				continue;
 			}
 
-			if (!found)
+			const u32 mask = ops[0].mask.data();
+
+			auto found = std::find_if(masked.begin(), masked.end(), [=](const decltype(masked)::value_type& v) { return v.first == mask; });
+
+			if (found == masked.end())
 			{
-				break;
+				found = masked.emplace(masked.end(), mask, std::unordered_map<u32, std::vector<u32>>{});
 			}
-		}
 
-		if (found)
-		{
-			LOG_SUCCESS(LOADER, "Function '%s' hooked (addr=*0x%x)", sub.name, base + pos);
-			sub.found++;
-			base[pos] = HACK(sub.index | EIF_PERFORM_BLR);
+			found->second[ops[0].data.data()].emplace_back(i);
 		}
+	}
+
+	// get pattern indices (in registration order) which may match the instruction
+	void find(be_t<u32> op, std::vector<u32>& result) const
+	{
+		result = other;
 
-		if (sub.labels.size())
+		for (auto& m : masked)
 		{
-			sub.labels.clear();
+			const auto found = m.second.find(op.data() & m.first);
+
+			if (found != m.second.end())
+			{
+				result.insert(result.end(), found->second.begin(), found->second.end());
+			}
 		}
+
+		std::sort(result.begin(), result.end());
 	}
-}
+};
 
 void hook_ppu_funcs(vm::ptr<u32> base, u32 size)
 {
 	using namespace PPU_instr;
 
-	// TODO: optimize search
-	for (u32 i = 0; i < size; i++)
+	const ppu_func_sub_index_t index;
+
+	// search patterns in [start, end), only read the memory: found functions are patched later in the same order
+	auto scan = [&](u32 start, u32 end, std::vector<std::pair<u32, u32>>& hits)
 	{
-		// skip NOP
-		if (base[i] == 0x60000000)
+		std::vector<u32> candidates;
+
+		for (u32 i = start; i < end; i++)
 		{
-			continue;
+			be_t<u32> op = base[i];
+
+			// skip NOP
+			if (op == 0x60000000)
+			{
+				continue;
+			}
+
+			index.find(op, candidates);
+
+			for (u32 j : candidates)
+			{
+				if (match_ppu_func(g_ppu_func_subs[j], base, i, size, op))
+				{
+					hits.emplace_back(i, j);
+					op = HACK(g_ppu_func_subs[j].index | EIF_PERFORM_BLR);
+
+					// the instruction is replaced, the rest of patterns must see the new value
+					for (j++; j < g_ppu_func_subs.size(); j++)
+					{
+						if (match_ppu_func(g_ppu_func_subs[j], base, i, size, op))
+						{
+							hits.emplace_back(i, j);
+							op = HACK(g_ppu_func_subs[j].index | EIF_PERFORM_BLR);
+						}
+					}
+
+					break;
+				}
+			}
 		}
+	};
+
+	// scan in parts on the worker pool, hits are applied afterwards in address order
+	const u32 part = 0x10000;
 
-		hook_ppu_func(base, i, size);
+	std::vector<std::vector<std::pair<u32, u32>>> hits((size + part - 1) / part);
+
+	parallel_for(static_cast<u32>(hits.size()), [&](u32 i)
+	{
+		scan(i * part, std::min(i * part + part, size), hits[i]);
+	});
+
+	for (auto& part_hits : hits)
+	{
+		for (auto& hit : part_hits)
+		{
+			auto& sub = g_ppu_func_subs[hit.second];
+
+			LOG_SUCCESS(LOADER, "Function '%s' hooked (addr=*0x%x)", sub.name, base + hit.first);
+			sub.found++;
+			base[hit.first] = HACK(sub.index | EIF_PERFORM_BLR);
+		}
 	}
 
 	// check functions
@@ -365,7 +472,7 @@ void hook_ppu_funcs(vm::ptr<u32> base, u32 size)
 	{
 		if (g_ppu_func_subs[i].found > 1)
 		{
-			LOG_ERROR(LOADER, "Function '%s' hooked %u times", g_ppu_func_subs[i].found);
+			LOG_ERROR(LOADER, "Function '%s' hooked %u times", g_ppu_func_subs[i].name, g_ppu_func_subs[i].found);
 		}
 	}
 }
@@ -385,6 +492,14 @@ bool patch_ppu_import(u32 addr, u32 index)
 		? index | EIF_USE_BRANCH
 		: index | EIF_PERFORM_BLR;
 
+	// replace the first instruction, the stub is registered as the imported function's code for the profiler
+	const auto patch = [&](u32 op, u32 size)
+	{
+		vm::write32(addr, op);
+		cpu_profiler_add_function(addr, size, g_ppu_func_list[index].id);
+		return true;
+	};
+
 	// check different patterns:
 
 	if (vm::check_addr(addr, 32) &&
@@ -397,8 +512,7 @@ bool patch_ppu_import(u32 addr, u32 index)
 		data[6] == MTCTR(r0) &&
 		data[7] == BCTR())
 	{
-		vm::write32(addr, HACK(imm | EIF_SAVE_RTOC));
-		return true;
+		return patch(HACK(imm | EIF_SAVE_RTOC), 32);
 	}
 
 	if (vm::check_addr(addr, 12) &&
@@ -425,8 +539,7 @@ bool patch_ppu_import(u32 addr, u32 index)
 			sub[0xd] == MTLR(r0) &&
 			sub[0xe] == BLR())
 		{
-			vm::write32(addr, HACK(imm));
-			return true;
+			return patch(HACK(imm), 12);
 		}
 	}
 
@@ -448,8 +561,7 @@ bool patch_ppu_import(u32 addr, u32 index)
 		data[0xe] == MTLR(r0) &&
 		data[0xf] == BLR())
 	{
-		vm::write32(addr, HACK(imm));
-		return true;
+		return patch(HACK(imm), 64);
 	}
 
 	if (vm::check_addr(addr, 64) &&
@@ -469,8 +581,7 @@ bool patch_ppu_import(u32 addr, u32 index)
 		data[0xd] == MTLR(r0) &&
 		data[0xe] == BLR())
 	{
-		vm::write32(addr, HACK(imm));
-		return true;
+		return patch(HACK(imm), 60);
 	}
 
 	if (vm::check_addr(addr, 56) &&
@@ -489,8 +600,7 @@ bool patch_ppu_import(u32 addr, u32 index)
 		data[0xc] == LD(r2, r1, 0x28) &&
 		data[0xd] == BLR())
 	{
-		vm::write32(addr, HACK(imm));
-		return true;
+		return patch(HACK(imm), 56);
 	}
 
 	//vm::write32(addr, HACK(imm));
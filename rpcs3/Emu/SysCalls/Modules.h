@@ -73,7 +73,6 @@ struct StaticFunc
 	const char* name;
 	std::vector<SearchPatternEntry> ops;
 	u32 found;
-	std::unordered_map<u32, u32> labels;
 };
 
 class Module : public LogBase
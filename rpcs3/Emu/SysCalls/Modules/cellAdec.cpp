@@ -3,6 +3,7 @@
 #include "Emu/System.h"
 #include "Emu/IdManager.h"
 #include "Emu/SysCalls/Modules.h"
+#include "rpcs3/Ini.h"
 
 extern std::mutex g_mutex_avcodec_open2;
 
@@ -33,6 +34,9 @@ AudioDecoder::AudioDecoder(s32 type, u32 addr, u32 size, vm::ptr<CellAdecCbMsg>
 	, input_format(nullptr)
 	, ctx(nullptr)
 	, fmt(nullptr)
+	, io_buf(nullptr)
+	, use_packets(Ini.DECPacketFeed.GetValue())
+	, parser(nullptr)
 {
 	av_register_all();
 	avcodec_register_all();
@@ -68,6 +72,10 @@ AudioDecoder::AudioDecoder(s32 type, u32 addr, u32 size, vm::ptr<CellAdecCbMsg>
 	{
 		throw EXCEPTION("av_find_input_format() failed");
 	}
+	if (use_packets)
+	{
+		return;
+	}
 	fmt = avformat_alloc_context();
 	if (!fmt)
 	{
@@ -90,7 +98,16 @@ AudioDecoder::~AudioDecoder()
 		av_frame_unref(af.data);
 		av_frame_free(&af.data);
 	}
-	if (ctx)
+	if (parser)
+	{
+		av_parser_close(parser);
+	}
+	if (ctx && use_packets)
+	{
+		avcodec_close(ctx);
+		avcodec_free_context(&ctx);
+	}
+	else if (ctx)
 	{
 		avcodec_close(ctx);
 		avformat_close_input(&fmt);
@@ -211,6 +228,261 @@ next:
 	}
 }
 
+struct AdecFrameHolder : AdecFrame
+{
+	AdecFrameHolder()
+	{
+		data = av_frame_alloc();
+
+		if (!data)
+		{
+			throw EXCEPTION("av_frame_alloc() failed");
+		}
+	}
+
+	~AdecFrameHolder()
+	{
+		if (data)
+		{
+			av_frame_unref(data);
+			av_frame_free(&data);
+		}
+	}
+};
+
+void adecOutputFrame(AudioDecoder& adec, AdecFrame& frame)
+{
+	//u64 ts = av_frame_get_best_effort_timestamp(frame.data);
+	//if (ts != AV_NOPTS_VALUE)
+	//{
+	//	frame.pts = ts/* - adec.first_pts*/;
+	//	adec.last_pts = frame.pts;
+	//}
+	adec.last_pts += ((u64)frame.data->nb_samples) * 90000 / frame.data->sample_rate;
+	frame.pts = adec.last_pts;
+
+	s32 nbps = av_get_bytes_per_sample((AVSampleFormat)frame.data->format);
+	switch (frame.data->format)
+	{
+	case AV_SAMPLE_FMT_FLTP: break;
+	case AV_SAMPLE_FMT_S16P: break;
+	default:
+	{
+		throw EXCEPTION("Unsupported frame format(%d)", frame.data->format);
+	}
+	}
+	frame.auAddr = adec.task.au.addr;
+	frame.auSize = adec.task.au.size;
+	frame.userdata = adec.task.au.userdata;
+	frame.size = frame.data->nb_samples * frame.data->channels * nbps;
+
+	//LOG_NOTICE(HLE, "got audio frame (pts=0x%llx, nb_samples=%d, ch=%d, sample_rate=%d, nbps=%d)",
+		//frame.pts, frame.data->nb_samples, frame.data->channels, frame.data->sample_rate, nbps);
+
+	if (adec.frames.push(frame, &adec.is_closed))
+	{
+		frame.data = nullptr; // to prevent destruction
+		adec.cbFunc(*adec.adecCb, adec.id, CELL_ADEC_MSG_TYPE_PCMOUT, CELL_OK, adec.cbArg);
+	}
+}
+
+void adecDecodePacket(AudioDecoder& adec, AVPacket& pkt)
+{
+	while (true)
+	{
+		AdecFrameHolder frame;
+
+		int got_frame = 0;
+
+		const int decode = avcodec_decode_audio4(adec.ctx, frame.data, &got_frame, &pkt);
+
+		if (decode < 0)
+		{
+			cellAdec.Error("adecDecodePacket(): AU decoding error(0x%x)", decode);
+			break;
+		}
+
+		if (got_frame)
+		{
+			adecOutputFrame(adec, frame);
+		}
+
+		if (!pkt.data)
+		{
+			// draining: continue until all delayed frames are returned
+			if (!got_frame) break;
+			continue;
+		}
+
+		pkt.data += decode;
+		pkt.size -= decode;
+
+		if (pkt.size <= 0 || (!decode && !got_frame)) break;
+	}
+}
+
+void adecDecodePackets(AudioDecoder& adec, AdecTask& task)
+{
+	u32 addr = task.au.addr;
+	u32 size = task.au.size;
+
+	if (adecIsAtracX(adec.type) && adec.use_ats_headers)
+	{
+		if (size < 8)
+		{
+			throw EXCEPTION("ATS header not found (size=0x%x)", size);
+		}
+
+		const u8 code1 = vm::read8(addr + 2);
+		const u8 code2 = vm::read8(addr + 3);
+		adec.ch_cfg = (code1 >> 2) & 0x7;
+		adec.frame_size = ((((u32)code1 & 0x3) << 8) | (u32)code2) * 8 + 8;
+		adec.sample_rate = at3freq[code1 >> 5];
+
+		addr += 8;
+		size -= 8;
+	}
+
+	if (adec.just_started)
+	{
+		if (adec.ctx)
+		{
+			avcodec_flush_buffers(adec.ctx);
+		}
+		else
+		{
+			adec.ctx = avcodec_alloc_context3(adec.codec);
+			if (!adec.ctx)
+			{
+				throw EXCEPTION("avcodec_alloc_context3() failed");
+			}
+
+			if (adecIsAtracX(adec.type))
+			{
+				// parameters normally provided by the OMA header
+				static const u64 layouts[8] =
+				{
+					0,
+					AV_CH_LAYOUT_MONO,
+					AV_CH_LAYOUT_STEREO,
+					AV_CH_LAYOUT_SURROUND,
+					AV_CH_LAYOUT_4POINT0,
+					AV_CH_LAYOUT_5POINT1_BACK,
+					AV_CH_LAYOUT_6POINT1_BACK,
+					AV_CH_LAYOUT_7POINT1,
+				};
+
+				adec.ctx->channel_layout = layouts[adec.ch_cfg];
+				adec.ctx->channels = av_get_channel_layout_nb_channels(adec.ctx->channel_layout);
+				adec.ctx->sample_rate = adec.sample_rate;
+				adec.ctx->block_align = adec.frame_size;
+			}
+			else
+			{
+				adec.parser = av_parser_init(adec.codec->id);
+				if (!adec.parser)
+				{
+					throw EXCEPTION("av_parser_init() failed");
+				}
+			}
+
+			AVDictionary* opts = nullptr;
+			av_dict_set(&opts, "refcounted_frames", "1", 0);
+
+			int err;
+			{
+				std::lock_guard<std::mutex> lock(g_mutex_avcodec_open2);
+				// not multithread-safe (???)
+				err = avcodec_open2(adec.ctx, adec.codec, &opts);
+			}
+			if (err || opts)
+			{
+				throw EXCEPTION("avcodec_open2() failed (err=0x%x, opts=%d)", err, opts ? 1 : 0);
+			}
+		}
+
+		adec.just_started = false;
+		adec.just_finished = false;
+	}
+
+	if (adecIsAtracX(adec.type))
+	{
+		if (!adec.frame_size)
+		{
+			throw EXCEPTION("Invalid ATRAC3+ frame size");
+		}
+
+		adec.ctx->block_align = adec.frame_size;
+	}
+
+	// copy AU to the padded buffer
+	adec.packet_buf.resize(size + FF_INPUT_BUFFER_PADDING_SIZE);
+	memcpy(adec.packet_buf.data(), vm::get_ptr<void>(addr), size);
+	memset(adec.packet_buf.data() + size, 0, FF_INPUT_BUFFER_PADDING_SIZE);
+
+	u8* data = adec.packet_buf.data();
+
+	while (size && !Emu.IsStopped() && !adec.is_closed)
+	{
+		AVPacket pkt;
+		av_init_packet(&pkt);
+
+		if (adec.parser)
+		{
+			// split MP3 frames
+			const int read = av_parser_parse2(adec.parser, adec.ctx, &pkt.data, &pkt.size, data, size, AV_NOPTS_VALUE, AV_NOPTS_VALUE, 0);
+
+			data += read;
+			size -= read;
+
+			if (!pkt.size)
+			{
+				if (!read) break;
+				continue;
+			}
+		}
+		else
+		{
+			// ATRAC3+ frames have fixed size
+			pkt.data = data;
+			pkt.size = std::min(size, adec.frame_size);
+
+			data += pkt.size;
+			size -= pkt.size;
+		}
+
+		adecDecodePacket(adec, pkt);
+	}
+}
+
+void adecDrain(AudioDecoder& adec)
+{
+	if (!adec.ctx)
+	{
+		return;
+	}
+
+	AVPacket pkt;
+	av_init_packet(&pkt);
+
+	// flush the parser (returns the last frame held back waiting for the next sync word)
+	if (adec.parser)
+	{
+		av_parser_parse2(adec.parser, adec.ctx, &pkt.data, &pkt.size, nullptr, 0, AV_NOPTS_VALUE, AV_NOPTS_VALUE, 0);
+
+		if (pkt.size)
+		{
+			adecDecodePacket(adec, pkt);
+		}
+	}
+
+	// return frames delayed by the decoder
+	pkt.data = nullptr;
+	pkt.size = 0;
+
+	adecDecodePacket(adec, pkt);
+}
+
 void adecOpen(u32 adec_id) // TODO: call from the constructor
 {
 	const auto sptr = Emu.GetIdManager().get<AudioDecoder>(adec_id);
@@ -266,6 +538,12 @@ void adecOpen(u32 adec_id) // TODO: call from the constructor
 			{
 				// TODO: finalize
 				cellAdec.Warning("adecEndSeq:");
+
+				if (adec.use_packets)
+				{
+					adecDrain(adec);
+				}
+
 				adec.cbFunc(CPU, adec.id, CELL_ADEC_MSG_TYPE_SEQDONE, CELL_OK, adec.cbArg);
 
 				adec.just_finished = true;
@@ -288,6 +566,14 @@ void adecOpen(u32 adec_id) // TODO: call from the constructor
 					if (adecIsAtracX(adec.type)) adec.last_pts -= 0x10000; // hack
 				}
 
+				if (adec.use_packets)
+				{
+					adecDecodePackets(adec, task);
+
+					adec.cbFunc(CPU, adec.id, CELL_ADEC_MSG_TYPE_AUDONE, task.au.auInfo_addr, adec.cbArg);
+					break;
+				}
+
 				struct AVPacketHolder : AVPacket
 				{
 					AVPacketHolder(u32 size)
@@ -374,28 +660,7 @@ void adecOpen(u32 adec_id) // TODO: call from the constructor
 						au.size = 0;
 					}
 
-					struct AdecFrameHolder : AdecFrame
-					{
-						AdecFrameHolder()
-						{
-							data = av_frame_alloc();
-						}
-
-						~AdecFrameHolder()
-						{
-							if (data)
-							{
-								av_frame_unref(data);
-								av_frame_free(&data);
-							}
-						}
-
-					} frame;
-
-					if (!frame.data)
-					{
-						throw EXCEPTION("av_frame_alloc() failed");
-					}
+					AdecFrameHolder frame;
 
 					int got_frame = 0;
 
@@ -412,38 +677,7 @@ void adecOpen(u32 adec_id) // TODO: call from the constructor
 
 					if (got_frame)
 					{
-						//u64 ts = av_frame_get_best_effort_timestamp(frame.data);
-						//if (ts != AV_NOPTS_VALUE)
-						//{
-						//	frame.pts = ts/* - adec.first_pts*/;
-						//	adec.last_pts = frame.pts;
-						//}
-						adec.last_pts += ((u64)frame.data->nb_samples) * 90000 / frame.data->sample_rate;
-						frame.pts = adec.last_pts;
-
-						s32 nbps = av_get_bytes_per_sample((AVSampleFormat)frame.data->format);
-						switch (frame.data->format)
-						{
-						case AV_SAMPLE_FMT_FLTP: break;
-						case AV_SAMPLE_FMT_S16P: break;
-						default:
-						{
-							throw EXCEPTION("Unsupported frame format(%d)", frame.data->format);
-						}
-						}
-						frame.auAddr = task.au.addr;
-						frame.auSize = task.au.size;
-						frame.userdata = task.au.userdata;
-						frame.size = frame.data->nb_samples * frame.data->channels * nbps;
-
-						//LOG_NOTICE(HLE, "got audio frame (pts=0x%llx, nb_samples=%d, ch=%d, sample_rate=%d, nbps=%d)",
-							//frame.pts, frame.data->nb_samples, frame.data->channels, frame.data->sample_rate, nbps);
-
-						if (adec.frames.push(frame, &adec.is_closed))
-						{
-							frame.data = nullptr; // to prevent destruction
-							adec.cbFunc(CPU, adec.id, CELL_ADEC_MSG_TYPE_PCMOUT, CELL_OK, adec.cbArg);
-						}
+						adecOutputFrame(adec, frame);
 					}
 				}
 
@@ -366,12 +366,12 @@ s32 cellAudioInit()
 
 				// send aftermix event (normal audio event)
 
-				LV2_LOCK;
-
 				for (auto key : g_audio.keys)
 				{
 					if (const auto queue = Emu.GetEventManager().GetEventQueue(key))
 					{
+						lv2_lock_t lv2_lock(queue->sync);
+
 						queue->push(lv2_lock, 0, 0, 0, 0); // TODO: check arguments
 					}
 				}
@@ -9,74 +9,52 @@
 
 extern Module cellDmux;
 
-PesHeader::PesHeader(DemuxerStream& stream)
-	: pts(CODEC_TS_INVALID)
-	, dts(CODEC_TS_INVALID)
-	, size(0)
-	, has_ts(false)
-	, is_ok(false)
+// demuxer thread state used by the packet parser
+struct dmux_handler_t
 {
-	u16 header;
-	if (!stream.get(header))
-	{
-		throw EXCEPTION("End of stream (header)");
-	}
-	if (!stream.get(size))
+	PPUThread& CPU;
+	Demuxer& dmux;
+	ElementaryStream** esAVC;
+	ElementaryStream** esATX;
+	u32 cb_add;
+
+	ElementaryStream* get_avc(u32 ch)
 	{
-		throw EXCEPTION("End of stream (size)");
+		return esAVC[ch];
 	}
-	if (!stream.check(size))
+
+	ElementaryStream* get_atx(u32 ch)
 	{
-		throw EXCEPTION("End of stream (size=%d)", size);
+		return esATX[ch];
 	}
-	
-	u8 pos = 0;
-	while (pos++ < size)
+
+	// publish the AU and send AU_FOUND message
+	void au_found(ElementaryStream& es, u64 userdata)
 	{
-		u8 v;
-		if (!stream.get(v))
-		{
-			return; // should never occur
-		}
+		es.push_au(es.last_dts, es.last_pts, userdata, false /* TODO: set correct value */, 0);
 
-		if (v == 0xff) // skip padding bytes
-		{
-			continue;
-		}
+		// callback
+		auto esMsg = vm::ptr<CellDmuxEsMsg>::make(dmux.memAddr + (cb_add ^= 16));
+		esMsg->msgType = CELL_DMUX_ES_MSG_TYPE_AU_FOUND;
+		esMsg->supplementalInfo = userdata;
+		es.cbFunc(CPU, dmux.id, es.id, esMsg, es.cbArg);
+	}
 
-		if ((v & 0xf0) == 0x20 && (size - pos) >= 4) // pts only
-		{
-			pos += 4;
-			pts = stream.get_ts(v);
-			has_ts = true;
-		}
-		else if ((v & 0xf0) == 0x30 && (size - pos) >= 9) // pts and dts
-		{
-			pos += 5;
-			pts = stream.get_ts(v);
-			stream.get(v);
-			has_ts = true;
+	template<typename... Args> void notice(const char* fmt, Args... args)
+	{
+		cellDmux.Notice(fmt, args...);
+	}
 
-			if ((v & 0xf0) != 0x10)
-			{
-				cellDmux.Error("PesHeader(): dts not found (v=0x%x, size=%d, pos=%d)", v, size, pos - 1);
-				stream.skip(size - pos);
-				return;
-			}
-			pos += 4;
-			dts = stream.get_ts(v);
-		}
-		else
-		{
-			cellDmux.Warning("PesHeader(): unknown code (v=0x%x, size=%d, pos=%d)", v, size, pos - 1);
-			stream.skip(size - pos);
-			pos = size;
-			break;
-		}
+	template<typename... Args> void warning(const char* fmt, Args... args)
+	{
+		cellDmux.Warning(fmt, args...);
 	}
 
-	is_ok = true;
-}
+	template<typename... Args> void error(const char* fmt, Args... args)
+	{
+		cellDmux.Error(fmt, args...);
+	}
+};
 
 ElementaryStream::ElementaryStream(Demuxer* dmux, u32 addr, u32 size, u32 fidMajor, u32 fidMinor, u32 sup1, u32 sup2, vm::ptr<CellDmuxCbEsMsg> cbFunc, u32 cbArg, u32 spec)
 	: dmux(dmux)
@@ -94,7 +72,7 @@ ElementaryStream::ElementaryStream(Demuxer* dmux, u32 addr, u32 size, u32 fidMaj
 	, put_count(0)
 	, got_count(0)
 	, released(0)
-	, raw_pos(0)
+	, raw_size(0)
 	, last_dts(CODEC_TS_INVALID)
 	, last_pts(CODEC_TS_INVALID)
 {
@@ -140,20 +118,14 @@ bool ElementaryStream::isfull(u32 space)
 	return is_full(space);
 }
 
-void ElementaryStream::push_au(u32 size, u64 dts, u64 pts, u64 userdata, bool rap, u32 specific)
+void ElementaryStream::push_au(u64 dts, u64 pts, u64 userdata, bool rap, u32 specific)
 {
 	u32 addr;
 	{
 		std::lock_guard<std::mutex> lock(m_mutex);
-		assert(!is_full(size));
-
-		if (put + size + 128 > memAddr + memSize)
-		{
-			put = memAddr;
-		}
 
-		memcpy(vm::get_ptr<void>(put + 128), raw_data.data(), size);
-		raw_data.erase(raw_data.begin(), raw_data.begin() + size);
+		// AU data has already been written in place by push()
+		const u32 size = raw_size;
 
 		auto info = vm::ptr<CellDmuxAuInfoEx>::make(put);
 		info->auAddr = put + 128;
@@ -182,6 +154,7 @@ void ElementaryStream::push_au(u32 size, u64 dts, u64 pts, u64 userdata, bool ra
 		addr = put;
 
 		put = align(put + 128 + size, 128);
+		raw_size = 0;
 
 		put_count++;
 	}
@@ -191,15 +164,29 @@ void ElementaryStream::push_au(u32 size, u64 dts, u64 pts, u64 userdata, bool ra
 	}
 }
 
-void ElementaryStream::push(DemuxerStream& stream, u32 size)
+bool ElementaryStream::push(DemuxerStream& stream, u32 size)
 {
-	auto const old_size = raw_data.size();
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	const u32 new_size = raw_size + size;
+
+	if (is_full(new_size))
+	{
+		return false;
+	}
 
-	raw_data.resize(old_size + size);
+	if (put + new_size + 128 > memAddr + memSize)
+	{
+		// move the AU being assembled to the beginning of the buffer (is_full() checked that this space is free)
+		memmove(vm::get_ptr<void>(memAddr + 128), vm::get_ptr<void>(put + 128), raw_size);
+		put = memAddr;
+	}
 
-	memcpy(raw_data.data() + old_size, vm::get_ptr<void>(stream.addr), size); // append bytes
+	memcpy(vm::get_ptr<void>(put + 128 + raw_size), vm::get_ptr<void>(stream.addr), size); // append bytes directly to the ES buffer
+	raw_size = new_size;
 
 	stream.skip(size);
+	return true;
 }
 
 bool ElementaryStream::release()
@@ -270,8 +257,7 @@ void ElementaryStream::reset()
 	put_count = 0;
 	got_count = 0;
 	released = 0;
-	raw_data.clear();
-	raw_pos = 0;
+	raw_size = 0;
 }
 
 void dmuxQueryAttr(u32 info_addr /* may be 0 */, vm::ptr<CellDmuxAttr> attr)
@@ -319,7 +305,8 @@ void dmuxOpen(u32 dmux_id) // TODO: call from the constructor
 		ElementaryStream** esAC3 = &esALL[64]; // AC3 (max 16)
 		ElementaryStream** esPCM = &esALL[80]; // LPCM (max 16)
 
-		u32 cb_add = 0;
+		dmux_handler_t handler{ CPU, dmux, esAVC, esATX, 0 };
+		dmux_parser_t<DemuxerStream, ElementaryStream, dmux_handler_t> parser(handler);
 
 		while (true)
 		{
@@ -332,7 +319,16 @@ void dmuxOpen(u32 dmux_id) // TODO: call from the constructor
 			{
 				// default task (demuxing) (if there is no other work)
 				be_t<u32> code;
-				be_t<u16> len;
+
+				if (parser.atx_data.size)
+				{
+					if (!parser.push_atx())
+					{
+						std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
+					}
+
+					continue;
+				}
 
 				if (!stream.peek(code)) 
 				{
@@ -340,7 +336,7 @@ void dmuxOpen(u32 dmux_id) // TODO: call from the constructor
 					dmux.is_running = false;
 
 					// callback
-					auto dmuxMsg = vm::ptr<CellDmuxMsg>::make(dmux.memAddr + (cb_add ^= 16));
+					auto dmuxMsg = vm::ptr<CellDmuxMsg>::make(dmux.memAddr + (handler.cb_add ^= 16));
 					dmuxMsg->msgType = CELL_DMUX_MSG_TYPE_DEMUX_DONE;
 					dmuxMsg->supplementalInfo = stream.userdata;
 					dmux.cbFunc(CPU, dmux.id, dmuxMsg, dmux.cbArg);
@@ -351,249 +347,10 @@ void dmuxOpen(u32 dmux_id) // TODO: call from the constructor
 					
 					continue;
 				}
-				
-				switch (code.value())
-				{
-				case PACK_START_CODE:
-				{
-					if (!stream.check(14))
-					{
-						throw EXCEPTION("End of stream (PACK_START_CODE)");
-					}
-					stream.skip(14);
-					break;
-				}
-
-				case SYSTEM_HEADER_START_CODE:
-				{
-					if (!stream.check(18))
-					{
-						throw EXCEPTION("End of stream (SYSTEM_HEADER_START_CODE)");
-					}
-					stream.skip(18);
-					break;
-				}
-
-				case PADDING_STREAM:
-				{
-					if (!stream.check(6))
-					{
-						throw EXCEPTION("End of stream (PADDING_STREAM)");
-					}
-					stream.skip(4);
-					stream.get(len);
-
-					if (!stream.check(len))
-					{
-						throw EXCEPTION("End of stream (PADDING_STREAM, len=%d)", len);
-					}
-					stream.skip(len);
-					break;
-				}
-
-				case PRIVATE_STREAM_2:
-				{
-					if (!stream.check(6))
-					{
-						throw EXCEPTION("End of stream (PRIVATE_STREAM_2)");
-					}
-					stream.skip(4);
-					stream.get(len);
-
-					cellDmux.Notice("PRIVATE_STREAM_2 (%d)", len);
-
-					if (!stream.check(len))
-					{
-						throw EXCEPTION("End of stream (PRIVATE_STREAM_2, len=%d)", len);
-					}
-					stream.skip(len);
-					break;
-				}
-
-				case PRIVATE_STREAM_1:
-				{
-					// audio and user data stream
-					DemuxerStream backup = stream;
-
-					if (!stream.check(6))
-					{
-						throw EXCEPTION("End of stream (PRIVATE_STREAM_1)");
-					}
-					stream.skip(4);
-					stream.get(len);
-
-					if (!stream.check(len))
-					{
-						throw EXCEPTION("End of stream (PRIVATE_STREAM_1, len=%d)", len);
-					}
-
-					const PesHeader pes(stream);
-					if (!pes.is_ok)
-					{
-						throw EXCEPTION("PesHeader error (PRIVATE_STREAM_1, len=%d)", len);
-					}
-
-					if (len < pes.size + 4)
-					{
-						throw EXCEPTION("End of block (PRIVATE_STREAM_1, PesHeader + fid_minor, len=%d)", len);
-					}
-					len -= pes.size + 4;
-					
-					u8 fid_minor;
-					if (!stream.get(fid_minor))
-					{
-						throw EXCEPTION("End of stream (PRIVATE_STREAM1, fid_minor)");
-					}
-
-					const u32 ch = fid_minor % 16;
-					if ((fid_minor & -0x10) == 0 && esATX[ch])
-					{
-						ElementaryStream& es = *esATX[ch];
-						if (es.raw_data.size() > 1024 * 1024)
-						{
-							stream = backup;
-							std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
-							continue;
-						}
-
-						if (len < 3 || !stream.check(3))
-						{
-							throw EXCEPTION("End of block (ATX, unknown header, len=%d)", len);
-						}
-						len -= 3;
-						stream.skip(3);
-
-						if (pes.has_ts)
-						{
-							es.last_dts = pes.dts;
-							es.last_pts = pes.pts;
-						}
-
-						es.push(stream, len);
-
-						while (true)
-						{
-							auto const size = es.raw_data.size() - es.raw_pos; // size of available new data
-							auto const data = es.raw_data.data() + es.raw_pos; // pointer to available data
-
-							if (size < 8) break; // skip if cannot read ATS header
-
-							if (data[0] != 0x0f || data[1] != 0xd0)
-							{
-								throw EXCEPTION("ATX: 0x0fd0 header not found (ats=0x%llx)", *(be_t<u64>*)data);
-							}
-
-							u32 frame_size = ((((u32)data[2] & 0x3) << 8) | (u32)data[3]) * 8 + 8;
-
-							if (size < frame_size + 8) break; // skip non-complete AU
-
-							if (es.isfull(frame_size + 8)) break; // skip if cannot push AU
-							
-							es.push_au(frame_size + 8, es.last_dts, es.last_pts, stream.userdata, false /* TODO: set correct value */, 0);
-
-							//cellDmux.Notice("ATX AU pushed (ats=0x%llx, frame_size=%d)", *(be_t<u64>*)data, frame_size);
-
-							auto esMsg = vm::ptr<CellDmuxEsMsg>::make(dmux.memAddr + (cb_add ^= 16));
-							esMsg->msgType = CELL_DMUX_ES_MSG_TYPE_AU_FOUND;
-							esMsg->supplementalInfo = stream.userdata;
-							es.cbFunc(CPU, dmux.id, es.id, esMsg, es.cbArg);
-						}
-					}
-					else
-					{
-						cellDmux.Notice("PRIVATE_STREAM_1 (len=%d, fid_minor=0x%x)", len, fid_minor);
-						stream.skip(len);
-					}
-					break;
-				}
 
-				case 0x1e0: case 0x1e1: case 0x1e2: case 0x1e3:
-				case 0x1e4: case 0x1e5: case 0x1e6: case 0x1e7:
-				case 0x1e8: case 0x1e9: case 0x1ea: case 0x1eb:
-				case 0x1ec: case 0x1ed: case 0x1ee: case 0x1ef:
+				if (!parser.parse_packet(stream))
 				{
-					// video stream (AVC or M2V)
-					DemuxerStream backup = stream;
-
-					if (!stream.check(6))
-					{
-						throw EXCEPTION("End of stream (video, code=0x%x)", code);
-					}
-					stream.skip(4);
-					stream.get(len);
-
-					if (!stream.check(len))
-					{
-						throw EXCEPTION("End of stream (video, code=0x%x, len=%d)", code, len);
-					}
-
-					const PesHeader pes(stream);
-					if (!pes.is_ok)
-					{
-						throw EXCEPTION("PesHeader error (video, code=0x%x, len=%d)", code, len);
-					}
-
-					if (len < pes.size + 3)
-					{
-						throw EXCEPTION("End of block (video, code=0x%x, PesHeader)", code);
-					}
-					len -= pes.size + 3;
-
-					const u32 ch = code % 16;
-					if (esAVC[ch])
-					{
-						ElementaryStream& es = *esAVC[ch];
-
-						const u32 old_size = (u32)es.raw_data.size();
-						if (es.isfull(old_size))
-						{
-							stream = backup;
-							std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
-							continue;
-						}
-
-						if ((pes.has_ts && old_size) || old_size >= 0x69800)
-						{
-							// push AU if it becomes too big or the next packet contains PTS/DTS
-							es.push_au(old_size, es.last_dts, es.last_pts, stream.userdata, false /* TODO: set correct value */, 0);
-
-							// callback
-							auto esMsg = vm::ptr<CellDmuxEsMsg>::make(dmux.memAddr + (cb_add ^= 16));
-							esMsg->msgType = CELL_DMUX_ES_MSG_TYPE_AU_FOUND;
-							esMsg->supplementalInfo = stream.userdata;
-							es.cbFunc(CPU, dmux.id, es.id, esMsg, es.cbArg);
-						}
-						
-						if (pes.has_ts)
-						{
-							// preserve dts/pts for next AU
-							es.last_dts = pes.dts;
-							es.last_pts = pes.pts;
-						}
-
-						// reconstruction of MPEG2-PS stream for vdec module
-						const u32 size = len + pes.size + 9;
-						stream = backup;
-						es.push(stream, size);
-					}
-					else
-					{
-						cellDmux.Notice("Video stream (code=0x%x, len=%d)", code, len);
-						stream.skip(len);
-					}
-					break;
-				}
-
-				default:
-				{
-					if ((code & PACKET_START_CODE_MASK) == PACKET_START_CODE_PREFIX)
-					{
-						throw EXCEPTION("Unknown code found (0x%x)", code);
-					}
-
-					// search
-					stream.skip(1);
-				}
+					std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
 				}
 
 				continue;
@@ -619,6 +376,8 @@ void dmuxOpen(u32 dmux_id) // TODO: call from the constructor
 							esALL[i]->reset();
 						}
 					}
+
+					parser.atx_data = {};
 				}
 
 				stream = task.stream;
@@ -634,12 +393,13 @@ void dmuxOpen(u32 dmux_id) // TODO: call from the constructor
 				if (dmux.is_running.exchange(false))
 				{
 					// callback
-					auto dmuxMsg = vm::ptr<CellDmuxMsg>::make(dmux.memAddr + (cb_add ^= 16));
+					auto dmuxMsg = vm::ptr<CellDmuxMsg>::make(dmux.memAddr + (handler.cb_add ^= 16));
 					dmuxMsg->msgType = CELL_DMUX_MSG_TYPE_DEMUX_DONE;
 					dmuxMsg->supplementalInfo = stream.userdata;
 					dmux.cbFunc(CPU, dmux.id, dmuxMsg, dmux.cbArg);
 
 					stream = {};
+					parser.atx_data = {};
 
 					dmux.is_working = false;
 				}
@@ -699,6 +459,12 @@ void dmuxOpen(u32 dmux_id) // TODO: call from the constructor
 						esALL[i] = nullptr;
 					}
 				}
+				if (parser.atx_es == &es)
+				{
+					parser.atx_es = nullptr;
+					parser.atx_data = {};
+				}
+
 				es.dmux = nullptr;
 				Emu.GetIdManager().remove<ElementaryStream>(task.es.es);
 				break;
@@ -708,33 +474,19 @@ void dmuxOpen(u32 dmux_id) // TODO: call from the constructor
 			{
 				ElementaryStream& es = *task.es.es_ptr;
 
-				const u32 old_size = (u32)es.raw_data.size();
-				if (old_size && (es.fidMajor & -0x10) == 0xe0)
+				if (es.raw_size && (es.fidMajor & -0x10) == 0xe0)
 				{
 					// TODO (it's only for AVC, some ATX data may be lost)
-					while (es.isfull(old_size))
-					{
-						if (Emu.IsStopped() || dmux.is_closed) break;
-
-						std::this_thread::sleep_for(std::chrono::milliseconds(1)); // hack
-					}
-
-					es.push_au(old_size, es.last_dts, es.last_pts, stream.userdata, false, 0);
-
-					// callback
-					auto esMsg = vm::ptr<CellDmuxEsMsg>::make(dmux.memAddr + (cb_add ^= 16));
-					esMsg->msgType = CELL_DMUX_ES_MSG_TYPE_AU_FOUND;
-					esMsg->supplementalInfo = stream.userdata;
-					es.cbFunc(CPU, dmux.id, es.id, esMsg, es.cbArg);
+					handler.au_found(es, stream.userdata);
 				}
 				
-				if (es.raw_data.size())
+				if (es.raw_size)
 				{
-					cellDmux.Error("dmuxFlushEs: 0x%x bytes lost (es_id=%d)", (u32)es.raw_data.size(), es.id);
+					cellDmux.Error("dmuxFlushEs: 0x%x bytes lost (es_id=%d)", es.raw_size, es.id);
 				}
 
 				// callback
-				auto esMsg = vm::ptr<CellDmuxEsMsg>::make(dmux.memAddr + (cb_add ^= 16));
+				auto esMsg = vm::ptr<CellDmuxEsMsg>::make(dmux.memAddr + (handler.cb_add ^= 16));
 				esMsg->msgType = CELL_DMUX_ES_MSG_TYPE_FLUSH_DONE;
 				esMsg->supplementalInfo = stream.userdata;
 				es.cbFunc(CPU, dmux.id, es.id, esMsg, es.cbArg);
@@ -743,6 +495,11 @@ void dmuxOpen(u32 dmux_id) // TODO: call from the constructor
 
 			case dmuxResetEs:
 			{
+				if (parser.atx_es == task.es.es_ptr)
+				{
+					parser.atx_data = {};
+				}
+
 				task.es.es_ptr->reset();
 				break;
 			}
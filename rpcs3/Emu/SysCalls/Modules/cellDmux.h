@@ -1,5 +1,7 @@
 #pragma once
 
+#include "cellDmuxPes.h"
+
 namespace vm { using namespace ps3; }
 
 // Error Codes
@@ -278,20 +280,6 @@ struct CellDmuxAuInfoEx
 
 /* Demuxer Thread Classes */
 
-enum
-{
-	/* http://dvd.sourceforge.net/dvdinfo/mpeghdrs.html */
-
-	PACKET_START_CODE_MASK   = 0xffffff00,
-	PACKET_START_CODE_PREFIX = 0x00000100,
-
-	PACK_START_CODE          = 0x000001ba,
-	SYSTEM_HEADER_START_CODE = 0x000001bb,
-	PRIVATE_STREAM_1         = 0x000001bd,
-	PADDING_STREAM           = 0x000001be,
-	PRIVATE_STREAM_2         = 0x000001bf,
-};
-
 struct DemuxerStream
 {
 	u32 addr;
@@ -331,28 +319,12 @@ struct DemuxerStream
 		return count <= size;
 	}
 
-	u64 get_ts(u8 c)
+	const u8* data() const
 	{
-		u8 v[4]; get((u32&)v); 
-		return
-			(((u64)c & 0x0e) << 29) | 
-			(((u64)v[0]) << 21) |
-			(((u64)v[1] & 0x7e) << 15) |
-			(((u64)v[2]) << 7) | ((u64)v[3] >> 1);
+		return vm::get_ptr<u8>(addr);
 	}
 };
 
-struct PesHeader
-{
-	u64 pts;
-	u64 dts;
-	u8 size;
-	bool has_ts;
-	bool is_ok;
-
-	PesHeader(DemuxerStream& stream);
-};
-
 class ElementaryStream;
 
 enum DemuxerJobType
@@ -451,16 +423,20 @@ public:
 	const u32 cbArg;
 	const u32 spec; //addr
 
-	std::vector<u8> raw_data; // demultiplexed data stream (managed by demuxer thread)
-	size_t raw_pos; // should be <= raw_data.size()
+	u32 raw_size; // size of the AU being assembled in place at put + 128 (managed by demuxer thread)
 	u64 last_dts;
 	u64 last_pts;
 
-	void push(DemuxerStream& stream, u32 size); // called by demuxer thread (not multithread-safe)
+	u8* raw_data() const // AU being assembled (valid until the next push)
+	{
+		return vm::get_ptr<u8>(put + 128);
+	}
+
+	bool push(DemuxerStream& stream, u32 size); // append data to the AU being assembled, returns false if the buffer is full (called by demuxer thread)
 
 	bool isfull(u32 space);
 
-	void push_au(u32 size, u64 dts, u64 pts, u64 userdata, bool rap, u32 specific);
+	void push_au(u64 dts, u64 pts, u64 userdata, bool rap, u32 specific); // publish the AU being assembled
 
 	bool release();
 
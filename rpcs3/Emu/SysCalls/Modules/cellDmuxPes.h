@@ -0,0 +1,406 @@
+#pragma once
+
+// MPEG-PS parsing without emulator dependencies (shared by cellDmux and dmux_bench)
+
+// decode 33-bit timestamp (first byte is the marker byte)
+inline u64 dmux_get_ts(u8 c, const u8* v)
+{
+	return
+		(((u64)c & 0x0e) << 29) |
+		(((u64)v[0]) << 21) |
+		(((u64)v[1] & 0x7e) << 15) |
+		(((u64)v[2]) << 7) | ((u64)v[3] >> 1);
+}
+
+// find the first 00 00 01 sequence (returns size if not found)
+inline u32 dmux_find_start_code(const u8* data, u32 size)
+{
+	u32 pos = 0;
+
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i one = _mm_set1_epi8(1);
+
+	for (; pos + 18 <= size; pos += 16)
+	{
+		const __m128i b0 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + pos)), zero);
+		const __m128i b1 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + pos + 1)), zero);
+		const __m128i b2 = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(data + pos + 2)), one);
+
+		if (const u32 mask = _mm_movemask_epi8(_mm_and_si128(_mm_and_si128(b0, b1), b2)))
+		{
+			return pos + cnttz32(mask);
+		}
+	}
+
+	for (; pos + 3 <= size; pos++)
+	{
+		if (data[pos] == 0 && data[pos + 1] == 0 && data[pos + 2] == 1)
+		{
+			return pos;
+		}
+	}
+
+	return size;
+}
+
+enum
+{
+	/* http://dvd.sourceforge.net/dvdinfo/mpeghdrs.html */
+
+	PACKET_START_CODE_MASK   = 0xffffff00,
+	PACKET_START_CODE_PREFIX = 0x00000100,
+
+	PACK_START_CODE          = 0x000001ba,
+	SYSTEM_HEADER_START_CODE = 0x000001bb,
+	PRIVATE_STREAM_1         = 0x000001bd,
+	PADDING_STREAM           = 0x000001be,
+	PRIVATE_STREAM_2         = 0x000001bf,
+};
+
+const u64 DMUX_TS_INVALID = 0xffffffffffffffffull;
+
+struct dmux_pes_t
+{
+	u64 pts;
+	u64 dts;
+	u8 size;
+	bool has_ts;
+	bool is_ok;
+};
+
+// MPEG-PS (PAMF) packet parser (used by the demuxer thread and by dmux_bench)
+// Stream: get(T&), peek(T&), skip(), check(), size, userdata, data() (host pointer to the current position)
+// ES: raw_size, last_dts, last_pts, raw_data(), push(Stream&, size) (appends to the AU being assembled, returns false if the buffer is full)
+// Handler: get_avc(ch), get_atx(ch) (enabled ES or nullptr), au_found(ES&, userdata) (publishes the assembled AU), notice(), warning(), error()
+template<typename Stream, typename ES, typename Handler> class dmux_parser_t
+{
+	Handler& m_handler;
+
+public:
+	// ATRAC3+ payload not yet copied to the ES buffer because it was full
+	ES* atx_es = nullptr;
+	Stream atx_data = {};
+
+	dmux_parser_t(Handler& handler)
+		: m_handler(handler)
+	{
+	}
+
+	// parse PES header directly from the stream buffer
+	dmux_pes_t parse_pes(Stream& stream)
+	{
+		dmux_pes_t pes{ DMUX_TS_INVALID, DMUX_TS_INVALID, 0, false, false };
+
+		u16 header;
+		if (!stream.get(header))
+		{
+			throw EXCEPTION("End of stream (header)");
+		}
+		if (!stream.get(pes.size))
+		{
+			throw EXCEPTION("End of stream (size)");
+		}
+		if (!stream.check(pes.size))
+		{
+			throw EXCEPTION("End of stream (size=%d)", pes.size);
+		}
+
+		const u8* const data = stream.data();
+		const u32 size = pes.size;
+		stream.skip(size);
+
+		u32 pos = 0;
+		while (pos < size)
+		{
+			const u8 v = data[pos++];
+
+			if (v == 0xff) // skip padding bytes
+			{
+				continue;
+			}
+
+			if ((v & 0xf0) == 0x20 && (size - pos) >= 4) // pts only
+			{
+				pes.pts = dmux_get_ts(v, data + pos);
+				pos += 4;
+				pes.has_ts = true;
+			}
+			else if ((v & 0xf0) == 0x30 && (size - pos) >= 9) // pts and dts
+			{
+				pes.pts = dmux_get_ts(v, data + pos);
+				pos += 4;
+				pes.has_ts = true;
+
+				const u8 v2 = data[pos++];
+
+				if ((v2 & 0xf0) != 0x10)
+				{
+					m_handler.error("PesHeader(): dts not found (v=0x%x, size=%d, pos=%d)", v2, size, pos - 1);
+					return pes;
+				}
+
+				pes.dts = dmux_get_ts(v2, data + pos);
+				pos += 4;
+			}
+			else
+			{
+				m_handler.warning("PesHeader(): unknown code (v=0x%x, size=%d, pos=%d)", v, size, pos - 1);
+				break;
+			}
+		}
+
+		pes.is_ok = true;
+		return pes;
+	}
+
+	// split ATRAC3+ payload into AUs, returns false if the ES buffer is full
+	bool push_atx()
+	{
+		ES& es = *atx_es;
+
+		while (atx_data.size)
+		{
+			// complete ATS header first, then the frame it describes
+			u32 size = 8 - std::min<u32>(es.raw_size, 8);
+			u32 frame_size = 0;
+
+			if (!size)
+			{
+				const u8* const data = es.raw_data();
+
+				if (data[0] != 0x0f || data[1] != 0xd0)
+				{
+					throw EXCEPTION("ATX: 0x0fd0 header not found (ats=0x%llx)", *(be_t<u64>*)data);
+				}
+
+				frame_size = ((((u32)data[2] & 0x3) << 8) | (u32)data[3]) * 8 + 8;
+				size = frame_size + 8 - es.raw_size;
+			}
+
+			if (!es.push(atx_data, std::min(size, atx_data.size)))
+			{
+				return false;
+			}
+
+			if (frame_size && es.raw_size == frame_size + 8)
+			{
+				m_handler.au_found(es, atx_data.userdata);
+			}
+		}
+
+		return true;
+	}
+
+	// demux the packet at the current stream position (at least 4 bytes available)
+	// returns false if the ES buffer is full, the stream is left at the beginning of the packet in this case
+	bool parse_packet(Stream& stream)
+	{
+		be_t<u32> code;
+		be_t<u16> len;
+
+		stream.peek(code);
+
+		switch (code.value())
+		{
+		case PACK_START_CODE:
+		{
+			if (!stream.check(14))
+			{
+				throw EXCEPTION("End of stream (PACK_START_CODE)");
+			}
+			stream.skip(14);
+			break;
+		}
+
+		case SYSTEM_HEADER_START_CODE:
+		{
+			if (!stream.check(18))
+			{
+				throw EXCEPTION("End of stream (SYSTEM_HEADER_START_CODE)");
+			}
+			stream.skip(18);
+			break;
+		}
+
+		case PADDING_STREAM:
+		{
+			if (!stream.check(6))
+			{
+				throw EXCEPTION("End of stream (PADDING_STREAM)");
+			}
+			stream.skip(4);
+			stream.get(len);
+
+			if (!stream.check(len))
+			{
+				throw EXCEPTION("End of stream (PADDING_STREAM, len=%d)", len);
+			}
+			stream.skip(len);
+			break;
+		}
+
+		case PRIVATE_STREAM_2:
+		{
+			if (!stream.check(6))
+			{
+				throw EXCEPTION("End of stream (PRIVATE_STREAM_2)");
+			}
+			stream.skip(4);
+			stream.get(len);
+
+			m_handler.notice("PRIVATE_STREAM_2 (%d)", len);
+
+			if (!stream.check(len))
+			{
+				throw EXCEPTION("End of stream (PRIVATE_STREAM_2, len=%d)", len);
+			}
+			stream.skip(len);
+			break;
+		}
+
+		case PRIVATE_STREAM_1:
+		{
+			// audio and user data stream
+			if (!stream.check(6))
+			{
+				throw EXCEPTION("End of stream (PRIVATE_STREAM_1)");
+			}
+			stream.skip(4);
+			stream.get(len);
+
+			if (!stream.check(len))
+			{
+				throw EXCEPTION("End of stream (PRIVATE_STREAM_1, len=%d)", len);
+			}
+
+			const dmux_pes_t pes = parse_pes(stream);
+			if (!pes.is_ok)
+			{
+				throw EXCEPTION("PesHeader error (PRIVATE_STREAM_1, len=%d)", len);
+			}
+
+			if (len < pes.size + 4)
+			{
+				throw EXCEPTION("End of block (PRIVATE_STREAM_1, PesHeader + fid_minor, len=%d)", len);
+			}
+			len -= pes.size + 4;
+
+			u8 fid_minor;
+			if (!stream.get(fid_minor))
+			{
+				throw EXCEPTION("End of stream (PRIVATE_STREAM1, fid_minor)");
+			}
+
+			const u32 ch = fid_minor % 16;
+			ES* const es = (fid_minor & -0x10) == 0 ? m_handler.get_atx(ch) : nullptr;
+
+			if (es)
+			{
+				if (len < 3 || !stream.check(3))
+				{
+					throw EXCEPTION("End of block (ATX, unknown header, len=%d)", len);
+				}
+				len -= 3;
+				stream.skip(3);
+
+				if (pes.has_ts)
+				{
+					es->last_dts = pes.dts;
+					es->last_pts = pes.pts;
+				}
+
+				// payload is copied to the ES buffer directly from the stream (continued later if the buffer is full)
+				atx_es = es;
+				atx_data = stream;
+				atx_data.size = len;
+				stream.skip(len);
+
+				push_atx();
+			}
+			else
+			{
+				m_handler.notice("PRIVATE_STREAM_1 (len=%d, fid_minor=0x%x)", len, fid_minor);
+				stream.skip(len);
+			}
+			break;
+		}
+
+		case 0x1e0: case 0x1e1: case 0x1e2: case 0x1e3:
+		case 0x1e4: case 0x1e5: case 0x1e6: case 0x1e7:
+		case 0x1e8: case 0x1e9: case 0x1ea: case 0x1eb:
+		case 0x1ec: case 0x1ed: case 0x1ee: case 0x1ef:
+		{
+			// video stream (AVC or M2V)
+			const Stream backup = stream;
+
+			if (!stream.check(6))
+			{
+				throw EXCEPTION("End of stream (video, code=0x%x)", code);
+			}
+			stream.skip(4);
+			stream.get(len);
+
+			if (!stream.check(len))
+			{
+				throw EXCEPTION("End of stream (video, code=0x%x, len=%d)", code, len);
+			}
+
+			const dmux_pes_t pes = parse_pes(stream);
+			if (!pes.is_ok)
+			{
+				throw EXCEPTION("PesHeader error (video, code=0x%x, len=%d)", code, len);
+			}
+
+			if (len < pes.size + 3)
+			{
+				throw EXCEPTION("End of block (video, code=0x%x, PesHeader)", code);
+			}
+			len -= pes.size + 3;
+
+			if (ES* const es = m_handler.get_avc(code % 16))
+			{
+				if ((pes.has_ts && es->raw_size) || es->raw_size >= 0x69800)
+				{
+					// push AU if it becomes too big or the next packet contains PTS/DTS
+					m_handler.au_found(*es, stream.userdata);
+				}
+
+				if (pes.has_ts)
+				{
+					// preserve dts/pts for next AU
+					es->last_dts = pes.dts;
+					es->last_pts = pes.pts;
+				}
+
+				// reconstruction of MPEG2-PS stream for vdec module
+				const u32 size = len + pes.size + 9;
+				stream = backup;
+
+				if (!es->push(stream, size))
+				{
+					return false;
+				}
+			}
+			else
+			{
+				m_handler.notice("Video stream (code=0x%x, len=%d)", code, len);
+				stream.skip(len);
+			}
+			break;
+		}
+
+		default:
+		{
+			if ((code & PACKET_START_CODE_MASK) == PACKET_START_CODE_PREFIX)
+			{
+				throw EXCEPTION("Unknown code found (0x%x)", code);
+			}
+
+			// search for the next start code
+			stream.skip(std::max<u32>(dmux_find_start_code(stream.data(), stream.size), 1));
+		}
+		}
+
+		return true;
+	}
+};
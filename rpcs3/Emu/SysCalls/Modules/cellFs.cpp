@@ -8,6 +8,7 @@
 #include "Emu/FS/VFS.h"
 #include "Emu/FS/vfsFile.h"
 #include "Emu/FS/vfsDir.h"
+#include "Emu/FS/vfsDevice.h"
 
 #include "Emu/SysCalls/lv2/sys_fs.h"
 #include "cellFs.h"
@@ -250,6 +251,50 @@ s32 cellFsGetDirectoryEntries(u32 fd, vm::ptr<CellFsDirectoryEntry> entries, u32
 	return CELL_OK;
 }
 
+// positional read/write, the file is locked only if the stream can't do it concurrently
+// returns CELL_FS_EIO if the host read/write failed (result is set to 0)
+s32 fsReadAt(lv2_file_t& file, u64 offset, void* dst, u64 size, u64& result)
+{
+	std::unique_lock<std::mutex> lock(file.mutex, std::defer_lock);
+
+	if (!file.file->IsPositional())
+	{
+		lock.lock();
+	}
+
+	result = file.file->ReadAt(offset, dst, size);
+
+	if (result == static_cast<u64>(-1))
+	{
+		cellFs.Error("fsReadAt(): read failed (offset=0x%llx, size=0x%llx)", offset, size);
+		result = 0;
+		return CELL_FS_EIO;
+	}
+
+	return CELL_OK;
+}
+
+s32 fsWriteAt(lv2_file_t& file, u64 offset, const void* src, u64 size, u64& result)
+{
+	std::unique_lock<std::mutex> lock(file.mutex, std::defer_lock);
+
+	if (!file.file->IsPositional())
+	{
+		lock.lock();
+	}
+
+	result = file.file->WriteAt(offset, src, size);
+
+	if (result == static_cast<u64>(-1))
+	{
+		cellFs.Error("fsWriteAt(): write failed (offset=0x%llx, size=0x%llx)", offset, size);
+		result = 0;
+		return CELL_FS_EIO;
+	}
+
+	return CELL_OK;
+}
+
 s32 cellFsReadWithOffset(u32 fd, u64 offset, vm::ptr<void> buf, u64 buffer_size, vm::ptr<u64> nread)
 {
 	cellFs.Log("cellFsReadWithOffset(fd=%d, offset=0x%llx, buf=*0x%x, buffer_size=0x%llx, nread=*0x%x)", fd, offset, buf, buffer_size, nread);
@@ -263,22 +308,16 @@ s32 cellFsReadWithOffset(u32 fd, u64 offset, vm::ptr<void> buf, u64 buffer_size,
 		return CELL_FS_EBADF;
 	}
 
-	std::lock_guard<std::mutex> lock(file->mutex);
-
-	const auto old_position = file->file->Tell();
-
-	file->file->Seek(offset);
+	u64 read;
 
-	const auto read = file->file->Read(buf.get_ptr(), buffer_size);
-
-	file->file->Seek(old_position);
+	const s32 error = fsReadAt(*file, offset, buf.get_ptr(), buffer_size, read);
 
 	if (nread)
 	{
 		*nread = read;
 	}
 
-	return CELL_OK;
+	return error;
 }
 
 s32 cellFsWriteWithOffset(u32 fd, u64 offset, vm::cptr<void> buf, u64 data_size, vm::ptr<u64> nwrite)
@@ -294,22 +333,16 @@ s32 cellFsWriteWithOffset(u32 fd, u64 offset, vm::cptr<void> buf, u64 data_size,
 		return CELL_FS_EBADF;
 	}
 
-	std::lock_guard<std::mutex> lock(file->mutex);
-
-	const auto old_position = file->file->Tell();
-
-	file->file->Seek(offset);
+	u64 written;
 
-	const auto written = file->file->Write(buf.get_ptr(), data_size);
-
-	file->file->Seek(old_position);
+	const s32 error = fsWriteAt(*file, offset, buf.get_ptr(), data_size, written);
 
 	if (nwrite)
 	{
 		*nwrite = written;
 	}
 
-	return CELL_OK;
+	return error;
 }
 
 s32 cellFsStReadInit(u32 fd, vm::cptr<CellFsRingBuffer> ringbuf)
@@ -508,11 +541,28 @@ s32 cellFsStReadStart(u32 fd, u64 offset, u64 size)
 				// get buffer position
 				const u32 position = VM_CAST(file->st_buffer + file->st_total_read % file->st_ringbuf_size);
 
-				// read data
-				auto old = file->file->Tell();
-				file->file->Seek(offset + file->st_total_read);
-				auto res = file->file->Read(vm::get_ptr(position), file->st_block_size);
-				file->file->Seek(old);
+				// read data (the lock is released if the stream supports concurrent positional reads)
+				u64 res;
+
+				if (file->file->IsPositional())
+				{
+					const u64 read_offset = offset + file->st_total_read;
+					lock.unlock();
+					res = file->file->ReadAt(read_offset, vm::get_ptr(position), file->st_block_size);
+					lock.lock();
+				}
+				else
+				{
+					res = file->file->ReadAt(offset + file->st_total_read, vm::get_ptr(position), file->st_block_size);
+				}
+
+				if (res == static_cast<u64>(-1))
+				{
+					// end the stream at the current position instead of adding the error to the counter
+					cellFs.Error("FS ST Thread: read failed (fd=%d, offset=0x%llx)", fd, offset + file->st_total_read);
+					file->st_read_size = file->st_total_read;
+					res = 0;
+				}
 
 				// notify
 				file->st_total_read += res;
@@ -835,25 +885,12 @@ s32 cellFsSdataOpen(PPUThread& CPU, vm::cptr<char> path, s32 flags, vm::ptr<u32>
 		return CELL_FS_EINVAL;
 	}
 
-	return cellFsOpen(path, CELL_FS_O_RDONLY, fd, vm::stackvar<be_t<u64>>(CPU), 8);
-
-	// Don't implement sdata decryption in this function, it should be done in sys_fs_open() syscall or somewhere else
-
-	/*
-	std::string suffix = path.substr(path.length() - 5, 5);
-	if (suffix != ".sdat" && suffix != ".SDAT")
-	return CELL_ENOTSDATA;
+	// SDATA decryption is done by sys_fs_open() on demand
+	vm::stackvar<be_t<u64>> arg_sdata(CPU);
 
-	std::string::size_type last_slash = path.rfind('/'); //TODO: use a filesystem library to solve this more robustly
-	last_slash = last_slash == std::string::npos ? 0 : last_slash+1;
-	std::string unpacked_path = "/dev_hdd1/"+path.substr(last_slash,path.length()-last_slash)+".unpacked";
-	s32 ret = sdata_unpack(path, unpacked_path);
-	if (ret) return ret;
+	arg_sdata.value() = 0x18000000010;
 
-	fd = Emu.GetIdManager().GetNewID(Emu.GetVFS().OpenFile(unpacked_path, vfsRead), TYPE_FS_FILE);
-
-	return CELL_OK;
-	*/
+	return cellFsOpen(path, CELL_FS_O_RDONLY, fd, arg_sdata, 8);
 }
 
 s32 cellFsSdataOpenByFd(u32 mself_fd, s32 flags, vm::ptr<u32> sdata_fd, u64 offset, vm::cptr<void> arg, u64 size)
@@ -867,9 +904,50 @@ s32 cellFsSdataOpenByFd(u32 mself_fd, s32 flags, vm::ptr<u32> sdata_fd, u64 offs
 
 using fs_aio_cb_t = vm::ptr<void(vm::ptr<CellFsAio> xaio, s32 error, s32 xid, u64 size)>;
 
-void fsAio(vm::ptr<CellFsAio> aio, bool write, s32 xid, fs_aio_cb_t func)
+struct fs_aio_request_t
 {
-	cellFs.Notice("FS AIO Request(%d): fd=%d, offset=0x%llx, buf=*0x%x, size=0x%llx, user_data=0x%llx", xid, aio->fd, aio->offset, aio->buf, aio->size, aio->user_data);
+	vm::ptr<CellFsAio> aio;
+	bool write;
+	s32 xid;
+	fs_aio_cb_t func;
+};
+
+// AIO worker threads of a single mount point
+struct fs_aio_pool_t
+{
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::deque<fs_aio_request_t> queue;
+	std::vector<std::unique_ptr<thread_t>> workers;
+	bool stop = false;
+
+	fs_aio_pool_t(const std::string& name);
+	~fs_aio_pool_t();
+};
+
+std::mutex g_fs_aio_mutex;
+std::unordered_map<vfsDevice*, std::shared_ptr<fs_aio_pool_t>> g_fs_aio_pools; // key is nullptr for unknown mount points
+std::atomic<s32> g_fs_aio_id;
+
+void fsAioComplete(const fs_aio_request_t& req, s32 error, u64 result)
+{
+	const auto aio = req.aio;
+	const auto xid = req.xid;
+	const auto func = req.func;
+
+	// should be executed directly by FS AIO thread
+	Emu.GetCallbackManager().Async([=](CPUThread& CPU)
+	{
+		func(static_cast<PPUThread&>(CPU), aio, error, xid, result);
+	});
+}
+
+void fsAio(const fs_aio_request_t& req)
+{
+	const auto aio = req.aio;
+	const bool write = req.write;
+
+	cellFs.Notice("FS AIO Request(%d): fd=%d, offset=0x%llx, buf=*0x%x, size=0x%llx, user_data=0x%llx", req.xid, aio->fd, aio->offset, aio->buf, aio->size, aio->user_data);
 
 	s32 error = CELL_OK;
 	u64 result = 0;
@@ -882,22 +960,94 @@ void fsAio(vm::ptr<CellFsAio> aio, bool write, s32 xid, fs_aio_cb_t func)
 	}
 	else
 	{
-		std::lock_guard<std::mutex> lock(file->mutex);
+		error = write ? fsWriteAt(*file, aio->offset, aio->buf.get_ptr(), aio->size, result) : fsReadAt(*file, aio->offset, aio->buf.get_ptr(), aio->size, result);
+	}
+
+	fsAioComplete(req, error, result);
+}
+
+fs_aio_pool_t::fs_aio_pool_t(const std::string& name)
+{
+	const u32 count = std::max<u32>(std::min<u32>(std::thread::hardware_concurrency(), 4), 1);
+
+	for (u32 i = 0; i < count; i++)
+	{
+		workers.emplace_back(new thread_t([=]{ return fmt::format("FS AIO Thread[%d] (%s)", i, name); }, [this]()
+		{
+			std::unique_lock<std::mutex> lock(mutex);
 
-		const auto old_position = file->file->Tell();
+			while (!Emu.IsStopped())
+			{
+				if (queue.empty())
+				{
+					if (stop)
+					{
+						return;
+					}
 
-		file->file->Seek(aio->offset);
+					// woken up by fsAioQueue() or when the pool is destroyed (cellFsAioFinish or emulation stop)
+					cv.wait(lock);
+					continue;
+				}
 
-		result = write ? file->file->Write(aio->buf.get_ptr(), aio->size) : file->file->Read(aio->buf.get_ptr(), aio->size);
+				const auto req = queue.front();
+				queue.pop_front();
 
-		file->file->Seek(old_position);
+				lock.unlock();
+				fsAio(req);
+				lock.lock();
+			}
+		}));
 	}
+}
 
-	// should be executed directly by FS AIO thread
-	Emu.GetCallbackManager().Async([=](CPUThread& CPU)
+fs_aio_pool_t::~fs_aio_pool_t()
+{
 	{
-		func(static_cast<PPUThread&>(CPU), aio, error, xid, result);
-	});
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+
+	cv.notify_all();
+
+	for (auto& worker : workers)
+	{
+		worker->join();
+	}
+}
+
+std::shared_ptr<fs_aio_pool_t> fsAioGetPool(vfsDevice* device, const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(g_fs_aio_mutex);
+
+	auto& pool = g_fs_aio_pools[device];
+
+	if (!pool)
+	{
+		pool = std::make_shared<fs_aio_pool_t>(name);
+	}
+
+	return pool;
+}
+
+s32 fsAioQueue(vm::ptr<CellFsAio> aio, bool write, vm::ptr<s32> id, fs_aio_cb_t func)
+{
+	const auto file = Emu.GetIdManager().get<lv2_file_t>(_fd_to_id(aio->fd));
+
+	// detect the mount point of the file (unknown mount points share the default pool)
+	const auto fb = file ? dynamic_cast<vfsFileBase*>(file->file.get()) : nullptr;
+	const auto pool = fsAioGetPool(fb ? fb->GetDevice() : nullptr, fb && fb->GetDevice() ? fb->GetDevice()->GetPs3Path() : "default");
+
+	const s32 xid = (*id = ++g_fs_aio_id);
+
+	{
+		std::lock_guard<std::mutex> lock(pool->mutex);
+		pool->queue.push_back({ aio, write, xid, func });
+	}
+
+	pool->cv.notify_one();
+
+	return CELL_OK;
 }
 
 s32 cellFsAioInit(vm::cptr<char> mount_point)
@@ -905,7 +1055,15 @@ s32 cellFsAioInit(vm::cptr<char> mount_point)
 	cellFs.Warning("cellFsAioInit(mount_point=*0x%x)", mount_point);
 	cellFs.Warning("*** mount_point = '%s'", mount_point.get_ptr());
 
-	// TODO: create AIO thread (if not exists) for specified mount point
+	std::string path;
+	const auto device = Emu.GetVFS().GetDevice(mount_point.get_ptr(), path);
+
+	if (!device)
+	{
+		cellFs.Error("cellFsAioInit(): mount point not found ('%s')", mount_point.get_ptr());
+	}
+
+	fsAioGetPool(device, mount_point.get_ptr());
 
 	return CELL_OK;
 }
@@ -915,45 +1073,76 @@ s32 cellFsAioFinish(vm::cptr<char> mount_point)
 	cellFs.Warning("cellFsAioFinish(mount_point=*0x%x)", mount_point);
 	cellFs.Warning("*** mount_point = '%s'", mount_point.get_ptr());
 
-	// TODO: delete existing AIO thread for specified mount point
+	std::string path;
+	const auto device = Emu.GetVFS().GetDevice(mount_point.get_ptr(), path);
 
-	return CELL_OK;
-}
+	if (!device)
+	{
+		// don't destroy the default pool shared by unknown mount points
+		return CELL_FS_EINVAL;
+	}
 
-std::atomic<s32> g_fs_aio_id;
+	std::shared_ptr<fs_aio_pool_t> pool;
 
-s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
-{
-	cellFs.Warning("cellFsAioRead(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
+	{
+		std::lock_guard<std::mutex> lock(g_fs_aio_mutex);
 
-	// TODO: detect mount point and send AIO request to the AIO thread of this mount point
+		const auto found = g_fs_aio_pools.find(device);
 
-	const s32 xid = (*id = ++g_fs_aio_id);
+		if (found == g_fs_aio_pools.end())
+		{
+			return CELL_FS_EINVAL;
+		}
+
+		pool = std::move(found->second);
+		g_fs_aio_pools.erase(found);
+	}
 
-	thread_t(WRAP_EXPR("FS AIO Read Thread"), [=]{ fsAio(aio, false, xid, func); }).detach();
+	// pending requests are completed before the workers exit
+	pool.reset();
 
 	return CELL_OK;
 }
 
-s32 cellFsAioWrite(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+s32 cellFsAioRead(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
 {
-	cellFs.Warning("cellFsAioWrite(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
+	cellFs.Log("cellFsAioRead(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
 
-	// TODO: detect mount point and send AIO request to the AIO thread of this mount point
-
-	const s32 xid = (*id = ++g_fs_aio_id);
+	return fsAioQueue(aio, false, id, func);
+}
 
-	thread_t(WRAP_EXPR("FS AIO Write Thread"), [=]{ fsAio(aio, true, xid, func); }).detach();
+s32 cellFsAioWrite(vm::ptr<CellFsAio> aio, vm::ptr<s32> id, fs_aio_cb_t func)
+{
+	cellFs.Log("cellFsAioWrite(aio=*0x%x, id=*0x%x, func=*0x%x)", aio, id, func);
 
-	return CELL_OK;
+	return fsAioQueue(aio, true, id, func);
 }
 
 s32 cellFsAioCancel(s32 id)
 {
-	cellFs.Warning("cellFsAioCancel(id=%d) -> CELL_FS_EINVAL", id);
+	cellFs.Warning("cellFsAioCancel(id=%d)", id);
+
+	std::lock_guard<std::mutex> lock(g_fs_aio_mutex);
+
+	for (auto& pool : g_fs_aio_pools)
+	{
+		std::lock_guard<std::mutex> pool_lock(pool.second->mutex);
 
-	// TODO: cancelled requests return CELL_FS_ECANCELED through their own callbacks
+		auto& queue = pool.second->queue;
+
+		for (auto it = queue.begin(); it != queue.end(); it++)
+		{
+			if (it->xid == id)
+			{
+				// cancelled requests return CELL_FS_ECANCELED through their own callbacks
+				fsAioComplete(*it, CELL_FS_ECANCELED, 0);
+				queue.erase(it);
+				return CELL_OK;
+			}
+		}
+	}
 
+	// already processed or unknown
 	return CELL_FS_EINVAL;
 }
 
@@ -982,6 +1171,20 @@ Module cellFs("cellFs", []()
 {
 	g_fs_aio_id = 1;
 
+	cellFs.on_stop = []()
+	{
+		std::unordered_map<vfsDevice*, std::shared_ptr<fs_aio_pool_t>> pools;
+
+		{
+			std::lock_guard<std::mutex> lock(g_fs_aio_mutex);
+
+			pools.swap(g_fs_aio_pools);
+		}
+
+		// wake up and join the workers
+		pools.clear();
+	};
+
 	REG_FUNC(cellFs, cellFsOpen);
 	REG_FUNC(cellFs, cellFsSdataOpen);
 	REG_FUNC(cellFs, cellFsSdataOpenByFd);
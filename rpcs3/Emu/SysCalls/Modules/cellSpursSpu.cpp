@@ -604,8 +604,6 @@ bool spursSysServiceEntry(SPUThread & spu) {
 void spursSysServiceIdleHandler(SPUThread & spu, SpursKernelContext * ctxt) {
     bool shouldExit;
 
-    std::unique_lock<std::mutex> lock(spu.mutex, std::defer_lock);
-
     while (true) {
         vm::reservation_acquire(vm::get_ptr(spu.offset + 0x100), VM_CAST(ctxt->spurs.addr()), 128);
         auto spurs = vm::get_ptr<CellSpurs>(spu.offset + 0x100);
@@ -675,8 +673,8 @@ void spursSysServiceIdleHandler(SPUThread & spu, SpursKernelContext * ctxt) {
         if (spuIdling && shouldExit == false && foundReadyWorkload == false) {
             // The system service blocks by making a reservation and waiting on the lock line reservation lost event.
             CHECK_EMU_STATUS;
-            if (!lock) lock.lock();
-            spu.cv.wait_for(lock, std::chrono::milliseconds(1));
+            vm::wait_op(spu, VM_CAST(ctxt->spurs.addr()), 128, WRAP_EXPR(!vm::reservation_test(spu.get_thread_ctrl()) || spu.is_stopped()));
+            if (spu.is_stopped()) throw CPUThreadStop{};
             continue;
         }
 
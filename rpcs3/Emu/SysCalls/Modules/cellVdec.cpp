@@ -3,6 +3,7 @@
 #include "Emu/System.h"
 #include "Emu/IdManager.h"
 #include "Emu/SysCalls/Modules.h"
+#include "rpcs3/Ini.h"
 
 std::mutex g_mutex_avcodec_open2;
 
@@ -35,6 +36,10 @@ VideoDecoder::VideoDecoder(s32 type, u32 profile, u32 addr, u32 size, vm::ptr<Ce
 	, codec(nullptr)
 	, input_format(nullptr)
 	, ctx(nullptr)
+	, fmt(nullptr)
+	, io_buf(nullptr)
+	, use_packets(Ini.DECPacketFeed.GetValue())
+	, parser(nullptr)
 {
 	av_register_all();
 	avcodec_register_all();
@@ -73,6 +78,10 @@ VideoDecoder::VideoDecoder(s32 type, u32 profile, u32 addr, u32 size, vm::ptr<Ce
 	{
 		throw EXCEPTION("av_find_input_format() failed");
 	}
+	if (use_packets)
+	{
+		return;
+	}
 	fmt = avformat_alloc_context();
 	if (!fmt)
 	{
@@ -95,7 +104,16 @@ VideoDecoder::~VideoDecoder()
 		av_frame_unref(vf.data);
 		av_frame_free(&vf.data);
 	}
-	if (ctx)
+	if (parser)
+	{
+		av_parser_close(parser);
+	}
+	if (ctx && use_packets)
+	{
+		avcodec_close(ctx);
+		avcodec_free_context(&ctx);
+	}
+	else if (ctx)
 	{
 		avcodec_close(ctx);
 		avformat_close_input(&fmt);
@@ -184,6 +202,321 @@ next:
 	}
 }
 
+struct VdecFrameHolder : VdecFrame
+{
+	VdecFrameHolder()
+	{
+		data = av_frame_alloc();
+
+		if (!data)
+		{
+			throw EXCEPTION("av_frame_alloc() failed");
+		}
+	}
+
+	~VdecFrameHolder()
+	{
+		if (data)
+		{
+			av_frame_unref(data);
+			av_frame_free(&data);
+		}
+	}
+};
+
+void vdecOpenCodec(VideoDecoder& vdec)
+{
+	// 0 = let libavcodec detect the number of host cores, 1 = decode on this thread only
+	// Frame threading delays pictures by (thread_count - 1) AUs, so PICOUT may follow AUDONE of later AUs (off by default)
+	vdec.ctx->thread_count = Ini.VDECThreads.GetValue();
+	vdec.ctx->thread_type = FF_THREAD_SLICE | (Ini.VDECFrameThreading.GetValue() ? FF_THREAD_FRAME : 0);
+
+	AVDictionary* opts = nullptr;
+	av_dict_set(&opts, "refcounted_frames", "1", 0);
+
+	int err;
+	{
+		std::lock_guard<std::mutex> lock(g_mutex_avcodec_open2);
+		// not multithread-safe (???)
+		err = avcodec_open2(vdec.ctx, vdec.codec, &opts);
+	}
+	if (err || opts)
+	{
+		throw EXCEPTION("avcodec_open2() failed (err=0x%x, opts=%d)", err, opts ? 1 : 0);
+	}
+
+	cellVdec.Notice("vdecOpenCodec(): decoding with %d thread(s) (type=0x%x, packets=%d)", vdec.ctx->thread_count, vdec.ctx->active_thread_type, vdec.use_packets);
+}
+
+void vdecOutputFrame(VideoDecoder& vdec, VdecFrame& frame)
+{
+	if (frame.data->interlaced_frame)
+	{
+		throw EXCEPTION("Interlaced frames not supported (0x%x)", frame.data->interlaced_frame);
+	}
+
+	if (frame.data->repeat_pict)
+	{
+		throw EXCEPTION("Repeated frames not supported (0x%x)", frame.data->repeat_pict);
+	}
+
+	if (vdec.frc_set)
+	{
+		if (vdec.last_pts == -1)
+		{
+			u64 ts = av_frame_get_best_effort_timestamp(frame.data);
+			if (ts != AV_NOPTS_VALUE)
+			{
+				vdec.last_pts = ts;
+			}
+			else
+			{
+				vdec.last_pts = 0;
+			}
+		}
+		else switch (vdec.frc_set)
+		{
+		case CELL_VDEC_FRC_24000DIV1001: vdec.last_pts += 1001 * 90000 / 24000; break;
+		case CELL_VDEC_FRC_24: vdec.last_pts += 90000 / 24; break;
+		case CELL_VDEC_FRC_25: vdec.last_pts += 90000 / 25; break;
+		case CELL_VDEC_FRC_30000DIV1001: vdec.last_pts += 1001 * 90000 / 30000; break;
+		case CELL_VDEC_FRC_30: vdec.last_pts += 90000 / 30; break;
+		case CELL_VDEC_FRC_50: vdec.last_pts += 90000 / 50; break;
+		case CELL_VDEC_FRC_60000DIV1001: vdec.last_pts += 1001 * 90000 / 60000; break;
+		case CELL_VDEC_FRC_60: vdec.last_pts += 90000 / 60; break;
+		default:
+		{
+			throw EXCEPTION("Invalid frame rate code set (0x%x)", vdec.frc_set);
+		}
+		}
+
+		frame.frc = vdec.frc_set;
+	}
+	else
+	{
+		u64 ts = av_frame_get_best_effort_timestamp(frame.data);
+		if (ts != AV_NOPTS_VALUE)
+		{
+			vdec.last_pts = ts;
+		}
+		else if (vdec.last_pts == -1)
+		{
+			vdec.last_pts = 0;
+		}
+		else
+		{
+			vdec.last_pts += vdec.ctx->time_base.num * 90000 * vdec.ctx->ticks_per_frame / vdec.ctx->time_base.den;
+		}
+
+		if (vdec.ctx->time_base.num == 1)
+		{
+			switch ((u64)vdec.ctx->time_base.den + (u64)(vdec.ctx->ticks_per_frame - 1) * 0x100000000ull)
+			{
+			case 24: case 0x100000000ull + 48: frame.frc = CELL_VDEC_FRC_24; break;
+			case 25: case 0x100000000ull + 50: frame.frc = CELL_VDEC_FRC_25; break;
+			case 30: case 0x100000000ull + 60: frame.frc = CELL_VDEC_FRC_30; break;
+			case 50: case 0x100000000ull + 100: frame.frc = CELL_VDEC_FRC_50; break;
+			case 60: case 0x100000000ull + 120: frame.frc = CELL_VDEC_FRC_60; break;
+			default:
+			{
+				throw EXCEPTION("Unsupported time_base.den (%d/1, tpf=%d)", vdec.ctx->time_base.den, vdec.ctx->ticks_per_frame);
+			}
+			}
+		}
+		else if (vdec.ctx->time_base.num == 1001)
+		{
+			if (vdec.ctx->time_base.den / vdec.ctx->ticks_per_frame == 24000)
+			{
+				frame.frc = CELL_VDEC_FRC_24000DIV1001;
+			}
+			else if (vdec.ctx->time_base.den / vdec.ctx->ticks_per_frame == 30000)
+			{
+				frame.frc = CELL_VDEC_FRC_30000DIV1001;
+			}
+			else if (vdec.ctx->time_base.den / vdec.ctx->ticks_per_frame == 60000)
+			{
+				frame.frc = CELL_VDEC_FRC_60000DIV1001;
+			}
+			else
+			{
+				throw EXCEPTION("Unsupported time_base.den (%d/1001, tpf=%d)", vdec.ctx->time_base.den, vdec.ctx->ticks_per_frame);
+			}
+		}
+		else
+		{
+			throw EXCEPTION("Unsupported time_base.num (%d)", vdec.ctx->time_base.num);
+		}
+	}
+
+	frame.pts = vdec.last_pts;
+	frame.dts = (frame.pts - vdec.first_pts) + vdec.first_dts;
+	frame.userdata = frame.data->reordered_opaque;
+
+	//LOG_NOTICE(HLE, "got picture (pts=0x%llx, dts=0x%llx)", frame.pts, frame.dts);
+
+	if (vdec.frames.push(frame, &vdec.is_closed))
+	{
+		frame.data = nullptr; // to prevent destruction
+		vdec.cbFunc(*vdec.vdecCb, vdec.id, CELL_VDEC_MSG_TYPE_PICOUT, CELL_OK, vdec.cbArg);
+	}
+}
+
+void vdecDecodePacket(VideoDecoder& vdec, AVPacket& pkt)
+{
+	while (!Emu.IsStopped() && !vdec.is_closed)
+	{
+		VdecFrameHolder frame;
+
+		int got_picture = 0;
+
+		const int decode = avcodec_decode_video2(vdec.ctx, frame.data, &got_picture, &pkt);
+
+		if (decode < 0)
+		{
+			cellVdec.Error("vdecDecodePacket(): AU decoding error(0x%x)", decode);
+			break;
+		}
+
+		if (got_picture)
+		{
+			vdecOutputFrame(vdec, frame);
+		}
+
+		if (!pkt.data)
+		{
+			// draining: continue until all delayed pictures are returned
+			if (!got_picture) break;
+			continue;
+		}
+
+		pkt.data += decode;
+		pkt.size -= decode;
+
+		if (pkt.size <= 0 || (!decode && !got_picture)) break;
+	}
+}
+
+void vdecParse(VideoDecoder& vdec, const u8* data, u32 size, u64 pts, u64 dts, u64 userdata)
+{
+	do
+	{
+		AVPacket pkt;
+		av_init_packet(&pkt);
+
+		// the parser reports pos of the chunk where the output frame starts, it's used to carry AU userdata
+		const int read = av_parser_parse2(vdec.parser, vdec.ctx, &pkt.data, &pkt.size, data, size,
+			pts == CODEC_TS_INVALID ? AV_NOPTS_VALUE : pts,
+			dts == CODEC_TS_INVALID ? AV_NOPTS_VALUE : dts,
+			userdata);
+
+		data += read;
+		size -= read;
+
+		if (pkt.size)
+		{
+			pkt.pts = vdec.parser->pts;
+			pkt.dts = vdec.parser->dts;
+
+			// frame threading may return pictures of previous AUs, so userdata must travel with the frame
+			vdec.ctx->reordered_opaque = vdec.parser->pos;
+
+			vdecDecodePacket(vdec, pkt);
+		}
+		else if (!read)
+		{
+			break;
+		}
+	}
+	while (size && !Emu.IsStopped() && !vdec.is_closed);
+}
+
+void vdecDecodePackets(VideoDecoder& vdec, VdecTask& task)
+{
+	if (vdec.just_started)
+	{
+		if (vdec.ctx)
+		{
+			avcodec_flush_buffers(vdec.ctx);
+			av_parser_close(vdec.parser);
+		}
+		else
+		{
+			vdec.ctx = avcodec_alloc_context3(vdec.codec);
+			if (!vdec.ctx)
+			{
+				throw EXCEPTION("avcodec_alloc_context3() failed");
+			}
+
+			vdecOpenCodec(vdec);
+		}
+
+		vdec.parser = av_parser_init(vdec.codec->id);
+		if (!vdec.parser)
+		{
+			throw EXCEPTION("av_parser_init() failed");
+		}
+
+		vdec.just_started = false;
+		vdec.just_finished = false;
+	}
+
+	const u8* data = vm::get_ptr<u8>(task.addr);
+	u32 size = task.size;
+
+	// copy elementary stream data to the padded buffer
+	vdec.packet_buf.clear();
+
+	if (size >= 9 && data[0] == 0 && data[1] == 0 && data[2] == 1 && (data[3] & 0xf0) == 0xe0)
+	{
+		// remove PES headers of the stream reconstructed by cellDmux
+		while (size)
+		{
+			if (size < 9 || data[0] != 0 || data[1] != 0 || data[2] != 1 || (data[3] & 0xf0) != 0xe0)
+			{
+				throw EXCEPTION("Invalid PES packet (code=0x%x, size=0x%x)", size >= 4 ? (u32)*(be_t<u32>*)data : 0, size);
+			}
+
+			const u32 packet_size = ((data[4] << 8) | data[5]) + 6;
+			const u32 header_size = data[8] + 9;
+
+			if (packet_size > size || header_size > packet_size)
+			{
+				throw EXCEPTION("Invalid PES packet (size=0x%x, header=0x%x, remaining=0x%x)", packet_size, header_size, size);
+			}
+
+			vdec.packet_buf.insert(vdec.packet_buf.end(), data + header_size, data + packet_size);
+
+			data += packet_size;
+			size -= packet_size;
+		}
+	}
+	else
+	{
+		vdec.packet_buf.insert(vdec.packet_buf.end(), data, data + size);
+	}
+
+	size = (u32)vdec.packet_buf.size();
+	vdec.packet_buf.resize(size + FF_INPUT_BUFFER_PADDING_SIZE);
+
+	vdecParse(vdec, vdec.packet_buf.data(), size, task.pts, task.dts, task.userData);
+}
+
+void vdecDrain(VideoDecoder& vdec)
+{
+	// flush the parser, then return pictures delayed by the decoder
+	if (vdec.parser)
+	{
+		vdecParse(vdec, nullptr, 0, CODEC_TS_INVALID, CODEC_TS_INVALID, 0);
+	}
+
+	AVPacket pkt;
+	av_init_packet(&pkt);
+	pkt.data = nullptr;
+	pkt.size = 0;
+
+	vdecDecodePacket(vdec, pkt);
+}
+
 u32 vdecQueryAttr(s32 type, u32 profile, u32 spec_addr /* may be 0 */, vm::ptr<CellVdecAttr> attr)
 {
 	switch (type) // TODO: check profile levels
@@ -248,6 +581,11 @@ void vdecOpen(u32 vdec_id) // TODO: call from the constructor
 				// TODO: finalize
 				cellVdec.Warning("vdecEndSeq:");
 
+				if (vdec.ctx)
+				{
+					vdecDrain(vdec);
+				}
+
 				vdec.cbFunc(*vdec.vdecCb, vdec.id, CELL_VDEC_MSG_TYPE_SEQDONE, CELL_OK, vdec.cbArg);
 
 				vdec.just_finished = true;
@@ -269,6 +607,14 @@ void vdecOpen(u32 vdec_id) // TODO: call from the constructor
 					vdec.first_dts = task.dts;
 				}
 
+				if (vdec.use_packets)
+				{
+					vdecDecodePackets(vdec, task);
+
+					vdec.cbFunc(*vdec.vdecCb, vdec.id, CELL_VDEC_MSG_TYPE_AUDONE, CELL_OK, vdec.cbArg);
+					break;
+				}
+
 				struct AVPacketHolder : AVPacket
 				{
 					AVPacketHolder(u32 size)
@@ -327,18 +673,8 @@ void vdecOpen(u32 vdec_id) // TODO: call from the constructor
 						}
 					}
 					vdec.ctx = vdec.fmt->streams[0]->codec; // TODO: check data
-						
-					opts = nullptr;
-					av_dict_set(&opts, "refcounted_frames", "1", 0);
-					{
-						std::lock_guard<std::mutex> lock(g_mutex_avcodec_open2);
-						// not multithread-safe (???)
-						err = avcodec_open2(vdec.ctx, vdec.codec, &opts);
-					}
-					if (err || opts)
-					{
-						throw EXCEPTION("avcodec_open2() failed (err=0x%x, opts=%d)", err, opts ? 1 : 0);
-					}
+
+					vdecOpenCodec(vdec);
 
 					vdec.just_started = false;
 				}
@@ -362,31 +698,13 @@ void vdecOpen(u32 vdec_id) // TODO: call from the constructor
 						au.size = 0;
 					}
 
-					struct VdecFrameHolder : VdecFrame
-					{
-						VdecFrameHolder()
-						{
-							data = av_frame_alloc();
-						}
-
-						~VdecFrameHolder()
-						{
-							if (data)
-							{
-								av_frame_unref(data);
-								av_frame_free(&data);
-							}
-						}
-
-					} frame;
-
-					if (!frame.data)
-					{
-						throw EXCEPTION("av_frame_alloc() failed");
-					}
+					VdecFrameHolder frame;
 
 					int got_picture = 0;
 
+					// frame threading may return pictures of previous AUs, so userdata must travel with the frame
+					vdec.ctx->reordered_opaque = task.userData;
+
 					int decode = avcodec_decode_video2(vdec.ctx, frame.data, &got_picture, &au);
 
 					if (decode <= 0)
@@ -400,115 +718,7 @@ void vdecOpen(u32 vdec_id) // TODO: call from the constructor
 
 					if (got_picture)
 					{
-						if (frame.data->interlaced_frame)
-						{
-							throw EXCEPTION("Interlaced frames not supported (0x%x)", frame.data->interlaced_frame);
-						}
-
-						if (frame.data->repeat_pict)
-						{
-							throw EXCEPTION("Repeated frames not supported (0x%x)", frame.data->repeat_pict);
-						}
-
-						if (vdec.frc_set)
-						{
-							if (vdec.last_pts == -1)
-							{
-								u64 ts = av_frame_get_best_effort_timestamp(frame.data);
-								if (ts != AV_NOPTS_VALUE)
-								{
-									vdec.last_pts = ts;
-								}
-								else
-								{
-									vdec.last_pts = 0;
-								}
-							}
-							else switch (vdec.frc_set)
-							{
-							case CELL_VDEC_FRC_24000DIV1001: vdec.last_pts += 1001 * 90000 / 24000; break;
-							case CELL_VDEC_FRC_24: vdec.last_pts += 90000 / 24; break;
-							case CELL_VDEC_FRC_25: vdec.last_pts += 90000 / 25; break;
-							case CELL_VDEC_FRC_30000DIV1001: vdec.last_pts += 1001 * 90000 / 30000; break;
-							case CELL_VDEC_FRC_30: vdec.last_pts += 90000 / 30; break;
-							case CELL_VDEC_FRC_50: vdec.last_pts += 90000 / 50; break;
-							case CELL_VDEC_FRC_60000DIV1001: vdec.last_pts += 1001 * 90000 / 60000; break;
-							case CELL_VDEC_FRC_60: vdec.last_pts += 90000 / 60; break;
-							default:
-							{
-								throw EXCEPTION("Invalid frame rate code set (0x%x)", vdec.frc_set);
-							}
-							}
-
-							frame.frc = vdec.frc_set;
-						}
-						else
-						{
-							u64 ts = av_frame_get_best_effort_timestamp(frame.data);
-							if (ts != AV_NOPTS_VALUE)
-							{
-								vdec.last_pts = ts;
-							}
-							else if (vdec.last_pts == -1)
-							{
-								vdec.last_pts = 0;
-							}
-							else
-							{
-								vdec.last_pts += vdec.ctx->time_base.num * 90000 * vdec.ctx->ticks_per_frame / vdec.ctx->time_base.den;
-							}
-
-							if (vdec.ctx->time_base.num == 1)
-							{
-								switch ((u64)vdec.ctx->time_base.den + (u64)(vdec.ctx->ticks_per_frame - 1) * 0x100000000ull)
-								{
-								case 24: case 0x100000000ull + 48: frame.frc = CELL_VDEC_FRC_24; break;
-								case 25: case 0x100000000ull + 50: frame.frc = CELL_VDEC_FRC_25; break;
-								case 30: case 0x100000000ull + 60: frame.frc = CELL_VDEC_FRC_30; break;
-								case 50: case 0x100000000ull + 100: frame.frc = CELL_VDEC_FRC_50; break;
-								case 60: case 0x100000000ull + 120: frame.frc = CELL_VDEC_FRC_60; break;
-								default:
-								{
-									throw EXCEPTION("Unsupported time_base.den (%d/1, tpf=%d)", vdec.ctx->time_base.den, vdec.ctx->ticks_per_frame);
-								}
-								}
-							}
-							else if (vdec.ctx->time_base.num == 1001)
-							{
-								if (vdec.ctx->time_base.den / vdec.ctx->ticks_per_frame == 24000)
-								{
-									frame.frc = CELL_VDEC_FRC_24000DIV1001;
-								}
-								else if (vdec.ctx->time_base.den / vdec.ctx->ticks_per_frame == 30000)
-								{
-									frame.frc = CELL_VDEC_FRC_30000DIV1001;
-								}
-								else if (vdec.ctx->time_base.den / vdec.ctx->ticks_per_frame == 60000)
-								{
-									frame.frc = CELL_VDEC_FRC_60000DIV1001;
-								}
-								else
-								{
-									throw EXCEPTION("Unsupported time_base.den (%d/1001, tpf=%d)", vdec.ctx->time_base.den, vdec.ctx->ticks_per_frame);
-								}
-							}
-							else
-							{
-								throw EXCEPTION("Unsupported time_base.num (%d)", vdec.ctx->time_base.num);
-							}
-						}
-
-						frame.pts = vdec.last_pts;
-						frame.dts = (frame.pts - vdec.first_pts) + vdec.first_dts;
-						frame.userdata = task.userData;
-
-						//LOG_NOTICE(HLE, "got picture (pts=0x%llx, dts=0x%llx)", frame.pts, frame.dts);
-
-						if (vdec.frames.push(frame, &vdec.is_closed))
-						{
-							frame.data = nullptr; // to prevent destruction
-							vdec.cbFunc(*vdec.vdecCb, vdec.id, CELL_VDEC_MSG_TYPE_PICOUT, CELL_OK, vdec.cbArg);
-						}
+						vdecOutputFrame(vdec, frame);
 					}
 				}
 
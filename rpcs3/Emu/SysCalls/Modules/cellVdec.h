@@ -708,6 +708,11 @@ public:
 	AVFormatContext* fmt;
 	u8* io_buf;
 
+	// packet feeding mode (AUs are passed to the decoder without libavformat)
+	const bool use_packets;
+	AVCodecParserContext* parser;
+	std::vector<u8> packet_buf;
+
 	struct VideoReader
 	{
 		u32 addr;
@@ -3,6 +3,7 @@
 #include "Emu/System.h"
 #include "Emu/SysCalls/Modules.h"
 #include "Emu/SysCalls/lv2/sys_process.h"
+#include "Emu/SysCalls/lv2/sys_fs.h"
 #include "rpcs3/Ini.h"
 
 #include "Emu/FS/VFS.h"
@@ -91,15 +92,30 @@ s32 npDrmIsAvailable(u32 k_licensee_addr, vm::cptr<char> drm_path)
 		sceNp.Warning("npDrmIsAvailable(): Can't find RAP file for '%s' (titleID='%s')", drm_path.get_ptr(), titleID);
 	}
 
-	// Decrypt this EDAT using the supplied k_licensee and matching RAP file.
 	std::string enc_drm_path_local, dec_drm_path_local, rap_path_local;
 	Emu.GetVFS().GetDevice(enc_drm_path, enc_drm_path_local);
 	Emu.GetVFS().GetDevice(dec_drm_path, dec_drm_path_local);
 	Emu.GetVFS().GetDevice(rap_path, rap_path_local);
 
-	if (DecryptEDAT(enc_drm_path_local, dec_drm_path_local, 8, rap_path_local, k_licensee, false) >= 0)
+	be_t<u32> edat_flags = 0;
+
+	if (fs::file enc_file{ enc_drm_path_local })
+	{
+		enc_file.seek(0x80);
+		enc_file.read(&edat_flags, sizeof(edat_flags));
+	}
+
+	if ((edat_flags & EDAT_COMPRESSED_FLAG) == 0)
+	{
+		// Register the supplied k_licensee and the key from matching RAP file, the EDAT is decrypted on demand (see sys_fs_open()).
+		u8 rifkey[0x10];
+		GetEDATRifKey(rap_path_local, rifkey);
+
+		sys_fs_set_edat_license(enc_drm_path_local, k_licensee, rifkey);
+	}
+	else if (DecryptEDAT(enc_drm_path_local, dec_drm_path_local, 8, rap_path_local, k_licensee, false) >= 0)
 	{
-		// If decryption succeeds, replace the encrypted file with it.
+		// Compressed EDAT can't be decrypted on demand: if decryption succeeds, replace the encrypted file with it.
 		fs::remove_file(enc_drm_path_local);
 		fs::rename(dec_drm_path_local, enc_drm_path_local);
 	}
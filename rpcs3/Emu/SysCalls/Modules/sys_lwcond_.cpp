@@ -14,7 +14,14 @@ s32 sys_lwcond_create(vm::ptr<sys_lwcond_t> lwcond, vm::ptr<sys_lwmutex_t> lwmut
 {
 	sysPrxForUser.Warning("sys_lwcond_create(lwcond=*0x%x, lwmutex=*0x%x, attr=*0x%x)", lwcond, lwmutex, attr);
 
-	lwcond->lwcond_queue = Emu.GetIdManager().make<lv2_lwcond_t>(attr->name_u64);
+	const auto mutex = Emu.GetIdManager().get<lv2_lwmutex_t>(lwmutex->sleep_queue);
+
+	if (!mutex)
+	{
+		return CELL_ESRCH;
+	}
+
+	lwcond->lwcond_queue = Emu.GetIdManager().make<lv2_lwcond_t>(mutex, attr->name_u64);
 	lwcond->lwmutex = lwmutex;
 
 	return CELL_OK;
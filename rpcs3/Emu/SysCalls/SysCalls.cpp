@@ -34,6 +34,8 @@
 #include "Emu/SysCalls/Modules/cellGcmSys.h"
 
 #include "SysCalls.h"
+#include "HLETrace.h"
+#include "Emu/Cell/PPUScheduler.h"
 
 void null_func(PPUThread& ppu)
 {
@@ -902,6 +904,10 @@ void SysCalls::DoSyscall(PPUThread& CPU, u64 code)
 	auto last_code = CPU.hle_code;
 	CPU.hle_code = ~code;
 
+	hle_trace_scope_t trace(CPU, ~code, CPU.PC);
+
+	ppu_sched_hle_scope_t run_slot(CPU);
+
 	if (Ini.HLELogging.GetValue())
 	{
 		LOG_NOTICE(PPU, "Syscall %lld called: %s", code, SysCalls::GetFuncName(~code));
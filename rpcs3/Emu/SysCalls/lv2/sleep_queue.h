@@ -41,6 +41,15 @@ enum
 	SYS_SYNC_NOT_ADAPTIVE = 0x2000,
 };
 
+// Locking of lv2 synchronization objects:
+// Mutexes, lightweight mutexes, semaphores, event flags, rwlocks, event queues, event ports and timers are protected by their own lock (`sync` member).
+// Condition variables and lightweight condition variables use the lock of their associated (lightweight) mutex,
+// so moving a waiter from the cond var to the mutex sleep queue is done under a single lock.
+// SPU thread groups and SPU thread event ports are still protected by the core mutex (LV2_LOCK). TODO: per-group lock.
+// Lock order: the core mutex is locked before an object lock; an object lock is never held while locking the core mutex or another object
+// (event ports and timers are unlocked before the event queue is locked to send an event).
+// A thread sleeping on some lock must be signaled with the same lock held, otherwise the notification may be lost.
+
 using sleep_queue_t = std::deque<std::shared_ptr<CPUThread>>;
 
 static struct defer_sleep_t{} const defer_sleep{};
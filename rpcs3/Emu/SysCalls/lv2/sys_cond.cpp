@@ -14,7 +14,7 @@ extern u64 get_system_time();
 
 void lv2_cond_t::notify(lv2_lock_t& lv2_lock, sleep_queue_t::value_type& thread)
 {
-	CHECK_LV2_LOCK(lv2_lock);
+	CHECK_LV2_OBJECT_LOCK(lv2_lock, mutex->sync);
 
 	if (mutex->owner)
 	{
@@ -36,8 +36,6 @@ s32 sys_cond_create(vm::ptr<u32> cond_id, u32 mutex_id, vm::ptr<sys_cond_attribu
 {
 	sys_cond.Warning("sys_cond_create(cond_id=*0x%x, mutex_id=0x%x, attr=*0x%x)", cond_id, mutex_id, attr);
 
-	LV2_LOCK;
-
 	const auto mutex = Emu.GetIdManager().get<lv2_mutex_t>(mutex_id);
 
 	if (!mutex)
@@ -45,6 +43,14 @@ s32 sys_cond_create(vm::ptr<u32> cond_id, u32 mutex_id, vm::ptr<sys_cond_attribu
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(mutex->sync);
+
+	// check whether the mutex was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_mutex_t>(mutex_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (attr->pshared != SYS_SYNC_NOT_PROCESS_SHARED || attr->ipc_key.data() || attr->flags.data())
 	{
 		sys_cond.Error("sys_cond_create(): unknown attributes (pshared=0x%x, ipc_key=0x%llx, flags=0x%x)", attr->pshared, attr->ipc_key, attr->flags);
@@ -65,8 +71,6 @@ s32 sys_cond_destroy(u32 cond_id)
 {
 	sys_cond.Warning("sys_cond_destroy(cond_id=0x%x)", cond_id);
 
-	LV2_LOCK;
-
 	const auto cond = Emu.GetIdManager().get<lv2_cond_t>(cond_id);
 
 	if (!cond)
@@ -74,6 +78,14 @@ s32 sys_cond_destroy(u32 cond_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(cond->mutex->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_cond_t>(cond_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (!cond->sq.empty())
 	{
 		return CELL_EBUSY;
@@ -93,8 +105,6 @@ s32 sys_cond_signal(u32 cond_id)
 {
 	sys_cond.Log("sys_cond_signal(cond_id=0x%x)", cond_id);
 
-	LV2_LOCK;
-
 	const auto cond = Emu.GetIdManager().get<lv2_cond_t>(cond_id);
 
 	if (!cond)
@@ -102,6 +112,14 @@ s32 sys_cond_signal(u32 cond_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(cond->mutex->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_cond_t>(cond_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	// signal one waiting thread; protocol is ignored in current implementation
 	if (!cond->sq.empty())
 	{
@@ -116,8 +134,6 @@ s32 sys_cond_signal_all(u32 cond_id)
 {
 	sys_cond.Log("sys_cond_signal_all(cond_id=0x%x)", cond_id);
 
-	LV2_LOCK;
-
 	const auto cond = Emu.GetIdManager().get<lv2_cond_t>(cond_id);
 
 	if (!cond)
@@ -125,6 +141,14 @@ s32 sys_cond_signal_all(u32 cond_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(cond->mutex->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_cond_t>(cond_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	// signal all waiting threads; protocol is ignored in current implementation
 	for (auto& thread : cond->sq)
 	{
@@ -140,8 +164,6 @@ s32 sys_cond_signal_to(u32 cond_id, u32 thread_id)
 {
 	sys_cond.Log("sys_cond_signal_to(cond_id=0x%x, thread_id=0x%x)", cond_id, thread_id);
 
-	LV2_LOCK;
-
 	const auto cond = Emu.GetIdManager().get<lv2_cond_t>(cond_id);
 
 	if (!cond)
@@ -149,6 +171,14 @@ s32 sys_cond_signal_to(u32 cond_id, u32 thread_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(cond->mutex->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_cond_t>(cond_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	const auto found = std::find_if(cond->sq.begin(), cond->sq.end(), [=](sleep_queue_t::value_type& thread)
 	{
 		return thread->get_id() == thread_id;
@@ -173,8 +203,6 @@ s32 sys_cond_wait(PPUThread& ppu, u32 cond_id, u64 timeout)
 
 	const u64 start_time = get_system_time();
 
-	LV2_LOCK;
-
 	const auto cond = Emu.GetIdManager().get<lv2_cond_t>(cond_id);
 
 	if (!cond)
@@ -182,6 +210,14 @@ s32 sys_cond_wait(PPUThread& ppu, u32 cond_id, u64 timeout)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(cond->mutex->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_cond_t>(cond_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	// check current ownership
 	if (cond->mutex->owner.get() != &ppu)
 	{
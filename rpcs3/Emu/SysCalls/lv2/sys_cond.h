@@ -22,7 +22,7 @@ struct sys_cond_attribute_t
 struct lv2_cond_t
 {
 	const u64 name;
-	const std::shared_ptr<lv2_mutex_t> mutex; // associated mutex
+	const std::shared_ptr<lv2_mutex_t> mutex; // associated mutex (its lock protects this object)
 
 	sleep_queue_t sq;
 
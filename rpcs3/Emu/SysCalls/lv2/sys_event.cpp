@@ -26,7 +26,7 @@ lv2_event_queue_t::lv2_event_queue_t(u32 protocol, s32 type, u64 name, u64 key,
 
 void lv2_event_queue_t::push(lv2_lock_t& lv2_lock, u64 source, u64 data1, u64 data2, u64 data3)
 {
-	CHECK_LV2_LOCK(lv2_lock);
+	CHECK_LV2_OBJECT_LOCK(lv2_lock, sync);
 
 	// save event if no waiters
 	if (sq.empty())
@@ -113,8 +113,6 @@ s32 sys_event_queue_destroy(u32 equeue_id, s32 mode)
 {
 	sys_event.Warning("sys_event_queue_destroy(equeue_id=0x%x, mode=%d)", equeue_id, mode);
 
-	LV2_LOCK;
-
 	const auto queue = Emu.GetIdManager().get<lv2_event_queue_t>(equeue_id);
 
 	if (!queue)
@@ -122,6 +120,14 @@ s32 sys_event_queue_destroy(u32 equeue_id, s32 mode)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(queue->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_event_queue_t>(equeue_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (mode && mode != SYS_EVENT_QUEUE_DESTROY_FORCE)
 	{
 		return CELL_EINVAL;
@@ -162,8 +168,6 @@ s32 sys_event_queue_tryreceive(u32 equeue_id, vm::ptr<sys_event_t> event_array,
 {
 	sys_event.Log("sys_event_queue_tryreceive(equeue_id=0x%x, event_array=*0x%x, size=%d, number=*0x%x)", equeue_id, event_array, size, number);
 
-	LV2_LOCK;
-
 	const auto queue = Emu.GetIdManager().get<lv2_event_queue_t>(equeue_id);
 
 	if (!queue)
@@ -171,6 +175,14 @@ s32 sys_event_queue_tryreceive(u32 equeue_id, vm::ptr<sys_event_t> event_array,
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(queue->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_event_queue_t>(equeue_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (size < 0)
 	{
 		throw EXCEPTION("Negative size");
@@ -203,8 +215,6 @@ s32 sys_event_queue_receive(PPUThread& ppu, u32 equeue_id, vm::ptr<sys_event_t>
 
 	const u64 start_time = get_system_time();
 
-	LV2_LOCK;
-
 	const auto queue = Emu.GetIdManager().get<lv2_event_queue_t>(equeue_id);
 
 	if (!queue)
@@ -212,6 +222,14 @@ s32 sys_event_queue_receive(PPUThread& ppu, u32 equeue_id, vm::ptr<sys_event_t>
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(queue->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_event_queue_t>(equeue_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (queue->type != SYS_PPU_QUEUE)
 	{
 		return CELL_EINVAL;
@@ -272,8 +290,6 @@ s32 sys_event_queue_drain(u32 equeue_id)
 {
 	sys_event.Log("sys_event_queue_drain(equeue_id=0x%x)", equeue_id);
 
-	LV2_LOCK;
-
 	const auto queue = Emu.GetIdManager().get<lv2_event_queue_t>(equeue_id);
 
 	if (!queue)
@@ -281,6 +297,14 @@ s32 sys_event_queue_drain(u32 equeue_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(queue->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_event_queue_t>(equeue_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	queue->events.clear();
 
 	return CELL_OK;
@@ -305,8 +329,6 @@ s32 sys_event_port_destroy(u32 eport_id)
 {
 	sys_event.Warning("sys_event_port_destroy(eport_id=0x%x)", eport_id);
 
-	LV2_LOCK;
-
 	const auto port = Emu.GetIdManager().get<lv2_event_port_t>(eport_id);
 
 	if (!port)
@@ -314,6 +336,14 @@ s32 sys_event_port_destroy(u32 eport_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(port->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_event_port_t>(eport_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (!port->queue.expired())
 	{
 		return CELL_EISCONN;
@@ -328,8 +358,6 @@ s32 sys_event_port_connect_local(u32 eport_id, u32 equeue_id)
 {
 	sys_event.Warning("sys_event_port_connect_local(eport_id=0x%x, equeue_id=0x%x)", eport_id, equeue_id);
 
-	LV2_LOCK;
-
 	const auto port = Emu.GetIdManager().get<lv2_event_port_t>(eport_id);
 	const auto queue = Emu.GetIdManager().get<lv2_event_queue_t>(equeue_id);
 
@@ -338,6 +366,14 @@ s32 sys_event_port_connect_local(u32 eport_id, u32 equeue_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(port->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_event_port_t>(eport_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (port->type != SYS_EVENT_PORT_LOCAL)
 	{
 		return CELL_EINVAL;
@@ -357,8 +393,6 @@ s32 sys_event_port_disconnect(u32 eport_id)
 {
 	sys_event.Warning("sys_event_port_disconnect(eport_id=0x%x)", eport_id);
 
-	LV2_LOCK;
-
 	const auto port = Emu.GetIdManager().get<lv2_event_port_t>(eport_id);
 
 	if (!port)
@@ -366,6 +400,14 @@ s32 sys_event_port_disconnect(u32 eport_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(port->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_event_port_t>(eport_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	const auto queue = port->queue.lock();
 
 	if (!queue)
@@ -384,8 +426,6 @@ s32 sys_event_port_send(u32 eport_id, u64 data1, u64 data2, u64 data3)
 {
 	sys_event.Log("sys_event_port_send(eport_id=0x%x, data1=0x%llx, data2=0x%llx, data3=0x%llx)", eport_id, data1, data2, data3);
 
-	LV2_LOCK;
-
 	const auto port = Emu.GetIdManager().get<lv2_event_port_t>(eport_id);
 
 	if (!port)
@@ -393,13 +433,33 @@ s32 sys_event_port_send(u32 eport_id, u64 data1, u64 data2, u64 data3)
 		return CELL_ESRCH;
 	}
 
-	const auto queue = port->queue.lock();
+	std::shared_ptr<lv2_event_queue_t> queue;
+
+	{
+		// object locks are not nested: unlock the port before locking the queue
+		lv2_lock_t lv2_lock(port->sync);
+
+		if (!Emu.GetIdManager().check_id<lv2_event_port_t>(eport_id))
+		{
+			return CELL_ESRCH;
+		}
+
+		queue = port->queue.lock();
+	}
 
 	if (!queue)
 	{
 		return CELL_ENOTCONN;
 	}
 
+	lv2_lock_t lv2_lock(queue->sync);
+
+	// check whether the queue was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_event_queue_t>(queue->id))
+	{
+		return CELL_ENOTCONN;
+	}
+
 	if (queue->events.size() >= queue->size)
 	{
 		return CELL_EBUSY;
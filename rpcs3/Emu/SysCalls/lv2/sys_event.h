@@ -82,10 +82,13 @@ struct lv2_event_queue_t
 	// tuple elements: source, data1, data2, data3
 	std::deque<std::tuple<u64, u64, u64, u64>> events;
 
+	std::mutex sync; // object lock
+
 	sleep_queue_t sq;
 
 	lv2_event_queue_t(u32 protocol, s32 type, u64 name, u64 key, s32 size);
 
+	// lv2_lock must hold the object lock
 	void push(lv2_lock_t& lv2_lock, u64 source, u64 data1, u64 data2, u64 data3);
 };
 
@@ -98,6 +101,8 @@ struct lv2_event_port_t
 
 	std::weak_ptr<lv2_event_queue_t> queue; // event queue this port is connected to
 
+	std::mutex sync; // object lock (protects the connection)
+
 	lv2_event_port_t(s32 type, u64 name)
 		: type(type)
 		, name(name)
@@ -13,7 +13,7 @@ extern u64 get_system_time();
 
 void lv2_event_flag_t::notify_all(lv2_lock_t& lv2_lock)
 {
-	CHECK_LV2_LOCK(lv2_lock);
+	CHECK_LV2_OBJECT_LOCK(lv2_lock, sync);
 
 	auto pred = [this](sleep_queue_t::value_type& thread) -> bool
 	{
@@ -84,8 +84,6 @@ s32 sys_event_flag_destroy(u32 id)
 {
 	sys_event_flag.Warning("sys_event_flag_destroy(id=0x%x)", id);
 
-	LV2_LOCK;
-
 	const auto eflag = Emu.GetIdManager().get<lv2_event_flag_t>(id);
 
 	if (!eflag)
@@ -93,6 +91,14 @@ s32 sys_event_flag_destroy(u32 id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(eflag->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_event_flag_t>(id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (!eflag->sq.empty())
 	{
 		return CELL_EBUSY;
@@ -114,8 +120,6 @@ s32 sys_event_flag_wait(PPUThread& ppu, u32 id, u64 bitptn, u32 mode, vm::ptr<u6
 	ppu.GPR[4] = bitptn;
 	ppu.GPR[5] = mode;
 
-	LV2_LOCK;
-
 	if (result) *result = 0; // This is very annoying.
 
 	if (!lv2_event_flag_t::check_mode(mode))
@@ -131,6 +135,14 @@ s32 sys_event_flag_wait(PPUThread& ppu, u32 id, u64 bitptn, u32 mode, vm::ptr<u6
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(eflag->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_event_flag_t>(id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (eflag->type == SYS_SYNC_WAITER_SINGLE && eflag->sq.size() > 0)
 	{
 		return CELL_EPERM;
@@ -190,8 +202,6 @@ s32 sys_event_flag_trywait(u32 id, u64 bitptn, u32 mode, vm::ptr<u64> result)
 {
 	sys_event_flag.Log("sys_event_flag_trywait(id=0x%x, bitptn=0x%llx, mode=0x%x, result=*0x%x)", id, bitptn, mode, result);
 
-	LV2_LOCK;
-
 	if (result) *result = 0; // This is very annoying.
 
 	if (!lv2_event_flag_t::check_mode(mode))
@@ -207,6 +217,14 @@ s32 sys_event_flag_trywait(u32 id, u64 bitptn, u32 mode, vm::ptr<u64> result)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(eflag->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_event_flag_t>(id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (eflag->check_pattern(bitptn, mode))
 	{
 		const u64 pattern = eflag->clear_pattern(bitptn, mode);
@@ -223,8 +241,6 @@ s32 sys_event_flag_set(u32 id, u64 bitptn)
 {
 	sys_event_flag.Log("sys_event_flag_set(id=0x%x, bitptn=0x%llx)", id, bitptn);
 
-	LV2_LOCK;
-
 	const auto eflag = Emu.GetIdManager().get<lv2_event_flag_t>(id);
 
 	if (!eflag)
@@ -232,6 +248,14 @@ s32 sys_event_flag_set(u32 id, u64 bitptn)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(eflag->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_event_flag_t>(id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (bitptn && ~eflag->pattern.fetch_or(bitptn) & bitptn)
 	{
 		eflag->notify_all(lv2_lock);
@@ -244,8 +268,6 @@ s32 sys_event_flag_clear(u32 id, u64 bitptn)
 {
 	sys_event_flag.Log("sys_event_flag_clear(id=0x%x, bitptn=0x%llx)", id, bitptn);
 
-	LV2_LOCK;
-
 	const auto eflag = Emu.GetIdManager().get<lv2_event_flag_t>(id);
 
 	if (!eflag)
@@ -253,6 +275,14 @@ s32 sys_event_flag_clear(u32 id, u64 bitptn)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(eflag->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_event_flag_t>(id))
+	{
+		return CELL_ESRCH;
+	}
+
 	eflag->pattern &= bitptn;
 
 	return CELL_OK;
@@ -262,8 +292,6 @@ s32 sys_event_flag_cancel(u32 id, vm::ptr<u32> num)
 {
 	sys_event_flag.Log("sys_event_flag_cancel(id=0x%x, num=*0x%x)", id, num);
 
-	LV2_LOCK;
-
 	if (num)
 	{
 		*num = 0;
@@ -276,6 +304,14 @@ s32 sys_event_flag_cancel(u32 id, vm::ptr<u32> num)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(eflag->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_event_flag_t>(id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (num)
 	{
 		*num = static_cast<u32>(eflag->sq.size());
@@ -309,8 +345,6 @@ s32 sys_event_flag_get(u32 id, vm::ptr<u64> flags)
 {
 	sys_event_flag.Log("sys_event_flag_get(id=0x%x, flags=*0x%x)", id, flags);
 
-	LV2_LOCK;
-
 	if (!flags)
 	{
 		return CELL_EFAULT;
@@ -325,6 +359,8 @@ s32 sys_event_flag_get(u32 id, vm::ptr<u64> flags)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(eflag->sync);
+
 	*flags = eflag->pattern;
 
 	return CELL_OK;
@@ -39,6 +39,8 @@ struct lv2_event_flag_t
 
 	std::atomic<u64> pattern;
 
+	std::mutex sync; // object lock
+
 	sleep_queue_t sq;
 
 	lv2_event_flag_t(u64 pattern, u32 protocol, s32 type, u64 name)
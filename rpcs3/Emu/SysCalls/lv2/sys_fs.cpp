@@ -8,6 +8,7 @@
 #include "Emu/FS/vfsFile.h"
 #include "Emu/FS/vfsLocalFile.h"
 #include "Emu/FS/vfsDir.h"
+#include "Crypto/unedat.h"
 
 #include "sys_fs.h"
 
@@ -20,6 +21,69 @@ u32 _fd_to_id(u32 fd)
 	return fd < g_fds.size() ? g_fds[fd].load() : 0;
 }
 
+struct edat_license_t
+{
+	u8 klicensee[0x10];
+	u8 rifkey[0x10];
+};
+
+std::mutex g_edat_license_mutex;
+std::unordered_map<std::string, edat_license_t> g_edat_licenses; // EDAT licenses by local path
+
+void sys_fs_set_edat_license(const std::string& local_path, const u8* klicensee, const u8* rifkey)
+{
+	std::lock_guard<std::mutex> lock(g_edat_license_mutex);
+
+	auto& license = g_edat_licenses[local_path];
+
+	memcpy(license.klicensee, klicensee, 0x10);
+	memcpy(license.rifkey, rifkey, 0x10);
+}
+
+bool edat_registered(const std::string& local_path)
+{
+	std::lock_guard<std::mutex> lock(g_edat_license_mutex);
+
+	return g_edat_licenses.count(local_path) != 0;
+}
+
+// wrap encrypted file if the license is registered (returns false on error, stream is left unchanged if not encrypted or not registered)
+bool edat_open(const std::string& local_path, std::shared_ptr<vfsStream>& file)
+{
+	edat_license_t license;
+
+	{
+		std::lock_guard<std::mutex> lock(g_edat_license_mutex);
+
+		const auto found = g_edat_licenses.find(local_path);
+
+		if (found == g_edat_licenses.end())
+		{
+			return true;
+		}
+
+		license = found->second;
+	}
+
+	u32 magic;
+
+	if (file->ReadAt(0, &magic, sizeof(magic)) != sizeof(magic) || magic != *(u32*)"NPD\0")
+	{
+		return true;
+	}
+
+	auto edat = std::make_shared<EDATADecrypter>(file, local_path, license.klicensee, license.rifkey);
+
+	if (!edat->ReadHeader())
+	{
+		return false;
+	}
+
+	file = std::move(edat);
+
+	return true;
+}
+
 lv2_file_t::~lv2_file_t()
 {
 	if (Emu.IsStopped())
@@ -137,6 +201,31 @@ s32 sys_fs_open(vm::cptr<char> path, s32 flags, vm::ptr<u32> fd, s32 mode, vm::c
 		return CELL_FS_ENOENT;
 	}
 
+	// SDATA is requested by cellFsSdataOpen() with this argument
+	if (size == 8 && arg && *vm::static_ptr_cast<const be_t<u64>>(arg) == 0x18000000010)
+	{
+		u32 magic;
+
+		// not encrypted files are opened as is
+		if (file->ReadAt(0, &magic, sizeof(magic)) == sizeof(magic) && magic == *(u32*)"NPD\0")
+		{
+			auto sdata = std::make_shared<EDATADecrypter>(std::move(file));
+
+			if (!sdata->ReadHeader())
+			{
+				sys_fs.Error("sys_fs_open('%s'): failed to read SDATA header", path.get_ptr());
+				return CELL_FS_EFSSPECIFIC;
+			}
+
+			file = std::move(sdata);
+		}
+	}
+	else if ((flags & CELL_FS_O_ACCMODE) == CELL_FS_O_RDONLY && !edat_open(local_path, file))
+	{
+		sys_fs.Error("sys_fs_open('%s'): failed to read EDAT header", path.get_ptr());
+		return CELL_FS_EFSSPECIFIC;
+	}
+
 	for (u32 i = 3; i < g_fds.size(); i++)
 	{
 		// try to reserve fd
@@ -309,6 +398,17 @@ s32 sys_fs_stat(vm::cptr<char> path, vm::ptr<CellFsStat> sb)
 		return CELL_FS_ENOENT;
 	}
 
+	if (!info.is_directory && edat_registered(local_path))
+	{
+		// report decrypted size of EDAT file
+		std::shared_ptr<vfsStream> file(Emu.GetVFS().OpenFile(path.get_ptr(), o_read));
+
+		if (file && file->IsOpened() && edat_open(local_path, file))
+		{
+			info.size = file->GetSize();
+		}
+	}
+
 	sb->mode = info.is_directory ? CELL_FS_S_IFDIR | 0777 : CELL_FS_S_IFREG | 0666;
 	sb->uid = 1; // ???
 	sb->gid = 1; // ???
@@ -334,7 +434,10 @@ s32 sys_fs_fstat(u32 fd, vm::ptr<CellFsStat> sb)
 
 	std::lock_guard<std::mutex> lock(file->mutex);
 
-	const auto local_file = dynamic_cast<vfsLocalFile*>(file->file.get());
+	// encrypted file (stat the underlying file, report decrypted size)
+	const auto edat = dynamic_cast<EDATADecrypter*>(file->file.get());
+
+	const auto local_file = dynamic_cast<vfsLocalFile*>(edat ? edat->GetInput().get() : file->file.get());
 
 	if (!local_file)
 	{
@@ -349,6 +452,11 @@ s32 sys_fs_fstat(u32 fd, vm::ptr<CellFsStat> sb)
 		return CELL_FS_EIO; // ???
 	}
 
+	if (edat)
+	{
+		info.size = edat->GetSize();
+	}
+
 	sb->mode = info.is_directory ? CELL_FS_S_IFDIR | 0777 : CELL_FS_S_IFREG | 0666;
 	sb->uid = 1; // ???
 	sb->gid = 1; // ???
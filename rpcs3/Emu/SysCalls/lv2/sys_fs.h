@@ -223,6 +223,9 @@ struct lv2_dir_t
 
 REG_ID_TYPE(lv2_dir_t, 0x73); // SYS_FS_FD_OBJECT
 
+// Register the license of EDAT file (found by sceNpDrmIsAvailable()), the file is decrypted on demand when opened for reading
+void sys_fs_set_edat_license(const std::string& local_path, const u8* klicensee, const u8* rifkey);
+
 // SysCalls
 s32 sys_fs_test(u32 arg1, u32 arg2, vm::ptr<u32> arg3, u32 arg4, vm::ptr<char> arg5, u32 arg6);
 s32 sys_fs_open(vm::cptr<char> path, s32 flags, vm::ptr<u32> fd, s32 mode, vm::cptr<void> arg, u64 size);
@@ -12,9 +12,9 @@ SysCallBase sys_lwcond("sys_lwcond");
 
 extern u64 get_system_time();
 
-void lv2_lwcond_t::notify(lv2_lock_t & lv2_lock, sleep_queue_t::value_type& thread, const std::shared_ptr<lv2_lwmutex_t>& mutex, bool mode2)
+void lv2_lwcond_t::notify(lv2_lock_t & lv2_lock, sleep_queue_t::value_type& thread, const std::shared_ptr<lv2_lwmutex_t>& target, bool mode2)
 {
-	CHECK_LV2_LOCK(lv2_lock);
+	CHECK_LV2_OBJECT_LOCK(lv2_lock, mutex->sync);
 
 	auto& ppu = static_cast<PPUThread&>(*thread);
 
@@ -22,12 +22,12 @@ void lv2_lwcond_t::notify(lv2_lock_t & lv2_lock, sleep_queue_t::value_type& thre
 
 	if (!mode2)
 	{
-		if (!mutex->signaled)
+		if (!target->signaled)
 		{
-			return mutex->sq.emplace_back(thread);
+			return target->sq.emplace_back(thread);
 		}
 
-		mutex->signaled--;
+		target->signaled--;
 	}
 
 	if (!ppu.signal())
@@ -40,7 +40,14 @@ s32 _sys_lwcond_create(vm::ptr<u32> lwcond_id, u32 lwmutex_id, vm::ptr<sys_lwcon
 {
 	sys_lwcond.Warning("_sys_lwcond_create(lwcond_id=*0x%x, lwmutex_id=0x%x, control=*0x%x, name=0x%llx, arg5=0x%x)", lwcond_id, lwmutex_id, control, name, arg5);
 
-	*lwcond_id = Emu.GetIdManager().make<lv2_lwcond_t>(name);
+	const auto mutex = Emu.GetIdManager().get<lv2_lwmutex_t>(lwmutex_id);
+
+	if (!mutex)
+	{
+		return CELL_ESRCH;
+	}
+
+	*lwcond_id = Emu.GetIdManager().make<lv2_lwcond_t>(mutex, name);
 
 	return CELL_OK;
 }
@@ -49,8 +56,6 @@ s32 _sys_lwcond_destroy(u32 lwcond_id)
 {
 	sys_lwcond.Warning("_sys_lwcond_destroy(lwcond_id=0x%x)", lwcond_id);
 
-	LV2_LOCK;
-
 	const auto cond = Emu.GetIdManager().get<lv2_lwcond_t>(lwcond_id);
 
 	if (!cond)
@@ -58,6 +63,14 @@ s32 _sys_lwcond_destroy(u32 lwcond_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(cond->mutex->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_lwcond_t>(lwcond_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (!cond->sq.empty())
 	{
 		return CELL_EBUSY;
@@ -72,8 +85,6 @@ s32 _sys_lwcond_signal(u32 lwcond_id, u32 lwmutex_id, u32 ppu_thread_id, u32 mod
 {
 	sys_lwcond.Log("_sys_lwcond_signal(lwcond_id=0x%x, lwmutex_id=0x%x, ppu_thread_id=0x%x, mode=%d)", lwcond_id, lwmutex_id, ppu_thread_id, mode);
 
-	LV2_LOCK;
-
 	const auto cond = Emu.GetIdManager().get<lv2_lwcond_t>(lwcond_id);
 	const auto mutex = Emu.GetIdManager().get<lv2_lwmutex_t>(lwmutex_id);
 
@@ -82,6 +93,20 @@ s32 _sys_lwcond_signal(u32 lwcond_id, u32 lwmutex_id, u32 ppu_thread_id, u32 mod
 		return CELL_ESRCH;
 	}
 
+	if (mutex && mutex != cond->mutex)
+	{
+		sys_lwcond.Error("_sys_lwcond_signal(): lwmutex 0x%x is not associated with lwcond 0x%x", lwmutex_id, lwcond_id);
+		return CELL_ESRCH;
+	}
+
+	lv2_lock_t lv2_lock(cond->mutex->sync);
+
+	// check whether the objects were destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_lwcond_t>(lwcond_id) || (lwmutex_id && !Emu.GetIdManager().check_id<lv2_lwmutex_t>(lwmutex_id)))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (mode != 1 && mode != 2 && mode != 3)
 	{
 		throw EXCEPTION("Unknown mode (%d)", mode);
@@ -125,8 +150,6 @@ s32 _sys_lwcond_signal_all(u32 lwcond_id, u32 lwmutex_id, u32 mode)
 {
 	sys_lwcond.Log("_sys_lwcond_signal_all(lwcond_id=0x%x, lwmutex_id=0x%x, mode=%d)", lwcond_id, lwmutex_id, mode);
 
-	LV2_LOCK;
-
 	const auto cond = Emu.GetIdManager().get<lv2_lwcond_t>(lwcond_id);
 	const auto mutex = Emu.GetIdManager().get<lv2_lwmutex_t>(lwmutex_id);
 
@@ -135,6 +158,20 @@ s32 _sys_lwcond_signal_all(u32 lwcond_id, u32 lwmutex_id, u32 mode)
 		return CELL_ESRCH;
 	}
 
+	if (mutex && mutex != cond->mutex)
+	{
+		sys_lwcond.Error("_sys_lwcond_signal_all(): lwmutex 0x%x is not associated with lwcond 0x%x", lwmutex_id, lwcond_id);
+		return CELL_ESRCH;
+	}
+
+	lv2_lock_t lv2_lock(cond->mutex->sync);
+
+	// check whether the objects were destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_lwcond_t>(lwcond_id) || (lwmutex_id && !Emu.GetIdManager().check_id<lv2_lwmutex_t>(lwmutex_id)))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (mode != 1 && mode != 2)
 	{
 		throw EXCEPTION("Unknown mode (%d)", mode);
@@ -163,8 +200,6 @@ s32 _sys_lwcond_queue_wait(PPUThread& ppu, u32 lwcond_id, u32 lwmutex_id, u64 ti
 
 	const u64 start_time = get_system_time();
 
-	LV2_LOCK;
-
 	const auto cond = Emu.GetIdManager().get<lv2_lwcond_t>(lwcond_id);
 	const auto mutex = Emu.GetIdManager().get<lv2_lwmutex_t>(lwmutex_id);
 
@@ -173,6 +208,20 @@ s32 _sys_lwcond_queue_wait(PPUThread& ppu, u32 lwcond_id, u32 lwmutex_id, u64 ti
 		return CELL_ESRCH;
 	}
 
+	if (mutex != cond->mutex)
+	{
+		sys_lwcond.Error("_sys_lwcond_queue_wait(): lwmutex 0x%x is not associated with lwcond 0x%x", lwmutex_id, lwcond_id);
+		return CELL_ESRCH;
+	}
+
+	lv2_lock_t lv2_lock(mutex->sync);
+
+	// check whether the objects were destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_lwcond_t>(lwcond_id) || !Emu.GetIdManager().check_id<lv2_lwmutex_t>(lwmutex_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	// finalize unlocking the mutex
 	mutex->unlock(lv2_lock);
 
@@ -5,6 +5,7 @@
 namespace vm { using namespace ps3; }
 
 struct sys_lwmutex_t;
+struct lv2_lwmutex_t;
 
 struct sys_lwcond_attribute_t
 {
@@ -23,16 +24,18 @@ struct sys_lwcond_t
 
 struct lv2_lwcond_t
 {
+	const std::shared_ptr<lv2_lwmutex_t> mutex; // associated lightweight mutex (its lock protects this object)
 	const u64 name;
 
 	sleep_queue_t sq;
 
-	lv2_lwcond_t(u64 name)
-		: name(name)
+	lv2_lwcond_t(const std::shared_ptr<lv2_lwmutex_t>& mutex, u64 name)
+		: mutex(mutex)
+		, name(name)
 	{
 	}
 
-	void notify(lv2_lock_t& lv2_lock, sleep_queue_t::value_type& thread, const std::shared_ptr<lv2_lwmutex_t>& mutex, bool mode2);
+	void notify(lv2_lock_t& lv2_lock, sleep_queue_t::value_type& thread, const std::shared_ptr<lv2_lwmutex_t>& target, bool mode2);
 };
 
 REG_ID_TYPE(lv2_lwcond_t, 0x97); // SYS_LWCOND_OBJECT
@@ -13,7 +13,7 @@ extern u64 get_system_time();
 
 void lv2_lwmutex_t::unlock(lv2_lock_t& lv2_lock)
 {
-	CHECK_LV2_LOCK(lv2_lock);
+	CHECK_LV2_OBJECT_LOCK(lv2_lock, sync);
 
 	if (signaled)
 	{
@@ -59,8 +59,6 @@ s32 _sys_lwmutex_destroy(u32 lwmutex_id)
 {
 	sys_lwmutex.Warning("_sys_lwmutex_destroy(lwmutex_id=0x%x)", lwmutex_id);
 
-	LV2_LOCK;
-
 	const auto mutex = Emu.GetIdManager().get<lv2_lwmutex_t>(lwmutex_id);
 
 	if (!mutex)
@@ -68,6 +66,14 @@ s32 _sys_lwmutex_destroy(u32 lwmutex_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(mutex->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_lwmutex_t>(lwmutex_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (!mutex->sq.empty())
 	{
 		return CELL_EBUSY;
@@ -84,8 +90,6 @@ s32 _sys_lwmutex_lock(PPUThread& ppu, u32 lwmutex_id, u64 timeout)
 
 	const u64 start_time = get_system_time();
 
-	LV2_LOCK;
-
 	const auto mutex = Emu.GetIdManager().get<lv2_lwmutex_t>(lwmutex_id);
 
 	if (!mutex)
@@ -93,6 +97,14 @@ s32 _sys_lwmutex_lock(PPUThread& ppu, u32 lwmutex_id, u64 timeout)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(mutex->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_lwmutex_t>(lwmutex_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (mutex->signaled)
 	{
 		mutex->signaled--;
@@ -131,8 +143,6 @@ s32 _sys_lwmutex_trylock(u32 lwmutex_id)
 {
 	sys_lwmutex.Log("_sys_lwmutex_trylock(lwmutex_id=0x%x)", lwmutex_id);
 
-	LV2_LOCK;
-
 	const auto mutex = Emu.GetIdManager().get<lv2_lwmutex_t>(lwmutex_id);
 
 	if (!mutex)
@@ -140,6 +150,14 @@ s32 _sys_lwmutex_trylock(u32 lwmutex_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(mutex->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_lwmutex_t>(lwmutex_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (!mutex->sq.empty() || !mutex->signaled)
 	{
 		return CELL_EBUSY;
@@ -154,8 +172,6 @@ s32 _sys_lwmutex_unlock(u32 lwmutex_id)
 {
 	sys_lwmutex.Log("_sys_lwmutex_unlock(lwmutex_id=0x%x)", lwmutex_id);
 
-	LV2_LOCK;
-
 	const auto mutex = Emu.GetIdManager().get<lv2_lwmutex_t>(lwmutex_id);
 
 	if (!mutex)
@@ -163,6 +179,14 @@ s32 _sys_lwmutex_unlock(u32 lwmutex_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(mutex->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_lwmutex_t>(lwmutex_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	mutex->unlock(lv2_lock);
 
 	return CELL_OK;
@@ -59,6 +59,8 @@ struct lv2_lwmutex_t
 	// this object is not truly a mutex and its syscall names may be wrong, it's probably a sleep queue or something
 	std::atomic<u32> signaled{ 0 };
 
+	std::mutex sync; // object lock (also used by associated lightweight condition variables)
+
 	sleep_queue_t sq;
 
 	lv2_lwmutex_t(u32 protocol, u64 name)
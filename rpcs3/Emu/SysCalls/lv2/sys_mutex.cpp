@@ -13,7 +13,7 @@ extern u64 get_system_time();
 
 void lv2_mutex_t::unlock(lv2_lock_t& lv2_lock)
 {
-	CHECK_LV2_LOCK(lv2_lock);
+	CHECK_LV2_OBJECT_LOCK(lv2_lock, sync);
 
 	owner.reset();
 
@@ -71,8 +71,6 @@ s32 sys_mutex_destroy(u32 mutex_id)
 {
 	sys_mutex.Warning("sys_mutex_destroy(mutex_id=0x%x)", mutex_id);
 
-	LV2_LOCK;
-
 	const auto mutex = Emu.GetIdManager().get<lv2_mutex_t>(mutex_id);
 
 	if (!mutex)
@@ -80,6 +78,14 @@ s32 sys_mutex_destroy(u32 mutex_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(mutex->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_mutex_t>(mutex_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (mutex->owner || mutex->sq.size())
 	{
 		return CELL_EBUSY;
@@ -101,8 +107,6 @@ s32 sys_mutex_lock(PPUThread& ppu, u32 mutex_id, u64 timeout)
 
 	const u64 start_time = get_system_time();
 
-	LV2_LOCK;
-
 	const auto mutex = Emu.GetIdManager().get<lv2_mutex_t>(mutex_id);
 
 	if (!mutex)
@@ -110,6 +114,14 @@ s32 sys_mutex_lock(PPUThread& ppu, u32 mutex_id, u64 timeout)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(mutex->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_mutex_t>(mutex_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	// check current ownership
 	if (mutex->owner.get() == &ppu)
 	{
@@ -173,8 +185,6 @@ s32 sys_mutex_trylock(PPUThread& ppu, u32 mutex_id)
 {
 	sys_mutex.Log("sys_mutex_trylock(mutex_id=0x%x)", mutex_id);
 
-	LV2_LOCK;
-
 	const auto mutex = Emu.GetIdManager().get<lv2_mutex_t>(mutex_id);
 
 	if (!mutex)
@@ -182,6 +192,14 @@ s32 sys_mutex_trylock(PPUThread& ppu, u32 mutex_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(mutex->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_mutex_t>(mutex_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	// check current ownership
 	if (mutex->owner.get() == &ppu)
 	{
@@ -215,8 +233,6 @@ s32 sys_mutex_unlock(PPUThread& ppu, u32 mutex_id)
 {
 	sys_mutex.Log("sys_mutex_unlock(mutex_id=0x%x)", mutex_id);
 
-	LV2_LOCK;
-
 	const auto mutex = Emu.GetIdManager().get<lv2_mutex_t>(mutex_id);
 
 	if (!mutex)
@@ -224,6 +240,14 @@ s32 sys_mutex_unlock(PPUThread& ppu, u32 mutex_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(mutex->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_mutex_t>(mutex_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	// check current ownership
 	if (mutex->owner.get() != &ppu)
 	{
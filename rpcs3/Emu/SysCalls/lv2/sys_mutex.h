@@ -31,6 +31,8 @@ struct lv2_mutex_t
 	std::atomic<u32> recursive_count{ 0 }; // count of recursive locks
 	std::shared_ptr<CPUThread> owner; // current mutex owner
 
+	std::mutex sync; // object lock (also used by associated condition variables)
+
 	sleep_queue_t sq;
 
 	lv2_mutex_t(bool recursive, u32 protocol, u64 name)
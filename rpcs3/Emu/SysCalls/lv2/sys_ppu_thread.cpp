@@ -20,10 +20,12 @@ void _sys_ppu_thread_exit(PPUThread& ppu, u64 errorcode)
 	// get all sys_mutex objects
 	for (auto& mutex : Emu.GetIdManager().get_all<lv2_mutex_t>())
 	{
+		lv2_lock_t mutex_lock(mutex->sync);
+
 		// unlock mutex if locked by this thread
 		if (mutex->owner.get() == &ppu)
 		{
-			mutex->unlock(lv2_lock);
+			mutex->unlock(mutex_lock);
 		}
 	}
 
@@ -13,7 +13,7 @@ extern u64 get_system_time();
 
 void lv2_rwlock_t::notify_all(lv2_lock_t& lv2_lock)
 {
-	CHECK_LV2_LOCK(lv2_lock);
+	CHECK_LV2_OBJECT_LOCK(lv2_lock, sync);
 
 	// pick a new writer if possible; protocol is ignored in current implementation
 	if (!readers && !writer && wsq.size())
@@ -77,8 +77,6 @@ s32 sys_rwlock_destroy(u32 rw_lock_id)
 {
 	sys_rwlock.Warning("sys_rwlock_destroy(rw_lock_id=0x%x)", rw_lock_id);
 
-	LV2_LOCK;
-
 	const auto rwlock = Emu.GetIdManager().get<lv2_rwlock_t>(rw_lock_id);
 
 	if (!rwlock)
@@ -86,6 +84,14 @@ s32 sys_rwlock_destroy(u32 rw_lock_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(rwlock->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_rwlock_t>(rw_lock_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (rwlock->readers || rwlock->writer || rwlock->rsq.size() || rwlock->wsq.size())
 	{
 		return CELL_EBUSY;
@@ -102,8 +108,6 @@ s32 sys_rwlock_rlock(PPUThread& ppu, u32 rw_lock_id, u64 timeout)
 
 	const u64 start_time = get_system_time();
 
-	LV2_LOCK;
-
 	const auto rwlock = Emu.GetIdManager().get<lv2_rwlock_t>(rw_lock_id);
 
 	if (!rwlock)
@@ -111,6 +115,14 @@ s32 sys_rwlock_rlock(PPUThread& ppu, u32 rw_lock_id, u64 timeout)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(rwlock->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_rwlock_t>(rw_lock_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (!rwlock->writer && rwlock->wsq.empty())
 	{
 		if (!++rwlock->readers)
@@ -157,8 +169,6 @@ s32 sys_rwlock_tryrlock(u32 rw_lock_id)
 {
 	sys_rwlock.Log("sys_rwlock_tryrlock(rw_lock_id=0x%x)", rw_lock_id);
 
-	LV2_LOCK;
-
 	const auto rwlock = Emu.GetIdManager().get<lv2_rwlock_t>(rw_lock_id);
 
 	if (!rwlock)
@@ -166,6 +176,14 @@ s32 sys_rwlock_tryrlock(u32 rw_lock_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(rwlock->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_rwlock_t>(rw_lock_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (rwlock->writer || rwlock->wsq.size())
 	{
 		return CELL_EBUSY;
@@ -183,8 +201,6 @@ s32 sys_rwlock_runlock(u32 rw_lock_id)
 {
 	sys_rwlock.Log("sys_rwlock_runlock(rw_lock_id=0x%x)", rw_lock_id);
 
-	LV2_LOCK;
-
 	const auto rwlock = Emu.GetIdManager().get<lv2_rwlock_t>(rw_lock_id);
 
 	if (!rwlock)
@@ -192,6 +208,14 @@ s32 sys_rwlock_runlock(u32 rw_lock_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(rwlock->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_rwlock_t>(rw_lock_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (!rwlock->readers)
 	{
 		return CELL_EPERM;
@@ -211,8 +235,6 @@ s32 sys_rwlock_wlock(PPUThread& ppu, u32 rw_lock_id, u64 timeout)
 
 	const u64 start_time = get_system_time();
 
-	LV2_LOCK;
-
 	const auto rwlock = Emu.GetIdManager().get<lv2_rwlock_t>(rw_lock_id);
 
 	if (!rwlock)
@@ -220,6 +242,14 @@ s32 sys_rwlock_wlock(PPUThread& ppu, u32 rw_lock_id, u64 timeout)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(rwlock->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_rwlock_t>(rw_lock_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (rwlock->writer.get() == &ppu)
 	{
 		return CELL_EDEADLK;
@@ -280,8 +310,6 @@ s32 sys_rwlock_trywlock(PPUThread& ppu, u32 rw_lock_id)
 {
 	sys_rwlock.Log("sys_rwlock_trywlock(rw_lock_id=0x%x)", rw_lock_id);
 
-	LV2_LOCK;
-
 	const auto rwlock = Emu.GetIdManager().get<lv2_rwlock_t>(rw_lock_id);
 
 	if (!rwlock)
@@ -289,6 +317,14 @@ s32 sys_rwlock_trywlock(PPUThread& ppu, u32 rw_lock_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(rwlock->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_rwlock_t>(rw_lock_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (rwlock->writer.get() == &ppu)
 	{
 		return CELL_EDEADLK;
@@ -308,8 +344,6 @@ s32 sys_rwlock_wunlock(PPUThread& ppu, u32 rw_lock_id)
 {
 	sys_rwlock.Log("sys_rwlock_wunlock(rw_lock_id=0x%x)", rw_lock_id);
 
-	LV2_LOCK;
-
 	const auto rwlock = Emu.GetIdManager().get<lv2_rwlock_t>(rw_lock_id);
 
 	if (!rwlock)
@@ -317,6 +351,14 @@ s32 sys_rwlock_wunlock(PPUThread& ppu, u32 rw_lock_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(rwlock->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_rwlock_t>(rw_lock_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (rwlock->writer.get() != &ppu)
 	{
 		return CELL_EPERM;
@@ -27,6 +27,8 @@ struct lv2_rwlock_t
 	std::atomic<u32> readers{ 0 }; // reader lock count
 	std::shared_ptr<CPUThread> writer; // writer lock owner
 
+	std::mutex sync; // object lock
+
 	sleep_queue_t rsq; // threads trying to acquire readed lock
 	sleep_queue_t wsq; // threads trying to acquire writer lock
 
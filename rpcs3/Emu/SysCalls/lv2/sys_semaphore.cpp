@@ -49,14 +49,20 @@ s32 sys_semaphore_destroy(u32 sem_id)
 {
 	sys_semaphore.Warning("sys_semaphore_destroy(sem_id=0x%x)", sem_id);
 
-	LV2_LOCK;
-
 	const auto sem = Emu.GetIdManager().get<lv2_sema_t>(sem_id);
 
 	if (!sem)
 	{
 		return CELL_ESRCH;
 	}
+
+	lv2_lock_t lv2_lock(sem->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_sema_t>(sem_id))
+	{
+		return CELL_ESRCH;
+	}
 	
 	if (sem->sq.size())
 	{
@@ -74,8 +80,6 @@ s32 sys_semaphore_wait(PPUThread& ppu, u32 sem_id, u64 timeout)
 
 	const u64 start_time = get_system_time();
 
-	LV2_LOCK;
-
 	const auto sem = Emu.GetIdManager().get<lv2_sema_t>(sem_id);
 
 	if (!sem)
@@ -83,6 +87,14 @@ s32 sys_semaphore_wait(PPUThread& ppu, u32 sem_id, u64 timeout)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(sem->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_sema_t>(sem_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (sem->value > 0)
 	{
 		sem->value--;
@@ -121,8 +133,6 @@ s32 sys_semaphore_trywait(u32 sem_id)
 {
 	sys_semaphore.Log("sys_semaphore_trywait(sem_id=0x%x)", sem_id);
 
-	LV2_LOCK;
-
 	const auto sem = Emu.GetIdManager().get<lv2_sema_t>(sem_id);
 
 	if (!sem)
@@ -130,6 +140,14 @@ s32 sys_semaphore_trywait(u32 sem_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(sem->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_sema_t>(sem_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (sem->value <= 0 || sem->sq.size())
 	{
 		return CELL_EBUSY;
@@ -144,8 +162,6 @@ s32 sys_semaphore_post(u32 sem_id, s32 count)
 {
 	sys_semaphore.Log("sys_semaphore_post(sem_id=0x%x, count=%d)", sem_id, count);
 
-	LV2_LOCK;
-
 	const auto sem = Emu.GetIdManager().get<lv2_sema_t>(sem_id);
 
 	if (!sem)
@@ -153,6 +169,14 @@ s32 sys_semaphore_post(u32 sem_id, s32 count)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(sem->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_sema_t>(sem_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (count < 0)
 	{
 		return CELL_EINVAL;
@@ -190,8 +214,6 @@ s32 sys_semaphore_get_value(u32 sem_id, vm::ptr<s32> count)
 {
 	sys_semaphore.Log("sys_semaphore_get_value(sem_id=0x%x, count=*0x%x)", sem_id, count);
 
-	LV2_LOCK;
-
 	if (!count)
 	{
 		return CELL_EFAULT;
@@ -204,6 +226,8 @@ s32 sys_semaphore_get_value(u32 sem_id, vm::ptr<s32> count)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(sem->sync);
+
 	*count = sem->value;
 
 	return CELL_OK;
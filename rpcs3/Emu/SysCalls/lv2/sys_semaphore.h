@@ -27,6 +27,8 @@ struct lv2_sema_t
 
 	std::atomic<s32> value;
 
+	std::mutex sync; // object lock
+
 	sleep_queue_t sq;
 
 	lv2_sema_t(u32 protocol, s32 max, u64 name, s32 value)
@@ -6,6 +6,7 @@
 
 #include "Emu/CPU/CPUThreadManager.h"
 #include "Emu/Cell/RawSPUThread.h"
+#include "Emu/Cell/SPUScheduler.h"
 #include "Emu/FS/vfsStreamMemory.h"
 #include "Emu/FS/vfsFile.h"
 #include "Loader/ELF32.h"
@@ -297,6 +298,9 @@ s32 sys_spu_thread_group_start(u32 id)
 
 	// SPU_THREAD_GROUP_STATUS_READY state is not used
 
+	// all threads of the group must be able to run at once
+	spu_scheduler_reserve(group->num);
+
 	group->state = SPU_THREAD_GROUP_STATUS_RUNNING;
 	group->join_state = 0;
 
@@ -4,10 +4,11 @@
 #include "Emu/IdManager.h"
 #include "Emu/SysCalls/SysCalls.h"
 
-#include "Utilities/Thread.h"
+#include "Emu/Cell/PPUThread.h"
 #include "sys_event.h"
 #include "sys_process.h"
 #include "sys_timer.h"
+#include "timer_queue.h"
 
 SysCallBase sys_timer("sys_timer");
 
@@ -17,51 +18,93 @@ lv2_timer_t::lv2_timer_t()
 	: start(0)
 	, period(0)
 	, state(SYS_TIMER_STATE_STOP)
+	, key(0)
 {
-	auto name = fmt::format("Timer[0x%x] Thread", Emu.GetIdManager().get_current_id());
+}
 
-	thread.start([name]{ return name; }, [this]()
+lv2_timer_t::~lv2_timer_t()
+{
+	if (key)
 	{
-		std::unique_lock<std::mutex> lock(thread.mutex);
+		timer_queue_remove(key);
+	}
+}
+
+void lv2_timer_t::schedule(lv2_lock_t& lv2_lock)
+{
+	CHECK_LV2_OBJECT_LOCK(lv2_lock, sync);
+
+	std::weak_ptr<lv2_timer_t> timer = shared_from_this();
 
-		while (thread.joinable())
+	key = timer_queue_add(start, [timer](u64 key)
+	{
+		if (const auto t = timer.lock())
 		{
-			CHECK_EMU_STATUS;
+			std::shared_ptr<lv2_event_queue_t> queue;
+			std::tuple<u64, u64, u64, u64> event;
 
-			if (state == SYS_TIMER_STATE_RUN)
 			{
-				LV2_LOCK;
+				lv2_lock_t lv2_lock(t->sync);
 
-				if (get_system_time() >= start)
+				queue = t->expire(lv2_lock, key, event);
+			}
+
+			if (queue)
+			{
+				lv2_lock_t lv2_lock(queue->sync);
+
+				// check whether the queue was destroyed before locking
+				if (Emu.GetIdManager().check_id<lv2_event_queue_t>(queue->id))
 				{
-					const auto queue = port.lock();
-
-					if (queue)
-					{
-						queue->push(lv2_lock, source, data1, data2, start);
-					}
-
-					if (period && queue)
-					{
-						start += period; // set next expiration time
-
-						continue; // hack: check again
-					}
-					else
-					{
-						state = SYS_TIMER_STATE_STOP; // stop if oneshot or the event port was disconnected (TODO: is it correct?)
-					}
+					queue->push(lv2_lock, std::get<0>(event), std::get<1>(event), std::get<2>(event), std::get<3>(event));
 				}
 			}
-
-			thread.cv.wait_for(lock, std::chrono::milliseconds(1));
 		}
 	});
 }
 
-lv2_timer_t::~lv2_timer_t()
+void lv2_timer_t::cancel(lv2_lock_t& lv2_lock)
 {
-	thread.join();
+	CHECK_LV2_OBJECT_LOCK(lv2_lock, sync);
+
+	if (key)
+	{
+		timer_queue_remove(key);
+		key = 0;
+	}
+}
+
+std::shared_ptr<lv2_event_queue_t> lv2_timer_t::expire(lv2_lock_t& lv2_lock, u64 key, std::tuple<u64, u64, u64, u64>& event)
+{
+	CHECK_LV2_OBJECT_LOCK(lv2_lock, sync);
+
+	// ignore if stopped or restarted after the entry was taken from the timer queue
+	if (this->key != key || state != SYS_TIMER_STATE_RUN)
+	{
+		return nullptr;
+	}
+
+	this->key = 0;
+
+	const auto queue = port.lock();
+
+	if (queue)
+	{
+		event = std::make_tuple(source, data1, data2, start);
+	}
+
+	if (period && queue)
+	{
+		start += period; // set next expiration time (fires immediately if already passed)
+
+		schedule(lv2_lock);
+	}
+	else
+	{
+		state = SYS_TIMER_STATE_STOP; // stop if oneshot or the event port was disconnected (TODO: is it correct?)
+	}
+
+	return queue;
 }
 
 s32 sys_timer_create(vm::ptr<u32> timer_id)
@@ -77,8 +120,6 @@ s32 sys_timer_destroy(u32 timer_id)
 {
 	sys_timer.Warning("sys_timer_destroy(timer_id=0x%x)", timer_id);
 
-	LV2_LOCK;
-
 	const auto timer = Emu.GetIdManager().get<lv2_timer_t>(timer_id);
 
 	if (!timer)
@@ -86,6 +127,14 @@ s32 sys_timer_destroy(u32 timer_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(timer->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_timer_t>(timer_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (!timer->port.expired())
 	{
 		return CELL_EISCONN;
@@ -100,8 +149,6 @@ s32 sys_timer_get_information(u32 timer_id, vm::ptr<sys_timer_information_t> inf
 {
 	sys_timer.Warning("sys_timer_get_information(timer_id=0x%x, info=*0x%x)", timer_id, info);
 
-	LV2_LOCK;
-
 	const auto timer = Emu.GetIdManager().get<lv2_timer_t>(timer_id);
 
 	if (!timer)
@@ -109,6 +156,14 @@ s32 sys_timer_get_information(u32 timer_id, vm::ptr<sys_timer_information_t> inf
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(timer->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_timer_t>(timer_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	info->next_expiration_time = timer->start;
 
 	info->period      = timer->period;
@@ -123,8 +178,6 @@ s32 _sys_timer_start(u32 timer_id, u64 base_time, u64 period)
 
 	const u64 start_time = get_system_time();
 
-	LV2_LOCK;
-
 	const auto timer = Emu.GetIdManager().get<lv2_timer_t>(timer_id);
 
 	if (!timer)
@@ -132,6 +185,14 @@ s32 _sys_timer_start(u32 timer_id, u64 base_time, u64 period)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(timer->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_timer_t>(timer_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (timer->state != SYS_TIMER_STATE_STOP)
 	{
 		return CELL_EBUSY;
@@ -167,7 +228,7 @@ s32 _sys_timer_start(u32 timer_id, u64 base_time, u64 period)
 	timer->period = period;
 	timer->state  = SYS_TIMER_STATE_RUN;
 
-	timer->thread.cv.notify_one();
+	timer->schedule(lv2_lock);
 
 	return CELL_OK;
 }
@@ -176,8 +237,6 @@ s32 sys_timer_stop(u32 timer_id)
 {
 	sys_timer.Warning("sys_timer_stop()");
 
-	LV2_LOCK;
-
 	const auto timer = Emu.GetIdManager().get<lv2_timer_t>(timer_id);
 
 	if (!timer)
@@ -185,7 +244,16 @@ s32 sys_timer_stop(u32 timer_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(timer->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_timer_t>(timer_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	timer->state = SYS_TIMER_STATE_STOP; // stop timer
+	timer->cancel(lv2_lock);
 
 	return CELL_OK;
 }
@@ -194,8 +262,6 @@ s32 sys_timer_connect_event_queue(u32 timer_id, u32 queue_id, u64 name, u64 data
 {
 	sys_timer.Warning("sys_timer_connect_event_queue(timer_id=0x%x, queue_id=0x%x, name=0x%llx, data1=0x%llx, data2=0x%llx)", timer_id, queue_id, name, data1, data2);
 
-	LV2_LOCK;
-
 	const auto timer = Emu.GetIdManager().get<lv2_timer_t>(timer_id);
 	const auto queue = Emu.GetIdManager().get<lv2_event_queue_t>(queue_id);
 
@@ -204,6 +270,14 @@ s32 sys_timer_connect_event_queue(u32 timer_id, u32 queue_id, u64 name, u64 data
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(timer->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_timer_t>(timer_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (!timer->port.expired())
 	{
 		return CELL_EISCONN;
@@ -221,8 +295,6 @@ s32 sys_timer_disconnect_event_queue(u32 timer_id)
 {
 	sys_timer.Warning("sys_timer_disconnect_event_queue(timer_id=0x%x)", timer_id);
 
-	LV2_LOCK;
-
 	const auto timer = Emu.GetIdManager().get<lv2_timer_t>(timer_id);
 
 	if (!timer)
@@ -230,6 +302,14 @@ s32 sys_timer_disconnect_event_queue(u32 timer_id)
 		return CELL_ESRCH;
 	}
 
+	lv2_lock_t lv2_lock(timer->sync);
+
+	// check whether the object was destroyed before locking
+	if (!Emu.GetIdManager().check_id<lv2_timer_t>(timer_id))
+	{
+		return CELL_ESRCH;
+	}
+
 	if (timer->port.expired())
 	{
 		return CELL_ENOTCONN;
@@ -237,53 +317,34 @@ s32 sys_timer_disconnect_event_queue(u32 timer_id)
 
 	timer->port.reset(); // disconnect event queue
 	timer->state = SYS_TIMER_STATE_STOP; // stop timer
+	timer->cancel(lv2_lock);
 
 	return CELL_OK;
 }
 
-s32 sys_timer_sleep(u32 sleep_time)
+s32 sys_timer_sleep(PPUThread& ppu, u32 sleep_time)
 {
 	sys_timer.Log("sys_timer_sleep(sleep_time=%d)", sleep_time);
 
-	const u64 start_time = get_system_time();
-
-	const u64 useconds = sleep_time * 1000000ull;
-
-	u64 passed;
-
-	while (useconds > (passed = get_system_time() - start_time) + 1000)
-	{
-		CHECK_EMU_STATUS;
-
-		std::this_thread::sleep_for(std::chrono::milliseconds(1));
-	}
-	
-	if (useconds > passed)
-	{
-		std::this_thread::sleep_for(std::chrono::microseconds(useconds - passed));
-	}
-
-	return CELL_OK;
+	return sys_timer_usleep(ppu, sleep_time * 1000000ull);
 }
 
-s32 sys_timer_usleep(u64 sleep_time)
+s32 sys_timer_usleep(PPUThread& ppu, u64 sleep_time)
 {
 	sys_timer.Log("sys_timer_usleep(sleep_time=0x%llx)", sleep_time);
 
 	const u64 start_time = get_system_time();
 
+	// wait on the thread's own condition variable (notified on emulation stop)
+	std::unique_lock<std::mutex> lock(ppu.mutex);
+
 	u64 passed;
 
-	while (sleep_time > (passed = get_system_time() - start_time) + 1000)
+	while (sleep_time > (passed = get_system_time() - start_time))
 	{
 		CHECK_EMU_STATUS;
 
-		std::this_thread::sleep_for(std::chrono::milliseconds(1));
-	}
-
-	if (sleep_time > passed)
-	{
-		std::this_thread::sleep_for(std::chrono::microseconds(sleep_time - passed));
+		ppu.cv.wait_for(lock, std::chrono::microseconds(sleep_time - passed));
 	}
 
 	return CELL_OK;
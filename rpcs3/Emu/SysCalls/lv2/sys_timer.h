@@ -1,7 +1,5 @@
 #pragma once
 
-#include "Utilities/Thread.h"
-
 namespace vm { using namespace ps3; }
 
 // Timer State
@@ -19,7 +17,7 @@ struct sys_timer_information_t
 	be_t<u32> pad;
 };
 
-struct lv2_timer_t final
+struct lv2_timer_t final : std::enable_shared_from_this<lv2_timer_t>
 {
 	std::weak_ptr<lv2_event_queue_t> port; // event queue
 	u64 source; // event source
@@ -31,14 +29,27 @@ struct lv2_timer_t final
 
 	std::atomic<u32> state; // timer state
 
-	thread_t thread; // timer thread
+	u64 key; // timer queue entry (0 if not scheduled)
+
+	std::mutex sync; // object lock
 
 	lv2_timer_t();
 	~lv2_timer_t();
+
+	// add timer queue entry for the next expiration time
+	void schedule(lv2_lock_t& lv2_lock);
+
+	// remove timer queue entry if scheduled
+	void cancel(lv2_lock_t& lv2_lock);
+
+	// timer queue callback, returns the event queue to send the event to (sent after unlocking the timer)
+	std::shared_ptr<lv2_event_queue_t> expire(lv2_lock_t& lv2_lock, u64 key, std::tuple<u64, u64, u64, u64>& event);
 };
 
 REG_ID_TYPE(lv2_timer_t, 0x11); // SYS_TIMER_OBJECT
 
+class PPUThread;
+
 s32 sys_timer_create(vm::ptr<u32> timer_id);
 s32 sys_timer_destroy(u32 timer_id);
 s32 sys_timer_get_information(u32 timer_id, vm::ptr<sys_timer_information_t> info);
@@ -46,5 +57,5 @@ s32 _sys_timer_start(u32 timer_id, u64 basetime, u64 period); // basetime type c
 s32 sys_timer_stop(u32 timer_id);
 s32 sys_timer_connect_event_queue(u32 timer_id, u32 queue_id, u64 name, u64 data1, u64 data2);
 s32 sys_timer_disconnect_event_queue(u32 timer_id);
-s32 sys_timer_sleep(u32 sleep_time);
-s32 sys_timer_usleep(u64 sleep_time);
+s32 sys_timer_sleep(PPUThread& ppu, u32 sleep_time);
+s32 sys_timer_usleep(PPUThread& ppu, u64 sleep_time);
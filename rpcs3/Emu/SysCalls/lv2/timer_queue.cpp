@@ -0,0 +1,129 @@
+#include "stdafx.h"
+#include "Utilities/Log.h"
+#include "Utilities/Thread.h"
+#include "Emu/System.h"
+
+#include "timer_queue.h"
+
+extern u64 get_system_time();
+
+struct timer_queue_t
+{
+	std::mutex mutex;
+	std::condition_variable cv;
+
+	thread_t thread;
+
+	bool stopped = false;
+
+	u64 last_key = 0;
+
+	// entries ordered by deadline (key is used to resolve ties)
+	std::map<std::pair<u64, u64>, timer_queue_func_t> entries;
+
+	// key -> deadline
+	std::unordered_map<u64, u64> deadlines;
+
+	void task()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (!stopped)
+		{
+			if (entries.empty())
+			{
+				cv.wait(lock);
+				continue;
+			}
+
+			const auto first = entries.begin();
+			const u64 time = get_system_time();
+
+			if (first->first.first > time)
+			{
+				cv.wait_for(lock, std::chrono::microseconds(first->first.first - time));
+				continue;
+			}
+
+			const u64 key = first->first.second;
+			const auto func = std::move(first->second);
+
+			entries.erase(first);
+			deadlines.erase(key);
+
+			lock.unlock();
+
+			func(key);
+
+			lock.lock();
+		}
+	}
+};
+
+timer_queue_t g_timer_queue;
+
+u64 timer_queue_add(u64 deadline, timer_queue_func_t func)
+{
+	std::lock_guard<std::mutex> lock(g_timer_queue.mutex);
+
+	// entries added while the emulation is stopping are dropped (the thread is being joined)
+	if (Emu.IsStopped())
+	{
+		return ++g_timer_queue.last_key;
+	}
+
+	if (!g_timer_queue.thread.joinable())
+	{
+		g_timer_queue.stopped = false;
+
+		g_timer_queue.thread.start([]{ return std::string("Timer Queue Thread"); }, []{ g_timer_queue.task(); });
+	}
+
+	const u64 key = ++g_timer_queue.last_key;
+
+	const auto pos = g_timer_queue.entries.emplace(std::make_pair(deadline, key), std::move(func)).first;
+
+	g_timer_queue.deadlines.emplace(key, deadline);
+
+	// wake up the thread if the new entry is the first one
+	if (pos == g_timer_queue.entries.begin())
+	{
+		g_timer_queue.cv.notify_one();
+	}
+
+	return key;
+}
+
+bool timer_queue_remove(u64 key)
+{
+	std::lock_guard<std::mutex> lock(g_timer_queue.mutex);
+
+	const auto found = g_timer_queue.deadlines.find(key);
+
+	if (found == g_timer_queue.deadlines.end())
+	{
+		return false;
+	}
+
+	g_timer_queue.entries.erase(std::make_pair(found->second, key));
+	g_timer_queue.deadlines.erase(found);
+
+	return true;
+}
+
+void timer_queue_stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(g_timer_queue.mutex);
+
+		g_timer_queue.stopped = true;
+		g_timer_queue.entries.clear();
+		g_timer_queue.deadlines.clear();
+		g_timer_queue.cv.notify_one();
+	}
+
+	if (g_timer_queue.thread.joinable())
+	{
+		g_timer_queue.thread.join();
+	}
+}
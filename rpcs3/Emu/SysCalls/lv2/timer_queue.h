@@ -0,0 +1,16 @@
+#pragma once
+
+// Single thread executing callbacks at specified deadlines (in get_system_time() units, microseconds).
+// Replaces per-object polling threads (e.g. lv2 timers): idle entries cost neither threads nor wakeups.
+// Callbacks are called without internal lock held, so they may use LV2_LOCK or add new entries (lock order: LV2_LOCK -> timer queue).
+
+using timer_queue_func_t = std::function<void(u64 key)>;
+
+// add callback called once at the deadline (or immediately if already passed), returns unique key (never 0)
+u64 timer_queue_add(u64 deadline, timer_queue_func_t func);
+
+// remove the callback, returns false if it's not found (already called or being called)
+bool timer_queue_remove(u64 key);
+
+// stop the timer thread and drop all entries (called on emulation stop)
+void timer_queue_stop();
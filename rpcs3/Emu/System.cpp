@@ -1,6 +1,8 @@
 #include "stdafx.h"
+#include "Ini.h"
 #include "Utilities/Log.h"
 #include "Utilities/File.h"
+#include "Utilities/rPlatform.h"
 #include "Emu/Memory/Memory.h"
 #include "Emu/System.h"
 
@@ -8,6 +10,8 @@
 #include "Emu/SysCalls/ModuleManager.h"
 #include "Emu/Cell/PPUThread.h"
 #include "Emu/Cell/SPUThread.h"
+#include "Emu/Cell/PPUScheduler.h"
+#include "Emu/Cell/SPUScheduler.h"
 #include "Emu/Cell/PPUInstrTable.h"
 #include "Emu/FS/vfsFile.h"
 #include "Emu/FS/vfsLocalFile.h"
@@ -15,7 +19,13 @@
 #include "Emu/DbgCommand.h"
 
 #include "Emu/CPU/CPUThreadManager.h"
+#include "Emu/CPU/CPUProfiler.h"
 #include "Emu/SysCalls/Callback.h"
+#include "Emu/SysCalls/HLETrace.h"
+#include "Emu/SysCalls/lv2/timer_queue.h"
+#include "Emu/SysCalls/lv2/sys_mutex.h"
+#include "Emu/SysCalls/lv2/sys_lwmutex.h"
+#include "Emu/SysCalls/lv2/sys_semaphore.h"
 #include "Emu/IdManager.h"
 #include "Emu/Io/Pad.h"
 #include "Emu/Io/Keyboard.h"
@@ -37,11 +47,67 @@ static const std::string& BreakPointsDBName = "BreakPoints.dat";
 static const u16 bpdb_version = 0x1000;
 extern std::atomic<u32> g_thread_count;
 
+// size limit of the decrypted SELF cache (bytes)
+static const u64 g_self_cache_max = 512 * 1024 * 1024;
+
 extern u64 get_system_time();
 extern void finalize_ppu_exec_map();
 extern void finalize_psv_modules();
 extern void clear_all_psv_objects();
 
+// remove least recently used images (.time file is rewritten on every use) until the cache fits g_self_cache_max
+static void self_cache_evict(const std::string& cache_dir)
+{
+	struct entry_t
+	{
+		std::string digest;
+		u64 size;
+		time_t used;
+	};
+
+	std::vector<entry_t> entries;
+
+	u64 total = 0;
+
+	fs::dir dir(cache_dir);
+
+	std::string name;
+	fs::stat_t info;
+
+	for (bool is_ok = dir.get_first(name, info); is_ok; is_ok = dir.get_next(name, info))
+	{
+		if (info.is_directory || name.size() <= 4 || name.compare(name.size() - 4, 4, ".elf"))
+		{
+			continue;
+		}
+
+		const std::string digest = name.substr(0, name.size() - 4);
+
+		fs::stat_t time_info;
+
+		entries.push_back({ digest, info.size, fs::stat(cache_dir + digest + ".time", time_info) ? time_info.mtime : 0 });
+
+		total += info.size;
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const entry_t& a, const entry_t& b) { return a.used < b.used; });
+
+	for (const auto& entry : entries)
+	{
+		if (total <= g_self_cache_max)
+		{
+			break;
+		}
+
+		fs::remove_file(cache_dir + entry.digest + ".elf");
+		fs::remove_file(cache_dir + entry.digest + ".time");
+
+		total -= entry.size;
+
+		LOG_NOTICE(LOADER, "Decrypted image %s removed from cache", entry.digest);
+	}
+}
+
 Emulator::Emulator()
 	: m_status(Stopped)
 	, m_mode(DisAsm)
@@ -166,12 +232,62 @@ void Emulator::Load()
 			m_path = elf_dir + base_name + ".decrypted" + ext;
 		}
 
-		LOG_NOTICE(LOADER, "Decrypting '%s%s'...", elf_dir, full_name);
+		// decrypted images are cached by the SELF header digest (host directory, not visible to the guest)
+		const std::string cache_dir = GetEmulatorPath() + "/cache/self/";
+
+		std::string digest;
+
+		const auto start = std::chrono::steady_clock::now();
+
+		auto elapsed_ms = [&]()
+		{
+			return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+		};
 
-		if (!DecryptSelf(m_path, elf_dir + full_name))
+		if (GetSelfDigest(elf_dir + full_name, digest) && fs::is_file(cache_dir + digest + ".elf") && fs::copy_file(cache_dir + digest + ".elf", m_path, true))
 		{
-			m_status = Stopped;
-			return;
+			// the decryption time is stored along with the image
+			std::string saved;
+			fs::file time_f(cache_dir + digest + ".time");
+
+			if (time_f)
+			{
+				saved.resize(time_f.size());
+
+				if (!saved.empty())
+				{
+					time_f.read(&saved.front(), saved.size());
+				}
+
+				time_f.close();
+			}
+
+			// mark the image as recently used
+			fs::file(cache_dir + digest + ".time", o_write | o_create | o_trunc).write(saved.data(), saved.size());
+
+			LOG_SUCCESS(LOADER, "Decrypted '%s%s' found in cache (%lld ms, decryption took %s ms)", elf_dir, full_name, elapsed_ms(), saved.empty() ? "?" : saved);
+		}
+		else
+		{
+			LOG_NOTICE(LOADER, "Decrypting '%s%s'...", elf_dir, full_name);
+
+			if (!DecryptSelf(m_path, elf_dir + full_name))
+			{
+				m_status = Stopped;
+				return;
+			}
+
+			const auto time = elapsed_ms();
+
+			LOG_NOTICE(LOADER, "Decryption took %lld ms", time);
+
+			if (!digest.empty() && fs::create_path(cache_dir) && fs::copy_file(m_path, cache_dir + digest + ".elf", true))
+			{
+				const std::string saved = std::to_string(time);
+				fs::file(cache_dir + digest + ".time", o_write | o_create | o_trunc).write(saved.data(), saved.size());
+
+				self_cache_evict(cache_dir);
+			}
 		}
 	}
 
@@ -276,6 +392,19 @@ void Emulator::Run()
 	m_pause_amend_time = 0;
 	m_status = Running;
 
+	if (Ini.HLETrace.GetValue())
+	{
+		hle_trace_start(rPlatform::getConfigDir() + "HLETrace.bin");
+	}
+
+	if (Ini.CPUProfiler.GetValue())
+	{
+		cpu_profiler_start();
+	}
+
+	ppu_scheduler_init(Ini.PPUThreadSlots.GetValue());
+	spu_scheduler_init(Ini.SPUThreadSlots.GetValue());
+
 	GetCPU().Exec();
 	SendDbgCommand(DID_STARTED_EMU);
 }
@@ -349,6 +478,8 @@ void Emulator::Stop()
 		return;
 	}
 
+	cpu_profiler_stop(rPlatform::getConfigDir() + "profile.folded");
+
 	SendDbgCommand(DID_STOP_EMU);
 
 	{
@@ -367,6 +498,34 @@ void Emulator::Stop()
 
 	LOG_NOTICE(GENERAL, "All threads signaled...");
 
+	// threads sleeping on lv2 object locks must be signaled with that lock held
+	const auto notify_object_waiters = [this](std::mutex& sync)
+	{
+		std::lock_guard<std::mutex> lock(sync);
+
+		for (auto& t : GetCPU().GetAllThreads())
+		{
+			t->cv.notify_one();
+		}
+	};
+
+	for (auto& mutex : GetIdManager().get_all<lv2_mutex_t>())
+	{
+		notify_object_waiters(mutex->sync);
+	}
+
+	for (auto& mutex : GetIdManager().get_all<lv2_lwmutex_t>())
+	{
+		notify_object_waiters(mutex->sync);
+	}
+
+	for (auto& sema : GetIdManager().get_all<lv2_sema_t>())
+	{
+		notify_object_waiters(sema->sync);
+	}
+
+	timer_queue_stop();
+
 	while (g_thread_count)
 	{
 		std::this_thread::sleep_for(std::chrono::milliseconds(1));
@@ -374,6 +533,8 @@ void Emulator::Stop()
 
 	LOG_NOTICE(GENERAL, "All threads stopped...");
 
+	hle_trace_stop();
+
 	finalize_psv_modules();
 	clear_all_psv_objects();
 
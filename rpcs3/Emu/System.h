@@ -204,14 +204,20 @@ extern Emulator Emu;
 
 using lv2_lock_t = std::unique_lock<std::mutex>;
 
+inline bool check_lv2_lock(lv2_lock_t& lv2_lock, std::mutex& mutex)
+{
+	return lv2_lock.owns_lock() && lv2_lock.mutex() == &mutex;
+}
+
 inline bool check_lv2_lock(lv2_lock_t& lv2_lock)
 {
-	return lv2_lock.owns_lock() && lv2_lock.mutex() == &Emu.GetCoreMutex();
+	return check_lv2_lock(lv2_lock, Emu.GetCoreMutex());
 }
 
 #define LV2_LOCK lv2_lock_t lv2_lock(Emu.GetCoreMutex())
 #define LV2_DEFER_LOCK lv2_lock_t lv2_lock
 #define CHECK_LV2_LOCK(x) if (!check_lv2_lock(x)) throw EXCEPTION("lv2_lock is invalid or not locked")
+#define CHECK_LV2_OBJECT_LOCK(x, m) if (!check_lv2_lock(x, m)) throw EXCEPTION("lv2_lock is invalid or not locked")
 #define CHECK_EMU_STATUS if (Emu.IsStopped()) throw EXCEPTION("Aborted (emulation stopped)")
 
 typedef void(*CallAfterCbType)(std::function<void()> func);
@@ -399,6 +399,9 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 	wxStaticBoxSizer* s_round_llvm = new wxStaticBoxSizer(wxVERTICAL, p_core, _("LLVM config"));
 	wxStaticBoxSizer* s_round_llvm_range = new wxStaticBoxSizer(wxHORIZONTAL, p_core, _("Excluded block range"));
 	wxStaticBoxSizer* s_round_llvm_threshold = new wxStaticBoxSizer(wxHORIZONTAL, p_core, _("Compilation threshold"));
+	wxStaticBoxSizer* s_round_vdec_threads = new wxStaticBoxSizer(wxVERTICAL, p_core, _("Video decoder threads"));
+	wxStaticBoxSizer* s_round_ppu_slots = new wxStaticBoxSizer(wxVERTICAL, p_core, _("PPU threads running at once"));
+	wxStaticBoxSizer* s_round_spu_slots = new wxStaticBoxSizer(wxVERTICAL, p_core, _("SPU threads running at once"));
 
 	// Graphics
 	wxStaticBoxSizer* s_round_gs_render = new wxStaticBoxSizer(wxVERTICAL, p_graphics, _("Render"));
@@ -429,6 +432,9 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 
 	wxComboBox* cbox_cpu_decoder      = new wxComboBox(p_core, wxID_ANY);
 	wxComboBox* cbox_spu_decoder      = new wxComboBox(p_core, wxID_ANY);
+	wxComboBox* cbox_vdec_threads     = new wxComboBox(p_core, wxID_ANY);
+	wxComboBox* cbox_ppu_slots        = new wxComboBox(p_core, wxID_ANY);
+	wxComboBox* cbox_spu_slots        = new wxComboBox(p_core, wxID_ANY);
 	wxComboBox* cbox_gs_render        = new wxComboBox(p_graphics, wxID_ANY);
 	wxComboBox* cbox_gs_d3d_adaptater = new wxComboBox(p_graphics, wxID_ANY);
 	wxComboBox* cbox_gs_resolution    = new wxComboBox(p_graphics, wxID_ANY);
@@ -448,6 +454,11 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 	wxCheckBox* chbox_core_llvm_exclud    = new wxCheckBox(p_core, wxID_ANY, "Enable exclusion of compiled blocks");
 	wxCheckBox* chbox_core_hook_stfunc    = new wxCheckBox(p_core, wxID_ANY, "Hook static functions");
 	wxCheckBox* chbox_core_load_liblv2    = new wxCheckBox(p_core, wxID_ANY, "Load liblv2.sprx");
+	wxCheckBox* chbox_core_profiler       = new wxCheckBox(p_core, wxID_ANY, "Sampling profiler");
+	wxCheckBox* chbox_core_huge_pages     = new wxCheckBox(p_core, wxID_ANY, "Huge pages for guest memory");
+	wxCheckBox* chbox_core_stream_put     = new wxCheckBox(p_core, wxID_ANY, "Non-temporal stores for SPU DMA PUTs");
+	wxCheckBox* chbox_vdec_frame_threads  = new wxCheckBox(p_core, wxID_ANY, "Frame-threaded video decoding");
+	wxCheckBox* chbox_dec_packet_feed     = new wxCheckBox(p_core, wxID_ANY, "Decode AUs without libavformat");
 	wxCheckBox* chbox_gs_log_prog         = new wxCheckBox(p_graphics, wxID_ANY, "Log vertex/fragment programs");
 	wxCheckBox* chbox_gs_dump_depth       = new wxCheckBox(p_graphics, wxID_ANY, "Write Depth Buffer");
 	wxCheckBox* chbox_gs_dump_color       = new wxCheckBox(p_graphics, wxID_ANY, "Write Color Buffers");
@@ -458,6 +469,7 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 	wxCheckBox* chbox_audio_dump          = new wxCheckBox(p_audio, wxID_ANY, "Dump to file");
 	wxCheckBox* chbox_audio_conv          = new wxCheckBox(p_audio, wxID_ANY, "Convert to 16 bit");
 	wxCheckBox* chbox_hle_logging         = new wxCheckBox(p_misc, wxID_ANY, "Log everything");
+	wxCheckBox* chbox_hle_trace           = new wxCheckBox(p_misc, wxID_ANY, "Binary HLE trace");
 	wxCheckBox* chbox_rsx_logging         = new wxCheckBox(p_misc, wxID_ANY, "RSX Logging");
 	wxCheckBox* chbox_hle_savetty         = new wxCheckBox(p_misc, wxID_ANY, "Save TTY output to file");
 	wxCheckBox* chbox_hle_exitonstop      = new wxCheckBox(p_misc, wxID_ANY, "Exit RPCS3 when process finishes");
@@ -483,6 +495,24 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 	cbox_spu_decoder->Append("SPU Interpreter 2");
 	cbox_spu_decoder->Append("SPU JIT (ASMJIT)");
 
+	cbox_vdec_threads->Append("Auto");
+	for (int i = 1; i <= 8; i++)
+	{
+		cbox_vdec_threads->Append(std::to_string(i));
+	}
+
+	cbox_ppu_slots->Append("Unlimited");
+	for (int i = 1; i <= 16; i++)
+	{
+		cbox_ppu_slots->Append(std::to_string(i));
+	}
+
+	cbox_spu_slots->Append("Unlimited");
+	for (int i = 1; i <= 16; i++)
+	{
+		cbox_spu_slots->Append(std::to_string(i));
+	}
+
 	cbox_gs_render->Append("Null");
 	cbox_gs_render->Append("OpenGL");
 #if defined(DX12_SUPPORT)
@@ -631,12 +661,18 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 	chbox_audio_dump         ->SetValue(Ini.AudioDumpToFile.GetValue());
 	chbox_audio_conv         ->SetValue(Ini.AudioConvertToU16.GetValue());
 	chbox_hle_logging        ->SetValue(Ini.HLELogging.GetValue());
+	chbox_hle_trace          ->SetValue(Ini.HLETrace.GetValue());
 	chbox_rsx_logging        ->SetValue(Ini.RSXLogging.GetValue());
 	chbox_hle_savetty        ->SetValue(Ini.HLESaveTTY.GetValue());
 	chbox_hle_exitonstop     ->SetValue(Ini.HLEExitOnStop.GetValue());
 	chbox_hle_always_start   ->SetValue(Ini.HLEAlwaysStart.GetValue());
 	chbox_core_hook_stfunc   ->SetValue(Ini.HookStFunc.GetValue());
 	chbox_core_load_liblv2   ->SetValue(Ini.LoadLibLv2.GetValue());
+	chbox_core_profiler      ->SetValue(Ini.CPUProfiler.GetValue());
+	chbox_core_huge_pages    ->SetValue(Ini.HugePages.GetValue());
+	chbox_core_stream_put    ->SetValue(Ini.SPUStreamPut.GetValue());
+	chbox_vdec_frame_threads ->SetValue(Ini.VDECFrameThreading.GetValue());
+	chbox_dec_packet_feed    ->SetValue(Ini.DECPacketFeed.GetValue());
 
 	//Auto Pause related
 	chbox_dbg_ap_systemcall  ->SetValue(Ini.DBGAutoPauseSystemCall.GetValue());
@@ -651,6 +687,9 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 	txt_dbg_range_max    ->SetValue(std::to_string(Ini.LLVMMaxId.GetValue()));
 	txt_llvm_threshold   ->SetValue(std::to_string(Ini.LLVMThreshold.GetValue()));
 	cbox_spu_decoder     ->SetSelection(Ini.SPUDecoderMode.GetValue() ? Ini.SPUDecoderMode.GetValue() : 0);
+	cbox_vdec_threads    ->SetSelection(std::min<u8>(Ini.VDECThreads.GetValue(), 8));
+	cbox_ppu_slots       ->SetSelection(std::min<u8>(Ini.PPUThreadSlots.GetValue(), 16));
+	cbox_spu_slots       ->SetSelection(std::min<u8>(Ini.SPUThreadSlots.GetValue(), 16));
 	cbox_gs_render       ->SetSelection(Ini.GSRenderMode.GetValue());
 	cbox_gs_d3d_adaptater->SetSelection(Ini.GSD3DAdaptater.GetValue());
 	cbox_gs_resolution   ->SetSelection(ResolutionIdToNum(Ini.GSResolution.GetValue()) - 1);
@@ -676,6 +715,10 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 	s_round_llvm->Add(s_round_llvm_range, wxSizerFlags().Border(wxALL, 5).Expand());
 	s_round_llvm_threshold->Add(txt_llvm_threshold, wxSizerFlags().Border(wxALL, 5).Expand());
 	s_round_llvm->Add(s_round_llvm_threshold, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_round_vdec_threads->Add(cbox_vdec_threads, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_round_vdec_threads->Add(chbox_vdec_frame_threads, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_round_ppu_slots->Add(cbox_ppu_slots, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_round_spu_slots->Add(cbox_spu_slots, wxSizerFlags().Border(wxALL, 5).Expand());
 
 	// Rendering
 	s_round_gs_render->Add(cbox_gs_render, wxSizerFlags().Border(wxALL, 5).Expand());
@@ -707,6 +750,13 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 	s_subpanel_core->Add(s_round_llvm, wxSizerFlags().Border(wxALL, 5).Expand());
 	s_subpanel_core->Add(chbox_core_hook_stfunc, wxSizerFlags().Border(wxALL, 5).Expand());
 	s_subpanel_core->Add(chbox_core_load_liblv2, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_subpanel_core->Add(chbox_core_profiler, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_subpanel_core->Add(chbox_core_huge_pages, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_subpanel_core->Add(chbox_core_stream_put, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_subpanel_core->Add(s_round_ppu_slots, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_subpanel_core->Add(s_round_spu_slots, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_subpanel_core->Add(s_round_vdec_threads, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_subpanel_core->Add(chbox_dec_packet_feed, wxSizerFlags().Border(wxALL, 5).Expand());
 
 	// Graphics
 	s_subpanel_graphics->Add(s_round_gs_render, wxSizerFlags().Border(wxALL, 5).Expand());
@@ -737,6 +787,7 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 	// Miscellaneous
 	s_subpanel_misc->Add(s_round_hle_log_lvl, wxSizerFlags().Border(wxALL, 5).Expand());
 	s_subpanel_misc->Add(chbox_hle_logging, wxSizerFlags().Border(wxALL, 5).Expand());
+	s_subpanel_misc->Add(chbox_hle_trace, wxSizerFlags().Border(wxALL, 5).Expand());
 	s_subpanel_misc->Add(chbox_rsx_logging, wxSizerFlags().Border(wxALL, 5).Expand());
 	s_subpanel_misc->Add(chbox_hle_savetty, wxSizerFlags().Border(wxALL, 5).Expand());
 	s_subpanel_misc->Add(chbox_hle_exitonstop, wxSizerFlags().Border(wxALL, 5).Expand());
@@ -789,6 +840,14 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 		Ini.SPUDecoderMode.SetValue(cbox_spu_decoder->GetSelection());
 		Ini.HookStFunc.SetValue(chbox_core_hook_stfunc->GetValue());
 		Ini.LoadLibLv2.SetValue(chbox_core_load_liblv2->GetValue());
+		Ini.CPUProfiler.SetValue(chbox_core_profiler->GetValue());
+		Ini.HugePages.SetValue(chbox_core_huge_pages->GetValue());
+		Ini.SPUStreamPut.SetValue(chbox_core_stream_put->GetValue());
+		Ini.PPUThreadSlots.SetValue(cbox_ppu_slots->GetSelection());
+		Ini.SPUThreadSlots.SetValue(cbox_spu_slots->GetSelection());
+		Ini.VDECThreads.SetValue(cbox_vdec_threads->GetSelection());
+		Ini.VDECFrameThreading.SetValue(chbox_vdec_frame_threads->GetValue());
+		Ini.DECPacketFeed.SetValue(chbox_dec_packet_feed->GetValue());
 		Ini.GSRenderMode.SetValue(cbox_gs_render->GetSelection());
 		Ini.GSD3DAdaptater.SetValue(cbox_gs_d3d_adaptater->GetSelection());
 		Ini.GSResolution.SetValue(ResolutionNumToId(cbox_gs_resolution->GetSelection() + 1));
@@ -810,6 +869,7 @@ void MainFrame::Config(wxCommandEvent& WXUNUSED(event))
 		Ini.Camera.SetValue(cbox_camera->GetSelection());
 		Ini.CameraType.SetValue(cbox_camera_type->GetSelection());
 		Ini.HLELogging.SetValue(chbox_hle_logging->GetValue());
+		Ini.HLETrace.SetValue(chbox_hle_trace->GetValue());
 		Ini.RSXLogging.SetValue(chbox_rsx_logging->GetValue());
 		Ini.HLESaveTTY.SetValue(chbox_hle_savetty->GetValue());
 		Ini.HLEExitOnStop.SetValue(chbox_hle_exitonstop->GetValue());
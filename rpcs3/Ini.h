@@ -99,6 +99,11 @@ public:
 	IniEntry<u8> SPUDecoderMode;
 	IniEntry<bool> HookStFunc;
 	IniEntry<bool> LoadLibLv2;
+	IniEntry<bool> CPUProfiler;
+	IniEntry<u8> PPUThreadSlots;
+	IniEntry<u8> SPUThreadSlots;
+	IniEntry<bool> HugePages;
+	IniEntry<bool> SPUStreamPut;
 
 	// Graphics
 	IniEntry<u8> GSRenderMode;
@@ -119,6 +124,11 @@ public:
 	IniEntry<bool> AudioDumpToFile;
 	IniEntry<bool> AudioConvertToU16;
 
+	// Decoders
+	IniEntry<u8> VDECThreads;
+	IniEntry<bool> VDECFrameThreading;
+	IniEntry<bool> DECPacketFeed;
+
 	// Camera
 	IniEntry<u8> Camera;
 	IniEntry<u8> CameraType;
@@ -157,6 +167,7 @@ public:
 	IniEntry<u8>   NETStatus;
 	IniEntry<u8>   NETInterface;
 	IniEntry<bool> HLELogging;
+	IniEntry<bool> HLETrace;
 	IniEntry<bool> RSXLogging;
 	IniEntry<bool> HLESaveTTY;
 	IniEntry<bool> HLEExitOnStop;
@@ -189,6 +200,11 @@ public:
 		SPUDecoderMode.Init("CORE_SPUDecoderMode", path);
 		HookStFunc.Init("CORE_HookStFunc", path);
 		LoadLibLv2.Init("CORE_LoadLibLv2", path);
+		CPUProfiler.Init("CORE_CPUProfiler", path);
+		PPUThreadSlots.Init("CORE_PPUThreadSlots", path);
+		SPUThreadSlots.Init("CORE_SPUThreadSlots", path);
+		HugePages.Init("CORE_HugePages", path);
+		SPUStreamPut.Init("CORE_SPUStreamPut", path);
 
 		// Graphics
 		GSRenderMode.Init("GS_RenderMode", path);
@@ -209,6 +225,11 @@ public:
 		AudioDumpToFile.Init("Audio_AudioDumpToFile", path);
 		AudioConvertToU16.Init("Audio_AudioConvertToU16", path);
 
+		// Decoders
+		VDECThreads.Init("DEC_VDECThreads", path);
+		VDECFrameThreading.Init("DEC_VDECFrameThreading", path);
+		DECPacketFeed.Init("DEC_PacketFeed", path);
+
 		// Camera
 		Camera.Init("Camera", path);
 		CameraType.Init("Camera_Type", path);
@@ -244,6 +265,7 @@ public:
 
 		// Miscellaneous
 		HLELogging.Init("HLE_HLELogging", path);
+		HLETrace.Init("HLE_HLETrace", path);
 		RSXLogging.Init("RSX_Logging", path);
 		NETStatus.Init("NET_Status", path);
 		NETInterface.Init("NET_Interface", path);
@@ -275,6 +297,11 @@ public:
 		SPUDecoderMode.Load(0);
 		HookStFunc.Load(false);
 		LoadLibLv2.Load(false);
+		CPUProfiler.Load(false);
+		PPUThreadSlots.Load(0);
+		SPUThreadSlots.Load(0);
+		HugePages.Load(false);
+		SPUStreamPut.Load(false);
 
 		// Graphics
 		GSRenderMode.Load(1);
@@ -295,6 +322,11 @@ public:
 		AudioDumpToFile.Load(false);
 		AudioConvertToU16.Load(false);
 
+		// Decoders
+		VDECThreads.Load(1);
+		VDECFrameThreading.Load(false);
+		DECPacketFeed.Load(true);
+
 		// Camera
 		Camera.Load(1);
 		CameraType.Load(2);
@@ -330,6 +362,7 @@ public:
 
 		// Miscellaneous
 		HLELogging.Load(false);
+		HLETrace.Load(false);
 		RSXLogging.Load(false);
 		NETStatus.Load(0);
 		NETInterface.Load(0);
@@ -361,6 +394,11 @@ public:
 		SPUDecoderMode.Save();
 		HookStFunc.Save();
 		LoadLibLv2.Save();
+		CPUProfiler.Save();
+		PPUThreadSlots.Save();
+		SPUThreadSlots.Save();
+		HugePages.Save();
+		SPUStreamPut.Save();
 
 		// Graphics
 		GSRenderMode.Save();
@@ -381,6 +419,11 @@ public:
 		AudioDumpToFile.Save();
 		AudioConvertToU16.Save();
 
+		// Decoders
+		VDECThreads.Save();
+		VDECFrameThreading.Save();
+		DECPacketFeed.Save();
+
 		// Camera
 		Camera.Save();
 		CameraType.Save();
@@ -416,6 +459,7 @@ public:
 
 		// Miscellaneous
 		HLELogging.Save();
+		HLETrace.Save();
 		RSXLogging.Save();
 		NETStatus.Save();
 		NETInterface.Save();
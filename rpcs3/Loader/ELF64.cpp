@@ -10,6 +10,7 @@
 #include "Emu/SysCalls/ModuleManager.h"
 #include "Emu/SysCalls/lv2/sys_prx.h"
 #include "Emu/Cell/PPUInstrTable.h"
+#include "Emu/CPU/CPUProfiler.h"
 #include "ELF64.h"
 #include "Ini.h"
 
@@ -312,6 +313,13 @@ namespace loader
 			//store elf to memory
 			vm::ps3::init();
 
+			// before any memory is populated (pages mapped already aren't replaced with huge pages, see tlb_bench)
+			if (Ini.HugePages.GetValue())
+			{
+				vm::use_huge_pages(vm::main);
+				vm::use_huge_pages(vm::video);
+			}
+
 			error_code res = alloc_memory(0);
 			if (res != ok)
 			{
@@ -358,6 +366,11 @@ namespace loader
 						sprx_info info;
 						sprx_handler.load_sprx(info);
 
+						for (auto& s : info.segments)
+						{
+							cpu_profiler_add_segment(s.begin.addr(), s.size);
+						}
+
 						for (auto &m : info.modules)
 						{
 							if (m.first == "")
@@ -450,6 +463,12 @@ namespace loader
 										}
 									}
 								}
+
+								// entry point of the exported function (addr points to its OPD)
+								if (vm::check_addr(addr, 4))
+								{
+									cpu_profiler_add_function(vm::read32(addr), 0, nid);
+								}
 							}
 
 							for (auto& f : m.second.imports)
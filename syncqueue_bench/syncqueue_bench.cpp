@@ -0,0 +1,272 @@
+// cellSyncQueue PPU/SPU throughput benchmark (cellSync.cpp, vm::wait_op / vm::notify_at)
+// Usage: syncqueue_bench [items] [poller: 0 or 1]
+// A producer ("PPU") and a consumer ("SPU") thread pass items through a CellSyncQueue in guest memory, running the bodies of
+// cellSyncQueuePush() and cellSyncQueuePop(): blocking in vm::wait_op() on the queue control word, notify_at() after the update.
+// With the poller, a thread calls notify_all() like the vm::start thread (it spins while any waiter's predicate is false).
+// Prints items per second for several queue depths and item sizes.
+
+#include "stdafx.h"
+#include "Utilities/Thread.h"
+#include "Emu/Memory/Memory.h"
+#include "Emu/SysCalls/Modules/cellSync.h"
+
+#include <cstdlib>
+#include <chrono>
+
+// guest memory (queue control block and buffer)
+void* const vm::g_base_addr = _mm_malloc(0x10000, 4096);
+
+// dependency of Thread.h (only the mutex and the cv of thread_t are used)
+thread_t::~thread_t() noexcept(false)
+{
+}
+
+// copies of vm.cpp functions (vm.cpp depends on the emulator, CHECK_EMU_STATUS is removed)
+namespace vm
+{
+	struct waiter_bucket_t
+	{
+		std::mutex mutex;
+
+		std::vector<waiter_t*> list;
+	};
+
+	std::array<waiter_bucket_t, 256> g_waiter_buckets;
+
+	inline waiter_bucket_t& _get_waiter_bucket(u32 addr)
+	{
+		return g_waiter_buckets[(addr / 4096) % g_waiter_buckets.size()];
+	}
+
+	void _add_waiter(waiter_t& waiter, thread_t& thread, u32 addr, u32 size)
+	{
+		auto& bucket = _get_waiter_bucket(addr);
+
+		std::lock_guard<std::mutex> lock(bucket.mutex);
+
+		bucket.list.emplace_back(waiter.reset(addr, size, thread));
+
+		thread.mutex.lock();
+	}
+
+	void _remove_waiter(waiter_t* waiter, u32 addr)
+	{
+		auto& bucket = _get_waiter_bucket(addr);
+
+		std::lock_guard<std::mutex> lock(bucket.mutex);
+
+		const auto found = std::find(bucket.list.begin(), bucket.list.end(), waiter);
+
+		*found = bucket.list.back();
+
+		bucket.list.pop_back();
+	}
+
+	bool waiter_t::try_notify()
+	{
+		std::lock_guard<std::mutex> lock(thread->mutex);
+
+		if (!pred || !pred())
+		{
+			return false;
+		}
+
+		pred = nullptr;
+
+		addr = 0;
+		mask = ~0;
+
+		thread->cv.notify_one();
+
+		return true;
+	}
+
+	void waiter_lock_t::wait()
+	{
+		while (m_waiter.pred)
+		{
+			if (m_waiter.pred())
+			{
+				return;
+			}
+
+			m_waiter.thread->cv.wait(m_lock);
+		}
+	}
+
+	waiter_lock_t::~waiter_lock_t()
+	{
+		m_waiter.addr = 0;
+		m_waiter.mask = ~0;
+		m_waiter.pred = nullptr;
+
+		m_lock.unlock();
+
+		_remove_waiter(&m_waiter, m_addr);
+	}
+
+	void notify_at(u32 addr, u32 size)
+	{
+		auto& bucket = _get_waiter_bucket(addr);
+
+		std::lock_guard<std::mutex> lock(bucket.mutex);
+
+		const u32 mask = ~(size - 1);
+
+		for (const auto waiter : bucket.list)
+		{
+			if (((waiter->addr ^ addr) & (mask & waiter->mask)) == 0)
+			{
+				waiter->try_notify();
+			}
+		}
+	}
+
+	bool notify_all()
+	{
+		std::size_t waiters = 0;
+		std::size_t signaled = 0;
+
+		for (auto& bucket : g_waiter_buckets)
+		{
+			std::lock_guard<std::mutex> lock(bucket.mutex);
+
+			for (const auto waiter : bucket.list)
+			{
+				if (waiter->addr)
+				{
+					waiters++;
+
+					if (waiter->try_notify())
+					{
+						signaled++;
+					}
+				}
+			}
+		}
+
+		return waiters == signaled;
+	}
+}
+
+// body of cellSyncQueuePush()
+static void push(thread_t& thread, vm::ptr<CellSyncQueue> queue, const void* buffer)
+{
+	const u32 depth = queue->check_depth();
+
+	u32 position;
+
+	vm::wait_op(thread, queue.addr(), 8, WRAP_EXPR(queue->ctrl.atomic_op(&sync_queue_t::try_push_begin, depth, position)));
+
+	std::memcpy(&queue->buffer[position * queue->size], buffer, queue->size);
+
+	queue->ctrl &= { 0xffffffff, 0x00ffffff };
+
+	vm::notify_at(queue.addr(), 8);
+}
+
+// body of cellSyncQueuePop()
+static void pop(thread_t& thread, vm::ptr<CellSyncQueue> queue, void* buffer)
+{
+	const u32 depth = queue->check_depth();
+
+	u32 position;
+
+	vm::wait_op(thread, queue.addr(), 8, WRAP_EXPR(queue->ctrl.atomic_op(&sync_queue_t::try_pop_begin, depth, position)));
+
+	std::memcpy(buffer, &queue->buffer[position * queue->size], queue->size);
+
+	queue->ctrl &= { 0x00ffffff, 0xffffffffu };
+
+	vm::notify_at(queue.addr(), 8);
+}
+
+static double run(u32 count, u32 depth, u32 size, bool poller)
+{
+	const auto queue = vm::ptr<CellSyncQueue>::make(0x1000);
+
+	// initialize like cellSyncQueueInitialize()
+	queue->ctrl = {};
+	queue->size = size;
+	queue->depth = depth;
+	queue->buffer.set(0x2000);
+
+	std::atomic<bool> done{ false };
+
+	std::thread poll_thread;
+
+	if (poller)
+	{
+		poll_thread = std::thread([&]()
+		{
+			while (!done)
+			{
+				while (!vm::notify_all() && !done)
+				{
+					std::this_thread::yield();
+				}
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+		});
+	}
+
+	thread_t ppu, spu;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	std::thread spu_thread([&]()
+	{
+		u8 data[128];
+
+		for (u32 i = 0; i < count; i++)
+		{
+			pop(spu, queue, data);
+
+			if (data[0] != static_cast<u8>(i))
+			{
+				throw EXCEPTION("Unexpected item");
+			}
+		}
+	});
+
+	u8 data[128] = {};
+
+	for (u32 i = 0; i < count; i++)
+	{
+		data[0] = static_cast<u8>(i);
+
+		push(ppu, queue, data);
+	}
+
+	spu_thread.join();
+
+	const double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	done = true;
+
+	if (poll_thread.joinable())
+	{
+		poll_thread.join();
+	}
+
+	return count / time;
+}
+
+int main(int argc, char** argv)
+{
+	const u32 count = argc > 1 ? std::atoi(argv[1]) : 200000;
+	const bool poller = argc > 2 && std::atoi(argv[2]) != 0;
+
+	std::printf("hardware threads: %u, poller %s\n", std::thread::hardware_concurrency(), poller ? "on" : "off");
+
+	for (u32 depth : { 1, 4, 32 })
+	{
+		for (u32 size : { 16, 128 })
+		{
+			std::printf("depth %2u, %3u-byte items: %9.0f items/s\n", depth, size, run(count, depth, size, poller));
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,195 @@
+// Guest memory TLB benchmark (vm::main, vm::use_huge_pages(), Emu/Memory/vm.cpp)
+// Usage: tlb_bench [MiB of vm::main to use] [accesses (millions)]
+// Creates the shared memory object and both views like vm::initialize(), allocates the beginning of vm::main
+// (0x00010000) with read/write access like vm::alloc(), then reads random u32 values from random 4 KiB pages and
+// streams through the range sequentially. vm::use_huge_pages() (madvise(MADV_HUGEPAGE) on both views) is either not
+// called, called before the memory is accessed, or called after it's populated.
+// Prints ns per random access, GB/s for the stream and the share of the range mapped with huge pages (ShmemPmdMapped
+// in /proc/self/smaps, requires /dev/shm mounted with huge=advise, within_size or always).
+
+#include "stdafx.h"
+
+#include <cstdlib>
+#include <chrono>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <fstream>
+#endif
+
+#ifndef _WIN32
+
+// main memory location (see vm::ps3::init())
+const u32 g_main_addr = 0x00010000;
+
+static u8* g_base_addr;
+static u8* g_priv_addr;
+
+// copy of vm::initialize() (vm.cpp depends on the emulator)
+static bool initialize()
+{
+	int memory_handle = shm_open("/rpcs3_tlb_bench", O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+
+	if (memory_handle == -1)
+	{
+		std::printf("shm_open('/rpcs3_tlb_bench') failed\n");
+		return false;
+	}
+
+	if (ftruncate(memory_handle, 0x100000000) == -1)
+	{
+		std::printf("ftruncate(memory_handle) failed\n");
+		shm_unlink("/rpcs3_tlb_bench");
+		return false;
+	}
+
+	g_base_addr = static_cast<u8*>(mmap(nullptr, 0x100000000, PROT_NONE, MAP_SHARED, memory_handle, 0));
+	g_priv_addr = static_cast<u8*>(mmap(nullptr, 0x100000000, PROT_NONE, MAP_SHARED, memory_handle, 0));
+
+	shm_unlink("/rpcs3_tlb_bench");
+	close(memory_handle);
+
+	return g_base_addr != MAP_FAILED && g_priv_addr != MAP_FAILED;
+}
+
+// size of the range mapped with huge pages (KiB)
+static u64 get_huge_kb(u32 addr, u32 size)
+{
+	std::ifstream smaps("/proc/self/smaps");
+
+	const auto start = reinterpret_cast<std::uintptr_t>(g_base_addr + addr);
+	const auto end = start + size;
+
+	std::string line;
+	bool found = false;
+	u64 result = 0;
+
+	while (std::getline(smaps, line))
+	{
+		unsigned long long from, to;
+
+		if (std::sscanf(line.c_str(), "%llx-%llx ", &from, &to) == 2)
+		{
+			found = from < end && to > start;
+		}
+		else if (found && line.compare(0, 15, "ShmemPmdMapped:") == 0)
+		{
+			result += std::strtoull(line.c_str() + 15, nullptr, 10);
+		}
+	}
+
+	return result;
+}
+
+// vm::use_huge_pages(): only whole 2 MiB pages inside of the range, both views
+static bool use_huge_pages(u32 size)
+{
+#ifdef MADV_HUGEPAGE
+	const u32 start = ::align(g_main_addr, 0x200000);
+	const u32 end = (g_main_addr + size) & ~0x1fffff;
+
+	return !madvise(g_base_addr + start, end - start, MADV_HUGEPAGE) && !madvise(g_priv_addr + start, end - start, MADV_HUGEPAGE);
+#else
+	return false;
+#endif
+}
+
+enum : u32
+{
+	advise_none, // vm::use_huge_pages() not called
+	advise_before, // called before the memory is accessed
+	advise_after, // called after the memory is populated (as Emu.Run() does after loading the executable)
+};
+
+static void run(const char* name, u32 size, u64 count, u32 advise)
+{
+	if (!initialize())
+	{
+		std::exit(1);
+	}
+
+	// vm::alloc(): the normal and the privileged view are made writable
+	if (mprotect(g_base_addr + g_main_addr, size, PROT_READ | PROT_WRITE) || mprotect(g_priv_addr + g_main_addr, size, PROT_READ | PROT_WRITE))
+	{
+		std::printf("mprotect() failed\n");
+		std::exit(1);
+	}
+
+	if (advise == advise_before && !use_huge_pages(size))
+	{
+		std::printf("madvise() failed\n");
+		std::exit(1);
+	}
+
+	const u32 pages = size / 4096;
+
+	u8* const ptr = g_base_addr + g_main_addr;
+
+	// fault in the whole range first (page faults aren't measured)
+	for (u32 i = 0; i < size; i += 4096)
+	{
+		ptr[i]++;
+	}
+
+	if (advise == advise_after && !use_huge_pages(size))
+	{
+		std::printf("madvise() failed\n");
+		std::exit(1);
+	}
+
+	u64 sum = 0;
+	u64 x = 0x9e3779b97f4a7c15ull;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (u64 i = 0; i < count; i++)
+	{
+		x ^= x << 13, x ^= x >> 7, x ^= x << 17;
+
+		sum += *reinterpret_cast<volatile u32*>(ptr + (x % pages) * 4096 + (x >> 52 & 0xffc));
+	}
+
+	const auto middle = std::chrono::steady_clock::now();
+
+	for (u32 i = 0; i < size; i += 64)
+	{
+		sum += *reinterpret_cast<volatile u32*>(ptr + i);
+	}
+
+	const auto end = std::chrono::steady_clock::now();
+
+	const double random = std::chrono::duration<double>(middle - start).count();
+	const double stream = std::chrono::duration<double>(end - middle).count();
+
+	std::printf("%-24s %6.2f ns per random access, %6.2f GB/s sequential, %3u%% huge pages (checksum %llx)\n", name,
+		random * 1e9 / count, size / stream / 1e9, static_cast<u32>(get_huge_kb(g_main_addr, size) * 1024 * 100 / size), static_cast<unsigned long long>(sum));
+
+	munmap(g_base_addr, 0x100000000);
+	munmap(g_priv_addr, 0x100000000);
+}
+
+int main(int argc, char** argv)
+{
+	const u32 size = std::min<u32>(argc > 1 ? std::atoi(argv[1]) : 256, 511) * 1024 * 1024;
+	const u64 count = (argc > 2 ? std::atoi(argv[2]) : 20) * 1000000ull;
+
+	run("4 KiB pages", size, count, advise_none);
+	run("huge pages (before use)", size, count, advise_before);
+	run("huge pages (after use)", size, count, advise_after);
+
+	return 0;
+}
+
+#else
+
+int main()
+{
+	std::printf("Not supported (vm::use_huge_pages() does nothing on Windows)\n");
+
+	return 0;
+}
+
+#endif
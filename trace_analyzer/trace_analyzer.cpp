@@ -0,0 +1,212 @@
+// Offline analyzer for binary HLE traces (Ini.HLETrace)
+// Usage: trace_analyzer <HLETrace.bin> [-n count]
+// Prints per-function call counts, total and average time, and the top callers of the most expensive functions.
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+
+using u32 = std::uint32_t;
+using u64 = std::uint64_t;
+
+#include "Emu/SysCalls/HLETrace.h"
+
+struct func_stat_t
+{
+	u64 id = 0;
+	u64 count = 0;
+	u64 total = 0; // ns
+	u64 max = 0; // ns
+	std::unordered_map<u32, std::pair<u64, u64>> callers; // caller -> (count, total ns)
+};
+
+std::unordered_map<u64, std::string> load_names(const std::string& path)
+{
+	std::unordered_map<u64, std::string> names;
+
+	if (FILE* f = std::fopen(path.c_str(), "r"))
+	{
+		char line[1024];
+
+		while (std::fgets(line, sizeof(line), f))
+		{
+			char* end;
+			const u64 id = std::strtoull(line, &end, 16);
+
+			if (end != line && *end == ' ')
+			{
+				std::string name = end + 1;
+
+				while (name.size() && (name.back() == '\n' || name.back() == '\r'))
+				{
+					name.pop_back();
+				}
+
+				names[id] = name;
+			}
+		}
+
+		std::fclose(f);
+	}
+
+	return names;
+}
+
+std::string get_name(const std::unordered_map<u64, std::string>& names, u64 id)
+{
+	const auto found = names.find(id);
+
+	if (found != names.end())
+	{
+		return found->second;
+	}
+
+	char buf[32];
+
+	if (~id < 1024)
+	{
+		std::snprintf(buf, sizeof(buf), "syscall_%llu", (unsigned long long)~id);
+	}
+	else
+	{
+		std::snprintf(buf, sizeof(buf), "0x%08llX", (unsigned long long)id);
+	}
+
+	return buf;
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		std::fprintf(stderr, "Usage: %s <HLETrace.bin> [-n count]\n", argv[0]);
+		return 1;
+	}
+
+	const std::string path = argv[1];
+	std::size_t limit = 50;
+
+	for (int i = 2; i + 1 < argc; i++)
+	{
+		if (std::strcmp(argv[i], "-n") == 0)
+		{
+			limit = std::strtoul(argv[++i], nullptr, 10);
+		}
+	}
+
+	FILE* f = std::fopen(path.c_str(), "rb");
+
+	if (!f)
+	{
+		std::fprintf(stderr, "Failed to open %s\n", path.c_str());
+		return 1;
+	}
+
+	hle_trace_header_t header;
+
+	if (std::fread(&header, sizeof(header), 1, f) != 1 || std::memcmp(header.magic, HLE_TRACE_MAGIC, sizeof(header.magic)) != 0)
+	{
+		std::fprintf(stderr, "%s is not an HLE trace\n", path.c_str());
+		std::fclose(f);
+		return 1;
+	}
+
+	if (header.version != HLE_TRACE_VERSION || header.record_size != sizeof(hle_trace_record_t))
+	{
+		std::fprintf(stderr, "Unsupported trace version (%u, record size %u)\n", header.version, header.record_size);
+		std::fclose(f);
+		return 1;
+	}
+
+	const auto names = load_names(path + ".names");
+
+	std::unordered_map<u64, func_stat_t> stats;
+	std::map<u32, u64> threads; // thread id -> calls
+	std::vector<hle_trace_record_t> records(4096);
+	u64 record_count = 0;
+	u64 first = UINT64_MAX, last = 0;
+
+	while (const std::size_t count = std::fread(records.data(), sizeof(hle_trace_record_t), records.size(), f))
+	{
+		for (std::size_t i = 0; i < count; i++)
+		{
+			const auto& r = records[i];
+			auto& stat = stats[r.id];
+
+			stat.id = r.id;
+			stat.count++;
+			stat.total += r.duration;
+			stat.max = std::max(stat.max, r.duration);
+
+			auto& caller = stat.callers[r.caller];
+			caller.first++;
+			caller.second += r.duration;
+
+			threads[r.thread]++;
+			first = std::min(first, r.start);
+			last = std::max(last, r.start + r.duration);
+		}
+
+		record_count += count;
+	}
+
+	std::fclose(f);
+
+	if (!record_count)
+	{
+		std::printf("No records.\n");
+		return 0;
+	}
+
+	std::vector<const func_stat_t*> sorted;
+
+	for (auto& stat : stats)
+	{
+		sorted.emplace_back(&stat.second);
+	}
+
+	std::sort(sorted.begin(), sorted.end(), [](const func_stat_t* a, const func_stat_t* b)
+	{
+		return a->total > b->total;
+	});
+
+	std::printf("%llu calls of %zu functions in %zu threads, %.3f s traced\n\n", (unsigned long long)record_count, stats.size(), threads.size(), (last - first) / 1e9);
+	std::printf("%-48s %12s %14s %12s %12s\n", "function", "calls", "total (ms)", "avg (us)", "max (us)");
+
+	for (std::size_t i = 0; i < sorted.size() && i < limit; i++)
+	{
+		const auto& s = *sorted[i];
+
+		std::printf("%-48s %12llu %14.3f %12.3f %12.3f\n", get_name(names, s.id).c_str(), (unsigned long long)s.count, s.total / 1e6, s.total / 1e3 / s.count, s.max / 1e3);
+	}
+
+	std::printf("\nTop callers (time includes nested calls):\n");
+
+	for (std::size_t i = 0; i < sorted.size() && i < std::min<std::size_t>(limit, 10); i++)
+	{
+		const auto& s = *sorted[i];
+
+		std::vector<std::pair<u32, std::pair<u64, u64>>> callers(s.callers.begin(), s.callers.end());
+
+		std::sort(callers.begin(), callers.end(), [](const decltype(callers)::value_type& a, const decltype(callers)::value_type& b)
+		{
+			return a.second.second > b.second.second;
+		});
+
+		std::printf("%s:\n", get_name(names, s.id).c_str());
+
+		for (std::size_t j = 0; j < callers.size() && j < 5; j++)
+		{
+			std::printf("    *0x%08x %12llu calls %14.3f ms\n", callers[j].first, (unsigned long long)callers[j].second.first, callers[j].second.second / 1e6);
+		}
+	}
+
+	return 0;
+}